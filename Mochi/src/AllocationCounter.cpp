@@ -0,0 +1,92 @@
+#include <cstdlib>
+#include <new>
+
+#include "AllocationCounter.hpp"
+
+#ifdef ORBITAI_COUNT_ALLOCATIONS
+
+/* Counter incremented by every replaced operator new, per thread so that each thread checks its own allocations. */
+static thread_local size_t gAllocationCount = 0;
+
+/**
+ * Allocate and count.
+ */
+static void* countedAllocate(size_t size)
+{
+    ++gAllocationCount;
+
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if(p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new(size_t size)
+{
+    return countedAllocate(size);
+}
+
+void* operator new[](size_t size)
+{
+    return countedAllocate(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    try
+    {
+        return countedAllocate(size);
+    }
+    catch(...)
+    {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    try
+    {
+        return countedAllocate(size);
+    }
+    catch(...)
+    {
+        return nullptr;
+    }
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+size_t getAllocationCount()
+{
+    return gAllocationCount;
+}
+
+#else
+
+size_t getAllocationCount()
+{
+    return 0;
+}
+
+#endif // ORBITAI_COUNT_ALLOCATIONS
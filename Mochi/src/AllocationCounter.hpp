@@ -0,0 +1,13 @@
+#ifndef ALLOCATION_COUNTER_H_
+#define ALLOCATION_COUNTER_H_
+
+#include <cstddef>
+
+/**
+ * Number of heap allocations made by the calling thread so far.
+ * Allocations are only counted when the program is built with ORBITAI_COUNT_ALLOCATIONS defined (make COUNT_ALLOCATIONS=1),
+ * which replaces the global operator new. Otherwise this always returns 0.
+ */
+size_t getAllocationCount();
+
+#endif // ALLOCATION_COUNTER_H_
@@ -0,0 +1,69 @@
+#include <stdexcept>
+
+#include "Constants.hpp"
+#include "BinaryLogReader.hpp"
+
+/* Size of the fixed fields of the header: the magic and four uint32. */
+#define HEADER_FIXED_SIZE   (BINARY_LOG_MAGIC_LENGTH + 4 * sizeof(uint32_t))
+
+/**
+ * Whether the given data starts like a binary log.
+ */
+bool BinaryLogReader::isBinaryLog(const char* pData, size_t size)
+{
+    return size >= HEADER_FIXED_SIZE && memcmp(pData, BINARY_LOG_MAGIC, BINARY_LOG_MAGIC_LENGTH) == 0;
+}
+
+/**
+ * Constructor, maps the given log file and reads its header.
+ */
+BinaryLogReader::BinaryLogReader(const string& filePath) :
+    m_file(filePath),
+    m_pRecords(nullptr),
+    m_recordSize(0),
+    m_numRecords(0)
+{
+    const char* pData = m_file.getData();
+    const size_t size = m_file.getSize();
+
+    if(!isBinaryLog(pData, size))
+    {
+        throw runtime_error("Not a binary log file: " + filePath);
+    }
+
+    uint32_t fields[4];
+    memcpy(fields, pData + BINARY_LOG_MAGIC_LENGTH, sizeof(fields));
+    const size_t headerSize = fields[0];
+    m_recordSize = fields[1];
+    const size_t numParams = fields[2];
+    const size_t numModels = fields[3];
+
+    if(headerSize > size || m_recordSize < 16 + numParams * sizeof(double) + numModels * sizeof(int32_t))
+    {
+        throw runtime_error("Corrupted binary log file header: " + filePath);
+    }
+
+    /* The param names and then the model names, each as a uint16 length followed by the characters. */
+    const char* pCursor = pData + HEADER_FIXED_SIZE;
+    const char* pHeaderEnd = pData + headerSize;
+    for(size_t i = 0; i < numParams + numModels; ++i)
+    {
+        uint16_t length;
+        if(pCursor + sizeof(length) > pHeaderEnd)
+        {
+            throw runtime_error("Corrupted binary log file header: " + filePath);
+        }
+        memcpy(&length, pCursor, sizeof(length));
+        pCursor += sizeof(length);
+
+        if(pCursor + length > pHeaderEnd)
+        {
+            throw runtime_error("Corrupted binary log file header: " + filePath);
+        }
+        (i < numParams ? m_paramNames : m_modelNames).push_back(string(pCursor, length));
+        pCursor += length;
+    }
+
+    m_pRecords = pHeaderEnd;
+    m_numRecords = (size - headerSize) / m_recordSize;
+}
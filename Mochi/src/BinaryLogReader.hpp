@@ -0,0 +1,92 @@
+#ifndef BINARY_LOG_READER_H_
+#define BINARY_LOG_READER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "MappedFile.hpp"
+
+using namespace std;
+
+/**
+ * Reads a binary training or inference log written by BinaryLogger.
+ * The log file is memory mapped and its records are read in place, without parsing or copying them.
+ */
+class BinaryLogReader
+{
+private:
+    MappedFile m_file;
+
+    /* The param and model names of the schema header. */
+    vector<string> m_paramNames;
+    vector<string> m_modelNames;
+
+    /* The first record and the layout of the records. */
+    const char* m_pRecords;
+    size_t m_recordSize;
+    size_t m_numRecords;
+
+    /* Read a field of the given record. */
+    template<typename T>
+    T read(size_t recordIndex, size_t offset) const
+    {
+        T value;
+        memcpy(&value, m_pRecords + recordIndex * m_recordSize + offset, sizeof(value));
+        return value;
+    }
+
+public:
+
+    /**
+     * Constructor, maps the given log file and reads its header. Throws if the file is not a binary log.
+     */
+    BinaryLogReader(const string& filePath);
+
+    /**
+     * Whether the given data starts like a binary log.
+     */
+    static bool isBinaryLog(const char* pData, size_t size);
+
+    const vector<string>& getParamNames() const
+    {
+        return m_paramNames;
+    }
+
+    /* Empty for the training log. */
+    const vector<string>& getModelNames() const
+    {
+        return m_modelNames;
+    }
+
+    /* A partially written last record is not counted. */
+    size_t getNumRecords() const
+    {
+        return m_numRecords;
+    }
+
+    /* Timestamp of the given record in milliseconds since the epoch. */
+    int64_t getTimestamp(size_t recordIndex) const
+    {
+        return read<int64_t>(recordIndex, 0);
+    }
+
+    int getLabel(size_t recordIndex) const
+    {
+        return read<int32_t>(recordIndex, 8);
+    }
+
+    double getValue(size_t recordIndex, size_t paramIndex) const
+    {
+        return read<double>(recordIndex, 16 + paramIndex * sizeof(double));
+    }
+
+    int getInference(size_t recordIndex, size_t modelIndex) const
+    {
+        return read<int32_t>(recordIndex, 16 + m_paramNames.size() * sizeof(double) + modelIndex * sizeof(int32_t));
+    }
+};
+
+#endif // BINARY_LOG_READER_H_
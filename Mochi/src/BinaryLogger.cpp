@@ -0,0 +1,243 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <sys/stat.h>
+
+#include "Constants.hpp"
+#include "Utils.hpp"
+#include "InputParser.hpp"
+#include "LogRotation.hpp"
+#include "BinaryLogger.hpp"
+
+/* Offsets of the fields of a record. */
+#define RECORD_OFFSET_TIMESTAMP         0
+#define RECORD_OFFSET_LABEL             8
+#define RECORD_OFFSET_VALUES           16
+
+/**
+ * Round up to a multiple of 8 bytes, so that the values of the records are aligned in a mapped log file.
+ */
+static size_t alignTo8(size_t size)
+{
+    return (size + 7) & ~static_cast<size_t>(7);
+}
+
+/**
+ * Append a uint32 to the given header.
+ */
+static void appendUint32(string* pHeader, uint32_t value)
+{
+    pHeader->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/**
+ * Append a name as its uint16 length followed by its characters to the given header.
+ */
+static void appendName(string* pHeader, const string& name)
+{
+    const uint16_t length = static_cast<uint16_t>(name.size());
+    pHeader->append(reinterpret_cast<const char*>(&length), sizeof(length));
+    pHeader->append(name, 0, length);
+}
+
+/**
+ * Constructor.
+ */
+BinaryLogger::BinaryLogger(const char* filePath) :
+    m_filePath(filePath),
+    m_pFile(nullptr),
+    m_segmentSize(0),
+    m_segmentStart(0),
+    m_numParams(0)
+{
+}
+
+/**
+ * Destructor.
+ */
+BinaryLogger::~BinaryLogger()
+{
+    close();
+}
+
+/**
+ * Close the log file, e.g. before deleting it. The next logged record opens it again.
+ */
+void BinaryLogger::close()
+{
+    if(m_pFile != nullptr)
+    {
+        fclose(m_pFile);
+        m_pFile = nullptr;
+    }
+}
+
+/**
+ * Open the log file, writing the header with the given param and model names if the file is being created.
+ */
+void BinaryLogger::open(const vector<string>* pParamNames, const vector<pair<string, int>>* pModels)
+{
+    if(m_header.empty())
+    {
+        buildHeader(pParamNames, pModels);
+    }
+
+    bool isNewFile;
+    if(m_pFile == nullptr)
+    {
+        /* A log file left by a run with other params or models is rotated rather than appended to with other records. */
+        if(exists(m_filePath) && !hasHeader())
+        {
+            LogRotation::rotate(m_filePath);
+        }
+
+        /* Write the header if the file is being created. */
+        isNewFile = !exists(m_filePath);
+
+        /* Open the file, append to it if it already exists. */
+        m_pFile = fopen(m_filePath, "a");
+    }
+    else if(LogRotation::isDue(m_segmentSize, m_segmentStart))
+    {
+        /* Rotating is rare and may allocate, the new file reuses the stream so that reopening it does not. */
+        LogRotation::rotate(m_filePath);
+        isNewFile = true;
+        m_pFile = freopen(m_filePath, "a", m_pFile);
+    }
+    else
+    {
+        return;
+    }
+
+    if(m_pFile == nullptr)
+    {
+        throw runtime_error(string("Failed to open log file: ") + m_filePath);
+    }
+
+    /* Records are built in their own buffer and written at once. */
+    setvbuf(m_pFile, nullptr, _IONBF, 0);
+
+    /* A file left by a previous run is rotated by its size, and by its age counted from now. */
+    struct stat fileStat;
+    m_segmentSize = fstat(fileno(m_pFile), &fileStat) == 0 ? fileStat.st_size : 0;
+    m_segmentStart = time(nullptr);
+
+    if(isNewFile)
+    {
+        write(m_header.data(), m_header.size());
+    }
+}
+
+/**
+ * Build the header with the given param and model names and size the record buffer.
+ */
+void BinaryLogger::buildHeader(const vector<string>* pParamNames, const vector<pair<string, int>>* pModels)
+{
+    /* The record layout follows from the number of params and models, which do not change while the server runs. */
+    const size_t numModels = pModels != nullptr ? pModels->size() : 0;
+    m_numParams = pParamNames->size();
+    m_record.assign(alignTo8(RECORD_OFFSET_VALUES + m_numParams * sizeof(double) + numModels * sizeof(int32_t)), '\0');
+    m_values.assign(m_numParams, 0.0);
+
+    m_header.assign(BINARY_LOG_MAGIC, BINARY_LOG_MAGIC_LENGTH);
+
+    /* The header size is set once the names are appended. */
+    appendUint32(&m_header, 0);
+    appendUint32(&m_header, static_cast<uint32_t>(m_record.size()));
+    appendUint32(&m_header, static_cast<uint32_t>(m_numParams));
+    appendUint32(&m_header, static_cast<uint32_t>(numModels));
+
+    for(vector<string>::const_iterator it = pParamNames->begin(); it != pParamNames->end(); ++it)
+    {
+        appendName(&m_header, *it);
+    }
+    for(size_t i = 0; i < numModels; ++i)
+    {
+        appendName(&m_header, (*pModels)[i].first);
+    }
+
+    m_header.resize(alignTo8(m_header.size()), '\0');
+    const uint32_t headerSize = static_cast<uint32_t>(m_header.size());
+    memcpy(&m_header[BINARY_LOG_MAGIC_LENGTH], &headerSize, sizeof(headerSize));
+}
+
+/**
+ * Whether the log file starts with the header of this logger.
+ */
+bool BinaryLogger::hasHeader()
+{
+    FILE* pFile = fopen(m_filePath, "rb");
+    if(pFile == nullptr)
+    {
+        return false;
+    }
+
+    string fileHeader(m_header.size(), '\0');
+    const bool hasHeader = fread(&fileHeader[0], 1, fileHeader.size(), pFile) == fileHeader.size() && fileHeader == m_header;
+    fclose(pFile);
+
+    return hasHeader;
+}
+
+/**
+ * Write the given bytes to the log file.
+ */
+void BinaryLogger::write(const char* pBytes, size_t length)
+{
+    if(fwrite(pBytes, 1, length, m_pFile) != length)
+    {
+        throw runtime_error(string("Failed to write to log file: ") + m_filePath);
+    }
+    m_segmentSize += length;
+}
+
+/**
+ * Set the timestamp, the target label and the input values of the record from an input string such as "+1 1:1.232 2:2.412".
+ */
+void BinaryLogger::setInput(const string* pInput)
+{
+    /* The target label is the first element of the data input, the values are parsed into their own array first. */
+    const long label = InputParser::parse(pInput, m_values.data(), m_numParams);
+
+    const int64_t timestampMs = chrono::duration_cast<chrono::milliseconds>(
+        chrono::system_clock::now().time_since_epoch()).count();
+    const int32_t label32 = static_cast<int32_t>(label);
+
+    char* pRecord = m_record.data();
+    memcpy(pRecord + RECORD_OFFSET_TIMESTAMP, &timestampMs, sizeof(timestampMs));
+    memcpy(pRecord + RECORD_OFFSET_LABEL, &label32, sizeof(label32));
+    memcpy(pRecord + RECORD_OFFSET_VALUES, m_values.data(), m_numParams * sizeof(double));
+}
+
+/**
+ * Log the training data.
+ */
+void BinaryLogger::logTrainingData(vector<string>* pParamNames, const string* pInput)
+{
+    open(pParamNames, nullptr);
+
+    setInput(pInput);
+    write(m_record.data(), m_record.size());
+}
+
+/**
+ * Log the inference results.
+ */
+void BinaryLogger::logInferenceResult(vector<string>* pParamNames, const string* pInput, const vector<pair<string, int>>* pInferences)
+{
+    open(pParamNames, pInferences);
+
+    setInput(pInput);
+
+    /* Then the inference/prediction results. */
+    char* pInference = m_record.data() + RECORD_OFFSET_VALUES + m_numParams * sizeof(double);
+    for(vector<pair<string, int>>::const_iterator it = pInferences->begin(); it != pInferences->end(); ++it)
+    {
+        const int32_t inference = static_cast<int32_t>(it->second);
+        memcpy(pInference, &inference, sizeof(inference));
+        pInference += sizeof(inference);
+    }
+
+    write(m_record.data(), m_record.size());
+}
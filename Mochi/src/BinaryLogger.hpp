@@ -0,0 +1,107 @@
+#ifndef BINARY_LOGGER_H_
+#define BINARY_LOGGER_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Appends the training data or the inference results to a binary log file of fixed-width records, the alternative to
+ * CsvLogger that neither formats values as text when logging nor parses them when replaying. See BinaryLogReader.
+ *
+ * File format, little-endian:
+ * - Header: "OAILOG01", then the header size, the record size, the number of params and the number of models as uint32,
+ *   then the param names and the model names, each as a uint16 length followed by the characters, zero-padded to a
+ *   multiple of 8 bytes.
+ * - Records: the timestamp in milliseconds since the epoch as int64, the target label as int32, 4 bytes of padding,
+ *   the input values as doubles, then the inference of each model as int32 for the inference log, zero-padded to a
+ *   multiple of 8 bytes.
+ *
+ * Input values are stored at their index, e.g. the value of "3:0.5" as the third value, and missing ones as 0.
+ * The record is built in a preallocated buffer, so that logging a sample does not allocate heap memory.
+ * The file is rotated like the CSV logs, see LogRotation, every segment starting with the header. A log file left by
+ * a run with other params or models is rotated too, so that all the records of a file have the same layout.
+ */
+class BinaryLogger
+{
+private:
+    /* Path of the log file. */
+    const char* m_filePath;
+
+    /* The open log file, null until the first record is logged. */
+    FILE* m_pFile;
+
+    /* Size of the log file and when this logger started writing to it, to rotate it. */
+    size_t m_segmentSize;
+    time_t m_segmentStart;
+
+    /* The header and the buffer the records are built in, built when the log file is first opened. */
+    string m_header;
+    vector<char> m_record;
+    size_t m_numParams;
+
+    /* The input values of the record being built. */
+    vector<double> m_values;
+
+    /**
+     * Open the log file, writing the header with the given param and model names if the file is being created.
+     * The open log file is rotated first if it is due, the new file starting with the header.
+     */
+    void open(const vector<string>* pParamNames, const vector<pair<string, int>>* pModels);
+
+    /**
+     * Build the header with the given param and model names, no model names for the training log, and size the record buffer.
+     */
+    void buildHeader(const vector<string>* pParamNames, const vector<pair<string, int>>* pModels);
+
+    /**
+     * Whether the log file starts with the header of this logger.
+     */
+    bool hasHeader();
+
+    /**
+     * Write the given bytes to the log file.
+     */
+    void write(const char* pBytes, size_t length);
+
+    /**
+     * Set the timestamp, the target label and the input values of the record from an input string such as "+1 1:1.232 2:2.412".
+     */
+    void setInput(const string* pInput);
+
+    /* Hide constructor. */
+    BinaryLogger() {};
+
+public:
+
+    /* Constructor. */
+    BinaryLogger(const char* filePath);
+
+    /* Destructor. */
+    ~BinaryLogger();
+
+    BinaryLogger(const BinaryLogger&) = delete;
+    BinaryLogger& operator=(const BinaryLogger&) = delete;
+
+    /**
+     * Close the log file, e.g. before deleting it. The next logged record opens it again.
+     */
+    void close();
+
+    /**
+     * Log the training data.
+     */
+    void logTrainingData(vector<string>* pParamNames, const string* pInput);
+
+    /**
+     * Log the inference results.
+     */
+    void logInferenceResult(vector<string>* pParamNames, const string* pInput, const vector<pair<string, int>>* pInferences);
+};
+
+#endif // BINARY_LOGGER_H_
@@ -4,12 +4,29 @@
 // TODO: Figure out if this is enough or too much.
 #define COMMAND_BUFFER_LENGTH                                 10000
 
+/* Longest row written to the training and inference logs. */
+#define LOG_ROW_BUFFER_LENGTH                                 20000
+
 #define DIR_PATH_LOGS                                         "logs"
 #define DIR_PATH_MODELS                                     "models"
+#define DIR_PATH_SNAPSHOTS                               "snapshots"
 
 #define LOG_FILEPATH_TRAINING                   "logs/training.csv"
 #define LOG_FILEPATH_INFERENCE                 "logs/inference.csv"
 #define LOG_FILEPATH_ORBITAI                     "logs/orbitai.log"
+#define LOG_FILEPATH_METRICS                     "logs/metrics.csv"
+#define LOG_FILEPATH_TRAINING_BINARY            "logs/training.bin"
+#define LOG_FILEPATH_INFERENCE_BINARY          "logs/inference.bin"
+
+/* Format of the training and inference logs. */
+#define LOG_FORMAT_BINARY                                  "binary"
+
+/* Identifies a binary training or inference log and its format version. */
+#define BINARY_LOG_MAGIC                                 "OAILOG01"
+#define BINARY_LOG_MAGIC_LENGTH                                   8
+
+/* File name of the replay buffer, saved with the models. */
+#define REPLAY_BUFFER_FILENAME                      "REPLAY_BUFFER"
 
 /* Commands. */
 #define COMMAND_RESET                                       "reset"
@@ -18,6 +35,17 @@
 #define COMMAND_SAVE_LENGTH                                       4
 #define COMMAND_EXIT                                         "exit"
 #define COMMAND_EXIT_LENGTH                                       4
+#define COMMAND_EPOCHS                                     "epochs"
+#define COMMAND_EPOCHS_LENGTH                                     6
+#define COMMAND_METRICS                                   "metrics"
+#define COMMAND_METRICS_LENGTH                                    7
+#define COMMAND_EXPORT                                     "export"
+#define COMMAND_EXPORT_LENGTH                                     6
+#define COMMAND_STATS                                       "stats"
+#define COMMAND_STATS_LENGTH                                      5
+
+/* Seed of the shuffled epochs command when none is given. */
+#define EPOCHS_SHUFFLE_SEED_DEFAULT                               1
 
 /* Exit program loop flag */
 #define EXIT_PROGRAM_LOOP_YES                                     1
@@ -36,5 +64,8 @@
 #define ERROR_GRAB_CONNECTION                                     9
 #define ERROR_PROCESSING_RECEIVED_COMMAND                        10
 #define ERROR_SERIALIZED_MODE_NOT_EXIST                          11
+#define ERROR_HOT_PATH_ALLOCATION                                12
+#define ERROR_REPLAY_BUFFER_INCOMPATIBLE                         13
+#define ERROR_LOG_COMPRESSION                                    14
 
 #endif // CONSTANTS_H_
\ No newline at end of file
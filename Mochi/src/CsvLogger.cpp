@@ -0,0 +1,322 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <sys/stat.h>
+
+#include "Utils.hpp"
+#include "LogRotation.hpp"
+#include "CsvLogger.hpp"
+
+/**
+ * Constructor.
+ */
+CsvLogger::CsvLogger(const char* filePath) :
+    m_filePath(filePath),
+    m_pFile(nullptr),
+    m_segmentSize(0),
+    m_segmentStart(0),
+    m_row(LOG_ROW_BUFFER_LENGTH),
+    m_rowLength(0)
+{
+}
+
+/**
+ * Destructor.
+ */
+CsvLogger::~CsvLogger()
+{
+    close();
+}
+
+/**
+ * Close the log file, e.g. before deleting it. The next logged row opens it again.
+ */
+void CsvLogger::close()
+{
+    if(m_pFile != nullptr)
+    {
+        fclose(m_pFile);
+        m_pFile = nullptr;
+    }
+}
+
+/**
+ * Open the log file, writing the header row built by the given function if the file is being created.
+ */
+template<typename WriteHeader>
+void CsvLogger::open(WriteHeader writeHeader)
+{
+    bool isNewFile;
+    if(m_pFile == nullptr)
+    {
+        /* Write the header row if the file is being created. */
+        isNewFile = !exists(m_filePath);
+
+        /* Open the file, append to it if it already exists. */
+        m_pFile = fopen(m_filePath, "a");
+    }
+    else if(LogRotation::isDue(m_segmentSize, m_segmentStart))
+    {
+        /* Rotating is rare and may allocate, the new file reuses the stream so that reopening it does not. */
+        LogRotation::rotate(m_filePath);
+        isNewFile = true;
+        m_pFile = freopen(m_filePath, "a", m_pFile);
+    }
+    else
+    {
+        return;
+    }
+
+    if(m_pFile == nullptr)
+    {
+        throw runtime_error(string("Failed to open log file: ") + m_filePath);
+    }
+
+    /* Rows are formatted in their own buffer and written at once. */
+    setvbuf(m_pFile, nullptr, _IONBF, 0);
+
+    /* A file left by a previous run is rotated by its size, and by its age counted from now. */
+    struct stat fileStat;
+    m_segmentSize = fstat(fileno(m_pFile), &fileStat) == 0 ? fileStat.st_size : 0;
+    m_segmentStart = time(nullptr);
+
+    if(isNewFile)
+    {
+        writeHeader();
+        writeRow();
+    }
+}
+
+/**
+ * Append characters to the row.
+ */
+void CsvLogger::append(const char* pChars, size_t length)
+{
+    if(m_rowLength + length >= m_row.size())
+    {
+        m_rowLength = 0;
+        throw length_error("Log row exceeds the log row buffer length.");
+    }
+
+    memcpy(m_row.data() + m_rowLength, pChars, length);
+    m_rowLength += length;
+}
+
+void CsvLogger::append(const char* pChars)
+{
+    append(pChars, strlen(pChars));
+}
+
+void CsvLogger::append(const string& str)
+{
+    append(str.data(), str.size());
+}
+
+void CsvLogger::append(char c)
+{
+    append(&c, 1);
+}
+
+void CsvLogger::append(long long value)
+{
+    char digits[24];
+    const int length = snprintf(digits, sizeof(digits), "%lld", value);
+    append(digits, length);
+}
+
+void CsvLogger::append(double value)
+{
+    char digits[32];
+    const int length = snprintf(digits, sizeof(digits), "%.6f", value);
+    append(digits, length);
+}
+
+/**
+ * Append the current time in milliseconds since the epoch.
+ */
+void CsvLogger::appendTimestamp()
+{
+    const long long timestampMs = chrono::duration_cast<chrono::milliseconds>(
+        chrono::system_clock::now().time_since_epoch()).count();
+
+    append(timestampMs);
+}
+
+/**
+ * Append the timestamp, the target label and the input values of an input string such as "+1 1:1.232 2:2.412".
+ */
+void CsvLogger::appendInput(const string* pInput, bool trailingComma)
+{
+    /* The first two values are the timestamp and the target label. */
+    /* The target label is the first element of the data input. */
+    const char* pCursor = pInput->c_str();
+    char* pEnd;
+    const long label = strtol(pCursor, &pEnd, 10);
+    if(pEnd == pCursor)
+    {
+        m_rowLength = 0;
+        throw invalid_argument("Missing label in input: " + *pInput);
+    }
+    pCursor = pEnd;
+
+    appendTimestamp();
+    append(',');
+    append(static_cast<long long>(label));
+
+    /**
+     * The remaining elements of the data input are the data inputs themselves.
+     * Each data input is prefixed with an index and colon, they have to be removed prior to logging.
+     *      Before: 1:5.232 2:4.412 3:3.123 4:2.23223
+     *      After:    5.232,  4.412,  3.123,  2.23223
+     */
+    while(*pCursor != '\0')
+    {
+        /* Skip the separator. */
+        if(*pCursor == ' ')
+        {
+            ++pCursor;
+            continue;
+        }
+
+        /* Fetch the input value, ignore the index and colon character. */
+        const char* pColon = pCursor;
+        while(*pColon != ':' && *pColon != ' ' && *pColon != '\0')
+        {
+            ++pColon;
+        }
+        if(*pColon != ':')
+        {
+            m_rowLength = 0;
+            throw invalid_argument("Invalid index:value pair in input: " + *pInput);
+        }
+
+        const char* pValue = pColon + 1;
+        pCursor = pValue;
+        while(*pCursor != ' ' && *pCursor != '\0')
+        {
+            ++pCursor;
+        }
+
+        /* Write input value. */
+        append(',');
+        append(pValue, pCursor - pValue);
+    }
+
+    if(trailingComma)
+    {
+        append(',');
+    }
+}
+
+/**
+ * Write the row, ended with a newline, to the log file and clear it.
+ */
+void CsvLogger::writeRow()
+{
+    append('\n');
+    const size_t length = m_rowLength;
+    m_rowLength = 0;
+
+    if(fwrite(m_row.data(), 1, length, m_pFile) != length)
+    {
+        throw runtime_error(string("Failed to write to log file: ") + m_filePath);
+    }
+    m_segmentSize += length;
+}
+
+/**
+ * Log the training data.
+ */
+void CsvLogger::logTrainingData(vector<string>* pParamNames, const string* pInput)
+{
+    open([&]()
+    {
+        /* First two columns are the timestamp and the target label, then the param names. */
+        append("timestamp,label");
+        for(vector<string>::iterator it = pParamNames->begin(); it != pParamNames->end(); ++it)
+        {
+            append(',');
+            append(*it);
+        }
+    });
+
+    /* The data input is converted from whitespace-separated to comma-separated. */
+    appendInput(pInput, false);
+    writeRow();
+}
+
+/**
+ * Log the inference results.
+ */
+void CsvLogger::logInferenceResult(vector<string>* pParamNames, const string* pInput, const vector<pair<string, int>>* pInferences)
+{
+    open([&]()
+    {
+        /* First two columns are the timestamp and the target label, then the param names. */
+        append("timestamp,label,");
+        for(vector<string>::iterator it = pParamNames->begin(); it != pParamNames->end(); ++it)
+        {
+            append(*it);
+            append(',');
+        }
+
+        /* And finally the name of the algorithms that made the label inferences/predictions. */
+        for(vector<pair<string, int>>::const_iterator it = pInferences->begin(); it != pInferences->end(); ++it)
+        {
+            if(it != pInferences->begin())
+            {
+                append(',');
+            }
+            append(it->first);
+        }
+    });
+
+    /* The data input is converted from whitespace-separated to comma-separated. */
+    appendInput(pInput, true);
+
+    /* Then write the inference/prediction results. */
+    for(vector<pair<string, int>>::const_iterator it = pInferences->begin(); it != pInferences->end(); ++it)
+    {
+        if(it != pInferences->begin())
+        {
+            append(',');
+        }
+        append(static_cast<long long>(it->second));
+    }
+
+    writeRow();
+}
+
+/**
+ * Log the prequential balanced accuracy and F1 score of each model.
+ */
+void CsvLogger::logMetrics(const vector<pair<string, int>>* pModels, const PrequentialMetrics* pMetrics)
+{
+    open([&]()
+    {
+        /* First two columns are the timestamp and the number of samples evaluated, then two columns per model. */
+        append("timestamp,samples");
+        for(vector<pair<string, int>>::const_iterator it = pModels->begin(); it != pModels->end(); ++it)
+        {
+            append(',');
+            append(it->first);
+            append("_balanced_accuracy,");
+            append(it->first);
+            append("_f1_score");
+        }
+    });
+
+    appendTimestamp();
+    append(',');
+    append(static_cast<long long>(pMetrics->getNumSamples()));
+
+    for(size_t i = 0; i < pModels->size(); ++i)
+    {
+        append(',');
+        append(pMetrics->getBalancedAccuracy(i));
+        append(',');
+        append(pMetrics->getF1Score(i));
+    }
+    writeRow();
+}
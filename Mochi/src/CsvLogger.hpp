@@ -0,0 +1,106 @@
+#ifndef CSV_LOGGER_H_
+#define CSV_LOGGER_H_
+
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Constants.hpp"
+#include "PrequentialMetrics.hpp"
+
+using namespace std;
+
+/**
+ * Appends the training data or the inference results to a CSV log file.
+ * The file is kept open and rows are formatted in a preallocated buffer, so that logging a sample does not allocate
+ * heap memory. The file is unbuffered: every row is written out as soon as it is logged.
+ * The file is rotated into a closed segment when it reaches the segment size or age, see LogRotation.
+ */
+class CsvLogger
+{
+private:
+    /* Path of the log file. */
+    const char* m_filePath;
+
+    /* The open log file, null until the first row is logged. */
+    FILE* m_pFile;
+
+    /* Size of the log file and when this logger started writing to it, to rotate it. */
+    size_t m_segmentSize;
+    time_t m_segmentStart;
+
+    /* Buffer the rows are formatted in. */
+    vector<char> m_row;
+    size_t m_rowLength;
+
+    /**
+     * Open the log file, writing the header row built by the given function if the file is being created.
+     * The open log file is rotated first if it is due, the new file starting with the header row.
+     */
+    template<typename WriteHeader>
+    void open(WriteHeader writeHeader);
+
+    /**
+     * Append characters to the row.
+     */
+    void append(const char* pChars, size_t length);
+    void append(const char* pChars);
+    void append(const string& str);
+    void append(char c);
+    void append(long long value);
+    void append(double value);
+
+    /**
+     * Append the current time in milliseconds since the epoch.
+     */
+    void appendTimestamp();
+
+    /**
+     * Append the timestamp, the target label and the input values of an input string such as "+1 1:1.232 2:2.412",
+     * separated by commas. Each input value is followed by a comma if trailingComma is set.
+     */
+    void appendInput(const string* pInput, bool trailingComma);
+
+    /**
+     * Write the row, ended with a newline, to the log file and clear it.
+     */
+    void writeRow();
+
+    /* Hide constructor. */
+    CsvLogger() {};
+
+public:
+
+    /* Constructor. */
+    CsvLogger(const char* filePath);
+
+    /* Destructor. */
+    ~CsvLogger();
+
+    /**
+     * Close the log file, e.g. before deleting it. The next logged row opens it again.
+     */
+    void close();
+
+    /**
+     * Log the training data.
+     * The pointer to the param names is only required in case the file is created for the first time and a header row is needed.
+     */
+    void logTrainingData(vector<string>* pParamNames, const string* pInput);
+
+    /**
+     * Log the inference results.
+     * The pointer to the param names is only required in case the file is created for the first time and a header row is needed.
+     */
+    void logInferenceResult(vector<string>* pParamNames, const string* pInput, const vector<pair<string, int>>* pInferences);
+
+    /**
+     * Log the prequential balanced accuracy and F1 score of each model.
+     * The models are named by the first element of the pairs, in the same order as the models of the metrics.
+     */
+    void logMetrics(const vector<pair<string, int>>* pModels, const PrequentialMetrics* pMetrics);
+};
+
+#endif // CSV_LOGGER_H_
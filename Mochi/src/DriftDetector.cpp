@@ -0,0 +1,85 @@
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "DriftDetector.hpp"
+
+/**
+ * Constructor.
+ */
+DriftDetector::DriftDetector(size_t minNumSamples) :
+    m_minNumSamples(minNumSamples)
+{
+    reset();
+}
+
+/**
+ * Start over, e.g. after a drift.
+ */
+void DriftDetector::reset()
+{
+    m_numSamples = 0;
+    m_errorRate = 0;
+    m_minErrorRate = numeric_limits<double>::max();
+    m_minStdDev = numeric_limits<double>::max();
+}
+
+/**
+ * Update the error rate with whether or not the model mispredicted the latest sample and return the drift level.
+ */
+DriftLevel DriftDetector::update(bool error)
+{
+    m_numSamples++;
+    m_errorRate += ((error ? 1.0 : 0.0) - m_errorRate) / m_numSamples;
+    const double stdDev = sqrt(m_errorRate * (1 - m_errorRate) / m_numSamples);
+
+    /* Without any error yet the standard deviation is 0 and the very first error would be a drift. */
+    if(m_numSamples < m_minNumSamples || m_errorRate == 0)
+    {
+        return DriftLevel::stable;
+    }
+
+    if(m_errorRate + stdDev <= m_minErrorRate + m_minStdDev)
+    {
+        m_minErrorRate = m_errorRate;
+        m_minStdDev = stdDev;
+    }
+
+    if(m_errorRate + stdDev > m_minErrorRate + 3 * m_minStdDev)
+    {
+        reset();
+        return DriftLevel::drift;
+    }
+
+    if(m_errorRate + stdDev > m_minErrorRate + 2 * m_minStdDev)
+    {
+        return DriftLevel::warning;
+    }
+
+    return DriftLevel::stable;
+}
+
+/**
+ * Parse a drift action name: none, log, reset or shadow.
+ */
+DriftAction DriftDetector::parseAction(const string& actionName)
+{
+    if(actionName.empty() || actionName.compare("none") == 0)
+    {
+        return DriftAction::none;
+    }
+    else if(actionName.compare("log") == 0)
+    {
+        return DriftAction::log;
+    }
+    else if(actionName.compare("reset") == 0)
+    {
+        return DriftAction::reset;
+    }
+    else if(actionName.compare("shadow") == 0)
+    {
+        return DriftAction::shadow;
+    }
+
+    throw invalid_argument("Invalid drift action: " + actionName);
+}
@@ -0,0 +1,68 @@
+#ifndef DRIFT_DETECTOR_H_
+#define DRIFT_DETECTOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+/* Levels reported by the drift detector. */
+enum class DriftLevel {
+    stable = 0,
+    warning = 1,
+    drift = 2
+};
+
+/* What to do with a model whose predictions drifted. */
+enum class DriftAction {
+    none = 0,
+    log = 1,
+    reset = 2,
+    shadow = 3
+};
+
+/**
+ * Drift Detection Method (DDM, Gama et al. 2004) fed by the prediction errors of a model on the training stream.
+ * It tracks the error rate p and its standard deviation s = sqrt(p * (1 - p) / n) over the samples seen since the last
+ * drift, and the minimum of p + s. The error rate rising two standard deviations above that minimum is a warning, three
+ * is a drift, after which the detector starts over. Each update is O(1) and does not allocate heap memory.
+ */
+class DriftDetector
+{
+private:
+    /* Samples to see before a drift can be reported. */
+    size_t m_minNumSamples;
+
+    uint64_t m_numSamples;
+    double m_errorRate;
+
+    /* The error rate and standard deviation at the minimum of their sum. */
+    double m_minErrorRate;
+    double m_minStdDev;
+
+    /* Hide constructor. */
+    DriftDetector() {};
+
+public:
+
+    /* Constructor. */
+    DriftDetector(size_t minNumSamples);
+
+    /**
+     * Update the error rate with whether or not the model mispredicted the latest sample and return the drift level.
+     */
+    DriftLevel update(bool error);
+
+    /**
+     * Start over, e.g. after a drift.
+     */
+    void reset();
+
+    /**
+     * Parse a drift action name: none, log, reset or shadow.
+     */
+    static DriftAction parseAction(const string& actionName);
+};
+
+#endif // DRIFT_DETECTOR_H_
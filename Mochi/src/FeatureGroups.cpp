@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "Constants.hpp"
+#include "FeatureGroups.hpp"
+
+/**
+ * Constructor, without groups.
+ */
+FeatureGroups::FeatureGroups()
+{
+}
+
+/**
+ * Constructor, given the input param names and the groups.
+ */
+FeatureGroups::FeatureGroups(const vector<string>& paramNames, const vector<pair<string, vector<string>>>& groups) :
+    m_values(paramNames.size(), pair<const char*, size_t>(nullptr, 0))
+{
+    for(vector<pair<string, vector<string>>>::const_iterator group = groups.begin(); group != groups.end(); ++group)
+    {
+        if(group->second.empty())
+        {
+            throw invalid_argument("Feature group without input params: " + group->first);
+        }
+
+        vector<size_t> paramIndices;
+        for(vector<string>::const_iterator it = group->second.begin(); it != group->second.end(); ++it)
+        {
+            vector<string>::const_iterator param = find(paramNames.begin(), paramNames.end(), *it);
+            if(param == paramNames.end())
+            {
+                throw invalid_argument("Feature group " + group->first + " with an input param that is not one of the inputs: " + *it);
+            }
+            paramIndices.push_back(param - paramNames.begin());
+        }
+
+        m_names.push_back(group->first);
+        m_paramIndices.push_back(paramIndices);
+
+        /* Allocated once, a group input is never longer than the input it is projected from. */
+        m_inputs.push_back(string());
+        m_inputs.back().reserve(COMMAND_BUFFER_LENGTH);
+    }
+}
+
+/**
+ * Parse the given input and assemble the input of every group.
+ */
+void FeatureGroups::project(const string* pInput)
+{
+    const char* pCursor = pInput->c_str();
+    const char* pEnd = pCursor + pInput->size();
+
+    /* The label is the first element of the input. */
+    pCursor = find_if(pCursor, pEnd, [](char c) { return c != ' '; });
+    const char* pLabelEnd = find(pCursor, pEnd, ' ');
+    const char* pLabel = pCursor;
+    pCursor = pLabelEnd;
+
+    /* Then the index:value elements, indexed from 1. */
+    fill(m_values.begin(), m_values.end(), pair<const char*, size_t>(nullptr, 0));
+    while(pCursor != pEnd)
+    {
+        pCursor = find_if(pCursor, pEnd, [](char c) { return c != ' '; });
+        const char* pElementEnd = find(pCursor, pEnd, ' ');
+        const char* pColon = find(pCursor, pElementEnd, ':');
+
+        const size_t index = strtoul(pCursor, nullptr, 10);
+        if(pColon != pElementEnd && index >= 1 && index <= m_values.size())
+        {
+            m_values[index - 1] = pair<const char*, size_t>(pColon + 1, pElementEnd - pColon - 1);
+        }
+        pCursor = pElementEnd;
+    }
+
+    /* Missing values are left out of the group inputs, as in a sparse input. */
+    char index[24];
+    for(size_t group = 0; group < m_names.size(); ++group)
+    {
+        string& input = m_inputs[group];
+        input.assign(pLabel, pLabelEnd - pLabel);
+
+        const vector<size_t>& paramIndices = m_paramIndices[group];
+        for(size_t i = 0; i < paramIndices.size(); ++i)
+        {
+            const pair<const char*, size_t>& value = m_values[paramIndices[i]];
+            if(value.first != nullptr)
+            {
+                const int length = snprintf(index, sizeof(index), " %zu:", i + 1);
+                input.append(index, length);
+                input.append(value.first, value.second);
+            }
+        }
+    }
+}
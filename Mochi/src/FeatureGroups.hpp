@@ -0,0 +1,84 @@
+#ifndef FEATURE_GROUPS_H_
+#define FEATURE_GROUPS_H_
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Named subsets of the input params, e.g. a 1D group with the first param only and a 2D group with the first two params,
+ * so that one server trains a set of models per subset from the same input stream.
+ *
+ * An input is parsed once by project() into views of its values, which are then assembled into the input of every group,
+ * with the values reindexed from 1 in the order of the group. The group inputs are allocated once, so that projecting
+ * an input does not allocate.
+ */
+class FeatureGroups
+{
+private:
+    /* The group names and the indices, from 0, of the input params of each group. */
+    vector<string> m_names;
+    vector<vector<size_t>> m_paramIndices;
+
+    /* The input of each group, assembled by the latest projection. */
+    vector<string> m_inputs;
+
+    /* Views of the values of the latest projected input, by param index. Null for a missing value. */
+    vector<pair<const char*, size_t>> m_values;
+
+public:
+
+    /**
+     * Constructor, without groups.
+     */
+    FeatureGroups();
+
+    /**
+     * Constructor, given the input param names and the names of the groups with the names of their input params.
+     * Throws if a group has no input params or an input param that is not one of the given input params.
+     */
+    FeatureGroups(const vector<string>& paramNames, const vector<pair<string, vector<string>>>& groups);
+
+    /**
+     * Whether any group is set, otherwise the models are trained on all the input params.
+     */
+    bool isEnabled() const
+    {
+        return !m_names.empty();
+    }
+
+    size_t getNumGroups() const
+    {
+        return m_names.size();
+    }
+
+    const string& getName(size_t group) const
+    {
+        return m_names[group];
+    }
+
+    /* The input dimension of the given group. */
+    size_t getDim(size_t group) const
+    {
+        return m_paramIndices[group].size();
+    }
+
+    /**
+     * Parse the given input, e.g. "+1 1:0.01 2:0.67 3:0.12", and assemble the input of every group, e.g. "+1 1:0.01 2:0.67"
+     * for a group of the first two params. The values are copied as they are written in the given input.
+     */
+    void project(const string* pInput);
+
+    /**
+     * The input of the given group assembled by the latest projection.
+     */
+    string* getInput(size_t group)
+    {
+        return &m_inputs[group];
+    }
+};
+
+#endif // FEATURE_GROUPS_H_
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+
+#include "HoeffdingForest.hpp"
+#include "InputParser.hpp"
+
+/**
+ * Constructor.
+ */
+HoeffdingForest::HoeffdingForest(size_t dim, size_t numTrees, size_t maxNodes, size_t gracePeriod, double delta, double tau, unsigned int seed) :
+    m_dim(dim),
+    m_numTrees(numTrees),
+    m_maxNodes(maxNodes),
+    m_rng(seed),
+    m_x(dim, 0)
+{
+    m_params.gracePeriod = gracePeriod;
+    m_params.delta = delta;
+    m_params.tau = tau;
+
+    /* Square root of the number of features, as in a batch random forest. */
+    m_params.numSplitFeatures = static_cast<size_t>(ceil(sqrt(static_cast<double>(dim))));
+
+    for(size_t i = 0; i < m_numTrees; ++i)
+    {
+        m_trees.push_back(HoeffdingTree(m_dim, m_maxNodes));
+    }
+}
+
+/**
+ * Parse an input string such as "+1 1:1.232 2:2.412" into m_x and return the class index of the label.
+ */
+int HoeffdingForest::parseInput(string* pInput)
+{
+    return InputParser::parse(pInput, m_x.data(), m_dim) > 0 ? 1 : 0;
+}
+
+/**
+ * Train/update the trees with the given training input.
+ */
+void HoeffdingForest::train(string* pInput, int dim)
+{
+    const int classIndex = parseInput(pInput);
+
+    /* Online bagging. */
+    poisson_distribution<int> poisson(1.0);
+
+    for(vector<HoeffdingTree>::iterator it = m_trees.begin(); it != m_trees.end(); ++it)
+    {
+        const int weight = poisson(m_rng);
+        if(weight > 0)
+        {
+            it->train(m_x, classIndex, weight, m_params, m_rng);
+        }
+    }
+}
+
+/**
+ * Train/update the trees with the given training input and save/serialize the model.
+ */
+void HoeffdingForest::trainAndSave(string* pInput, size_t dim, const string modelFilePath)
+{
+    train(pInput, dim);
+    save(modelFilePath);
+}
+
+/**
+ * Infer/predict the label (+1 or -1) of the given input by majority vote of the trees, ties predict -1.
+ */
+int HoeffdingForest::infer(string* pInput, size_t dim)
+{
+    parseInput(pInput);
+
+    size_t votes = 0;
+    for(vector<HoeffdingTree>::const_iterator it = m_trees.begin(); it != m_trees.end(); ++it)
+    {
+        votes += it->predict(m_x);
+    }
+
+    return 2 * votes > m_trees.size() ? 1 : -1;
+}
+
+/**
+ * Load a saved/serialized model.
+ */
+void HoeffdingForest::load(const string modelFilePath)
+{
+    ifstream ifs(modelFilePath);
+    boost::archive::text_iarchive ia(ifs);
+
+    vector<HoeffdingTree> trees;
+    ia >> trees;
+
+    if(trees.size() != m_numTrees)
+    {
+        throw invalid_argument("Model number of trees does not match the configured number of trees: " + modelFilePath);
+    }
+
+    for(vector<HoeffdingTree>::const_iterator it = trees.begin(); it != trees.end(); ++it)
+    {
+        if(it->getDim() != m_dim)
+        {
+            throw invalid_argument("Model input dimension does not match the configured inputs: " + modelFilePath);
+        }
+    }
+
+    m_trees.swap(trees);
+}
+
+/**
+ * Save/serialize the trained model.
+ */
+void HoeffdingForest::save(const string modelFilePath)
+{
+    ofstream ofs(modelFilePath);
+    boost::archive::text_oarchive oa(ofs);
+
+    oa << m_trees;
+}
@@ -0,0 +1,89 @@
+#ifndef HOEFFDING_FOREST_H_
+#define HOEFFDING_FOREST_H_
+
+#include <random>
+#include <string>
+#include <vector>
+
+/* The Binary Machine Learning Algorithm Factory, for the interface shared with the MochiMochi algorithms. */
+#include <mochimochi/classifier/factory/binary_oml_factory.hpp>
+
+#include "HoeffdingTree.hpp"
+
+using namespace std;
+
+/**
+ * Online random forest of Hoeffding trees for binary classification.
+ * It implements the same interface as the MochiMochi algorithms so that it is trained, queried, saved and loaded
+ * through the same server commands. Each tree sees every training sample k ~ Poisson(1) times (online bagging) and
+ * considers a random subset of the features at each split attempt. The model file is a Boost text archive, like
+ * the MochiMochi models.
+ */
+class HoeffdingForest : public BinaryOMLInterface
+{
+private:
+    /* Input dimension. */
+    size_t m_dim;
+
+    /* Number of trees and maximum number of nodes per tree, used when creating new trees. */
+    size_t m_numTrees;
+    size_t m_maxNodes;
+
+    /* Split hyperparameters. */
+    HoeffdingTreeParams m_params;
+
+    /* The trees. */
+    vector<HoeffdingTree> m_trees;
+
+    /* Random number generator for the bagging weights and the split feature subsets. */
+    mt19937 m_rng;
+
+    /* Input buffer reused by every command. */
+    vector<double> m_x;
+
+    /**
+     * Parse an input string such as "+1 1:1.232 2:2.412" into m_x and return the class index of the label.
+     */
+    int parseInput(string* pInput);
+
+    /* Hide constructor. */
+    HoeffdingForest() {};
+
+public:
+
+    /* Constructor. */
+    HoeffdingForest(size_t dim, size_t numTrees, size_t maxNodes, size_t gracePeriod, double delta, double tau, unsigned int seed);
+
+    string name()
+    {
+        return string("HOEFFDING_FOREST");
+    }
+
+    /**
+     * Train/update the trees with the given training input.
+     */
+    void train(string* pInput, int dim);
+
+    /**
+     * Train/update the trees with the given training input and save/serialize the model.
+     */
+    void trainAndSave(string* pInput, size_t dim, const string modelFilePath);
+
+    /**
+     * Infer/predict the label (+1 or -1) of the given input by majority vote of the trees, ties predict -1.
+     */
+    int infer(string* pInput, size_t dim);
+
+    /**
+     * Load a saved/serialized model. Throws if the model does not have the configured number of trees and input
+     * dimension or if a tree is corrupt, e.g. with a child node out of range.
+     */
+    void load(const string modelFilePath);
+
+    /**
+     * Save/serialize the trained model.
+     */
+    void save(const string modelFilePath);
+};
+
+#endif // HOEFFDING_FOREST_H_
@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "HoeffdingTree.hpp"
+
+namespace
+{
+
+/**
+ * Entropy in bits of a two class distribution.
+ */
+double entropy(double weight0, double weight1)
+{
+    const double total = weight0 + weight1;
+    double result = 0;
+
+    if(weight0 > 0)
+    {
+        result -= (weight0 / total) * log2(weight0 / total);
+    }
+
+    if(weight1 > 0)
+    {
+        result -= (weight1 / total) * log2(weight1 / total);
+    }
+
+    return result;
+}
+
+/**
+ * Estimated fraction of a Gaussian distributed feature that is lower or equal to the threshold.
+ */
+double fractionBelow(double mean, double variance, double threshold)
+{
+    if(variance <= 0)
+    {
+        return mean <= threshold ? 1.0 : 0.0;
+    }
+
+    return 0.5 * erfc(-(threshold - mean) / sqrt(2.0 * variance));
+}
+
+}
+
+/**
+ * Constructor.
+ */
+HoeffdingTree::HoeffdingTree(size_t dim, size_t maxNodes) :
+    m_dim(dim),
+    m_numNodes(1),
+    m_splitFeatures(maxNodes, -1),
+    m_thresholds(maxNodes, 0),
+    m_leftChildren(maxNodes, 0),
+    m_classWeights(maxNodes * 2, 0),
+    m_pendingWeights(maxNodes, 0),
+    m_stats(maxNodes * 2 * dim * HOEFFDING_STATS_SIZE, 0),
+    m_features(dim)
+{
+}
+
+/**
+ * Find the leaf reached by the given input.
+ */
+uint32_t HoeffdingTree::findLeaf(const vector<double>& x) const
+{
+    uint32_t node = 0;
+
+    while(m_splitFeatures[node] >= 0)
+    {
+        node = m_leftChildren[node] + (x[m_splitFeatures[node]] <= m_thresholds[node] ? 0 : 1);
+    }
+
+    return node;
+}
+
+/**
+ * Update the tree with the given sample.
+ */
+void HoeffdingTree::train(const vector<double>& x, int classIndex, double weight, const HoeffdingTreeParams& params, mt19937& rng)
+{
+    const uint32_t leaf = findLeaf(x);
+
+    m_classWeights[leaf * 2 + classIndex] += weight;
+    m_pendingWeights[leaf] += weight;
+
+    /* Weighted incremental mean and variance, plus range, of every feature. */
+    for(size_t feature = 0; feature < m_dim; ++feature)
+    {
+        double* pStats = &m_stats[statsIndex(leaf, classIndex, feature)];
+        const double value = x[feature];
+
+        if(pStats[0] == 0)
+        {
+            pStats[3] = value;
+            pStats[4] = value;
+        }
+        else
+        {
+            pStats[3] = min(pStats[3], value);
+            pStats[4] = max(pStats[4], value);
+        }
+
+        pStats[0] += weight;
+        const double diff = value - pStats[1];
+        pStats[1] += weight * diff / pStats[0];
+        pStats[2] += weight * diff * (value - pStats[1]);
+    }
+
+    if(m_pendingWeights[leaf] >= params.gracePeriod)
+    {
+        m_pendingWeights[leaf] = 0;
+        attemptSplit(leaf, params, rng);
+    }
+}
+
+/**
+ * Try to split the given leaf.
+ */
+void HoeffdingTree::attemptSplit(uint32_t leaf, const HoeffdingTreeParams& params, mt19937& rng)
+{
+    /* Memory is bounded: a full tree stops growing. */
+    if(m_numNodes + 2 > m_splitFeatures.size())
+    {
+        return;
+    }
+
+    /* The weights of the samples seen by the leaf itself, i.e. without the estimate inherited from its parent. */
+    const double weight0 = m_stats[statsIndex(leaf, 0, 0)];
+    const double weight1 = m_stats[statsIndex(leaf, 1, 0)];
+    const double totalWeight = weight0 + weight1;
+
+    /* Nothing to gain from splitting a pure leaf. */
+    if(weight0 == 0 || weight1 == 0)
+    {
+        return;
+    }
+
+    const double parentEntropy = entropy(weight0, weight1);
+
+    /* Random subset of the features, as in a random forest. */
+    for(size_t feature = 0; feature < m_dim; ++feature)
+    {
+        m_features[feature] = feature;
+    }
+    shuffle(m_features.begin(), m_features.end(), rng);
+    const size_t numFeatures = min(max<size_t>(params.numSplitFeatures, 1), m_dim);
+
+    double bestGain = 0;
+    double secondBestGain = 0;
+    size_t bestFeature = 0;
+    double bestThreshold = 0;
+    double bestLeftWeights[2] = {0, 0};
+
+    for(size_t candidate = 0; candidate < numFeatures; ++candidate)
+    {
+        const size_t feature = m_features[candidate];
+        const double* pStats0 = &m_stats[statsIndex(leaf, 0, feature)];
+        const double* pStats1 = &m_stats[statsIndex(leaf, 1, feature)];
+
+        const double lowest = min(pStats0[3], pStats1[3]);
+        const double highest = max(pStats0[4], pStats1[4]);
+
+        if(lowest >= highest)
+        {
+            continue;
+        }
+
+        /* Best threshold for this feature. */
+        double featureGain = 0;
+        double featureThreshold = 0;
+        double featureLeftWeights[2] = {0, 0};
+
+        for(size_t i = 1; i <= HOEFFDING_SPLIT_CANDIDATES; ++i)
+        {
+            const double threshold = lowest + (highest - lowest) * i / (HOEFFDING_SPLIT_CANDIDATES + 1);
+
+            const double left0 = weight0 * fractionBelow(pStats0[1], pStats0[2] / pStats0[0], threshold);
+            const double left1 = weight1 * fractionBelow(pStats1[1], pStats1[2] / pStats1[0], threshold);
+            const double leftWeight = left0 + left1;
+            const double rightWeight = totalWeight - leftWeight;
+
+            const double gain = parentEntropy
+                - (leftWeight / totalWeight) * entropy(left0, left1)
+                - (rightWeight / totalWeight) * entropy(weight0 - left0, weight1 - left1);
+
+            if(gain > featureGain)
+            {
+                featureGain = gain;
+                featureThreshold = threshold;
+                featureLeftWeights[0] = left0;
+                featureLeftWeights[1] = left1;
+            }
+        }
+
+        if(featureGain > bestGain)
+        {
+            secondBestGain = bestGain;
+            bestGain = featureGain;
+            bestFeature = feature;
+            bestThreshold = featureThreshold;
+            bestLeftWeights[0] = featureLeftWeights[0];
+            bestLeftWeights[1] = featureLeftWeights[1];
+        }
+        else if(featureGain > secondBestGain)
+        {
+            secondBestGain = featureGain;
+        }
+    }
+
+    /* Hoeffding bound for a gain range of 1 bit. */
+    const double epsilon = sqrt(log(1.0 / params.delta) / (2.0 * totalWeight));
+
+    if(bestGain <= 0 || (bestGain - secondBestGain <= epsilon && epsilon >= params.tau))
+    {
+        return;
+    }
+
+    /* Split: the children start with the class weights estimated for their side. */
+    const uint32_t left = m_numNodes;
+    m_numNodes += 2;
+
+    m_splitFeatures[leaf] = static_cast<int32_t>(bestFeature);
+    m_thresholds[leaf] = bestThreshold;
+    m_leftChildren[leaf] = left;
+
+    for(int classIndex = 0; classIndex < 2; ++classIndex)
+    {
+        const double classWeight = classIndex == 0 ? weight0 : weight1;
+        m_classWeights[left * 2 + classIndex] = bestLeftWeights[classIndex];
+        m_classWeights[(left + 1) * 2 + classIndex] = classWeight - bestLeftWeights[classIndex];
+    }
+
+    /* The statistics of an inner node are not needed anymore. */
+    fill(m_stats.begin() + statsIndex(leaf, 0, 0), m_stats.begin() + statsIndex(leaf + 1, 0, 0), 0.0);
+}
+
+/**
+ * Predict the class index of the given input.
+ */
+int HoeffdingTree::predict(const vector<double>& x) const
+{
+    const uint32_t leaf = findLeaf(x);
+    return m_classWeights[leaf * 2 + 1] > m_classWeights[leaf * 2] ? 1 : 0;
+}
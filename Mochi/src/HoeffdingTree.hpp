@@ -0,0 +1,223 @@
+#ifndef HOEFFDING_TREE_H_
+#define HOEFFDING_TREE_H_
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/vector.hpp>
+
+/* Number of candidate thresholds evaluated per feature when attempting a split. */
+#define HOEFFDING_SPLIT_CANDIDATES                                10
+
+/* Per node, class and feature: weight, mean, sum of squared differences from the mean, min, and max. */
+#define HOEFFDING_STATS_SIZE                                       5
+
+using namespace std;
+
+/**
+ * Hyperparameters shared by all the trees of a Hoeffding forest.
+ */
+struct HoeffdingTreeParams
+{
+    /* Number of samples a leaf sees between two split attempts. */
+    size_t gracePeriod;
+
+    /* Probability of choosing the wrong split feature, i.e. the confidence of the Hoeffding bound. */
+    double delta;
+
+    /* Split anyway when the Hoeffding bound gets smaller than this, in case two features are equally good. */
+    double tau;
+
+    /* Number of randomly chosen features evaluated at each split attempt. */
+    size_t numSplitFeatures;
+};
+
+/**
+ * Incremental binary classification tree (Very Fast Decision Tree).
+ *
+ * A leaf keeps, per class, Gaussian estimates of every feature. Every gracePeriod samples the leaf estimates the
+ * information gain of candidate thresholds and is split when the Hoeffding bound says that the best split is
+ * better than the second best with probability 1 - delta.
+ *
+ * Memory is bounded: all node arrays are allocated for maxNodes nodes when the tree is created and leaves stop
+ * splitting once the tree is full. A training update walks from the root to a leaf and updates that leaf only,
+ * i.e. it is O(depth + dim) plus the occasional split attempt.
+ */
+class HoeffdingTree
+{
+private:
+    friend class boost::serialization::access;
+
+    /* Input dimension. */
+    size_t m_dim;
+
+    /* Number of nodes in use. */
+    uint32_t m_numNodes;
+
+    /* Per node: split feature index, -1 for leaves. */
+    vector<int32_t> m_splitFeatures;
+
+    /* Per node: split threshold, values lower or equal go left. */
+    vector<double> m_thresholds;
+
+    /* Per node: index of the left child, the right child follows it. */
+    vector<uint32_t> m_leftChildren;
+
+    /* Per node and class: weight of the samples, used for predicting. Children inherit an estimate from their parent. */
+    vector<double> m_classWeights;
+
+    /* Per node: weight seen since the last split attempt. */
+    vector<double> m_pendingWeights;
+
+    /* Per node, class and feature: the HOEFFDING_STATS_SIZE statistics of the samples seen by the leaf. */
+    vector<double> m_stats;
+
+    /* Scratch buffer for the random feature subset of a split attempt, so that training does not allocate. Not saved. */
+    vector<size_t> m_features;
+
+    /* Index of the first statistic of the given node, class and feature. */
+    size_t statsIndex(uint32_t node, int classIndex, size_t feature) const
+    {
+        return ((node * 2 + classIndex) * m_dim + feature) * HOEFFDING_STATS_SIZE;
+    }
+
+    /* Find the leaf reached by the given input. */
+    uint32_t findLeaf(const vector<double>& x) const;
+
+    /* Try to split the given leaf. */
+    void attemptSplit(uint32_t leaf, const HoeffdingTreeParams& params, mt19937& rng);
+
+    /* Only the nodes in use are saved, the arrays are allocated back to their full size when loading. */
+    template<class Archive>
+    void save(Archive& ar, const unsigned int version) const
+    {
+        const size_t maxNodes = getMaxNodes();
+        ar & m_dim;
+        ar & maxNodes;
+        ar & m_numNodes;
+
+        for(uint32_t node = 0; node < m_numNodes; ++node)
+        {
+            ar & m_splitFeatures[node];
+            ar & m_thresholds[node];
+            ar & m_leftChildren[node];
+            ar & m_classWeights[node * 2];
+            ar & m_classWeights[node * 2 + 1];
+            ar & m_pendingWeights[node];
+
+            /* Inner nodes have no statistics. */
+            if(m_splitFeatures[node] < 0)
+            {
+                for(size_t i = statsIndex(node, 0, 0); i < statsIndex(node + 1, 0, 0); ++i)
+                {
+                    ar & m_stats[i];
+                }
+            }
+        }
+    }
+
+    template<class Archive>
+    void load(Archive& ar, const unsigned int version)
+    {
+        size_t dim;
+        size_t maxNodes;
+        uint32_t numNodes;
+        ar & dim;
+        ar & maxNodes;
+        ar & numNodes;
+
+        if(numNodes == 0 || numNodes > maxNodes)
+        {
+            throw invalid_argument("Invalid Hoeffding tree: no nodes or more nodes than its maximum number of nodes.");
+        }
+
+        /* Node indices are 32 bits and the size of the statistics array must not overflow. */
+        if(maxNodes > numeric_limits<uint32_t>::max()
+            || maxNodes > numeric_limits<size_t>::max() / (2 * HOEFFDING_STATS_SIZE)
+            || (dim > 0 && maxNodes * 2 * HOEFFDING_STATS_SIZE > numeric_limits<size_t>::max() / dim))
+        {
+            throw invalid_argument("Invalid Hoeffding tree: maximum number of nodes or input dimension out of range.");
+        }
+
+        *this = HoeffdingTree(dim, maxNodes);
+        m_numNodes = numNodes;
+
+        for(uint32_t node = 0; node < m_numNodes; ++node)
+        {
+            ar & m_splitFeatures[node];
+            ar & m_thresholds[node];
+            ar & m_leftChildren[node];
+            ar & m_classWeights[node * 2];
+            ar & m_classWeights[node * 2 + 1];
+            ar & m_pendingWeights[node];
+
+            if(m_splitFeatures[node] < 0)
+            {
+                for(size_t i = statsIndex(node, 0, 0); i < statsIndex(node + 1, 0, 0); ++i)
+                {
+                    ar & m_stats[i];
+                }
+            }
+        }
+
+        /**
+         * Every split feature must be an input and both children nodes in use. Children are always created after
+         * their parent, so a child index greater than the node's also rules out cycles that findLeaf would not leave.
+         */
+        for(uint32_t node = 0; node < m_numNodes; ++node)
+        {
+            if(m_splitFeatures[node] < 0)
+            {
+                continue;
+            }
+
+            if(static_cast<size_t>(m_splitFeatures[node]) >= m_dim
+                || m_leftChildren[node] <= node || m_leftChildren[node] >= m_numNodes - 1)
+            {
+                throw invalid_argument("Invalid Hoeffding tree: node " + to_string(node) + " has an out of range split feature or children.");
+            }
+        }
+    }
+
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
+
+public:
+
+    /* Constructor for deserialization. */
+    HoeffdingTree() : m_dim(0), m_numNodes(0) {}
+
+    /* Constructor. */
+    HoeffdingTree(size_t dim, size_t maxNodes);
+
+    /**
+     * Update the tree with the given sample. The class index is 0 for label -1 and 1 for label +1.
+     */
+    void train(const vector<double>& x, int classIndex, double weight, const HoeffdingTreeParams& params, mt19937& rng);
+
+    /**
+     * Predict the class index of the given input.
+     */
+    int predict(const vector<double>& x) const;
+
+    size_t getDim() const
+    {
+        return m_dim;
+    }
+
+    size_t getNumNodes() const
+    {
+        return m_numNodes;
+    }
+
+    size_t getMaxNodes() const
+    {
+        return m_splitFeatures.size();
+    }
+};
+
+#endif // HOEFFDING_TREE_H_
@@ -8,6 +8,9 @@ const string HyperParameters::ALGORITHM_NAME_AROW = "AROW";
 const string HyperParameters::ALGORITHM_NAME_SCW = "SCW";
 const string HyperParameters::ALGORITHM_NAME_NHERD = "NHERD";
 const string HyperParameters::ALGORITHM_NAME_PA = "PA";
+const string HyperParameters::ALGORITHM_NAME_HOEFFDING_FOREST = "HOEFFDING_FOREST";
+const string HyperParameters::ALGORITHM_NAME_SPARSE_ADAM = "SPARSE_ADAM";
+const string HyperParameters::ALGORITHM_NAME_SPARSE_ADAGRAD_RDA = "SPARSE_ADAGRAD_RDA";
 
 /**
  * Constructor.
@@ -21,6 +24,10 @@ HyperParameters::HyperParameters()
     vector<string> scwParams = {HYPER_PARAMETER_C, HYPER_PARAMETER_ETA};
     vector<string> nherdParams = {HYPER_PARAMETER_C, HYPER_PARAMETER_DIAGONAL};
     vector<string> paParams = {HYPER_PARAMETER_VARIANT, HYPER_PARAMETER_C};
+    vector<string> hoeffdingForestParams = {HYPER_PARAMETER_TREES, HYPER_PARAMETER_NODES, HYPER_PARAMETER_GRACE,
+        HYPER_PARAMETER_DELTA, HYPER_PARAMETER_TAU, HYPER_PARAMETER_SEED};
+    vector<string> sparseAdamParams = {};
+    vector<string> sparseAdagradRdaParams = {HYPER_PARAMETER_ETA, HYPER_PARAMETER_LAMBDA};
 
     /* Insert list of expected hyperparameters into a map. */
     m_hpMap.insert(pair<string, vector<string>>(HyperParameters::ALGORITHM_NAME_ADAM, adamParams));
@@ -29,6 +36,9 @@ HyperParameters::HyperParameters()
     m_hpMap.insert(pair<string, vector<string>>(HyperParameters::ALGORITHM_NAME_SCW, scwParams));
     m_hpMap.insert(pair<string, vector<string>>(HyperParameters::ALGORITHM_NAME_NHERD, nherdParams));
     m_hpMap.insert(pair<string, vector<string>>(HyperParameters::ALGORITHM_NAME_PA, paParams));
+    m_hpMap.insert(pair<string, vector<string>>(HyperParameters::ALGORITHM_NAME_HOEFFDING_FOREST, hoeffdingForestParams));
+    m_hpMap.insert(pair<string, vector<string>>(HyperParameters::ALGORITHM_NAME_SPARSE_ADAM, sparseAdamParams));
+    m_hpMap.insert(pair<string, vector<string>>(HyperParameters::ALGORITHM_NAME_SPARSE_ADAGRAD_RDA, sparseAdagradRdaParams));
 }
 
 /**
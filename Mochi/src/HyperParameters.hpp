@@ -7,6 +7,12 @@
 #define HYPER_PARAMETER_C                                                 "c"
 #define HYPER_PARAMETER_DIAGONAL                                   "diagonal"
 #define HYPER_PARAMETER_VARIANT                                     "variant"
+#define HYPER_PARAMETER_TREES                                         "trees"
+#define HYPER_PARAMETER_NODES                                         "nodes"
+#define HYPER_PARAMETER_GRACE                                         "grace"
+#define HYPER_PARAMETER_DELTA                                         "delta"
+#define HYPER_PARAMETER_TAU                                             "tau"
+#define HYPER_PARAMETER_SEED                                           "seed"
 
 #include <map>
 #include <string>
@@ -29,6 +35,9 @@ public:
     static const string ALGORITHM_NAME_SCW;
     static const string ALGORITHM_NAME_NHERD;
     static const string ALGORITHM_NAME_PA;
+    static const string ALGORITHM_NAME_HOEFFDING_FOREST;
+    static const string ALGORITHM_NAME_SPARSE_ADAM;
+    static const string ALGORITHM_NAME_SPARSE_ADAGRAD_RDA;
 
     /* Constructor. */
     HyperParameters();
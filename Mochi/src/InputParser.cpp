@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "InputParser.hpp"
+
+/**
+ * Parse the next index of an index:value pair, false at the end of the input.
+ */
+bool InputParser::parseIndex(const char** ppCursor, unsigned long* pIndex, const string* pInput)
+{
+    const char* pCursor = *ppCursor;
+    while(isspace(static_cast<unsigned char>(*pCursor)))
+    {
+        ++pCursor;
+    }
+
+    if(*pCursor == '\0')
+    {
+        return false;
+    }
+
+    char* pEnd;
+    *pIndex = strtoul(pCursor, &pEnd, 10);
+    if(pEnd == pCursor || *pEnd != ':')
+    {
+        throw invalid_argument("Invalid index:value pair in input: " + *pInput);
+    }
+
+    *ppCursor = pEnd + 1;
+    return true;
+}
+
+/**
+ * Parse the value of an index:value pair.
+ */
+double InputParser::parseValue(const char** ppCursor, const string* pInput)
+{
+    char* pEnd;
+    const double value = strtod(*ppCursor, &pEnd);
+    if(pEnd == *ppCursor)
+    {
+        throw invalid_argument("Invalid value in input: " + *pInput);
+    }
+
+    *ppCursor = pEnd;
+    return value;
+}
+
+/**
+ * Parse the label at the start of the input.
+ */
+long InputParser::parseLabel(const char** ppCursor, const string* pInput)
+{
+    char* pEnd;
+    const long label = strtol(*ppCursor, &pEnd, 10);
+    if(pEnd == *ppCursor)
+    {
+        throw invalid_argument("Missing label in input: " + *pInput);
+    }
+
+    *ppCursor = pEnd;
+    return label;
+}
+
+/**
+ * Parse the given input into the given array of dim values and return its label.
+ */
+long InputParser::parse(const string* pInput, double* pValues, size_t dim)
+{
+    const char* pCursor = pInput->c_str();
+
+    /* The label comes first. */
+    const long label = parseLabel(&pCursor, pInput);
+
+    /* The values are written in place as long as the indices are 1, 2, 3... */
+    size_t numValues = 0;
+    unsigned long index;
+    bool hasIndex = parseIndex(&pCursor, &index, pInput);
+    while(hasIndex && numValues < dim && index == numValues + 1)
+    {
+        pValues[numValues++] = parseValue(&pCursor, pInput);
+        hasIndex = parseIndex(&pCursor, &index, pInput);
+    }
+
+    /* Sparse path for the rest of the input, nothing is left of it for a dense input. */
+    fill(pValues + numValues, pValues + dim, 0.0);
+    while(hasIndex)
+    {
+        if(index < 1 || index > dim)
+        {
+            throw out_of_range("Input index out of the input dimension: " + *pInput);
+        }
+        pValues[index - 1] = parseValue(&pCursor, pInput);
+        hasIndex = parseIndex(&pCursor, &index, pInput);
+    }
+
+    return label;
+}
+
+/**
+ * Parse the non-zero values of the given input and their indices into the given arrays, and return its label.
+ */
+long InputParser::parseSparse(const string* pInput, size_t* pIndices, double* pValues, size_t dim, size_t* pNumValues)
+{
+    const char* pCursor = pInput->c_str();
+
+    /* The label comes first. */
+    const long label = parseLabel(&pCursor, pInput);
+
+    size_t numValues = 0;
+    unsigned long index;
+    while(parseIndex(&pCursor, &index, pInput))
+    {
+        if(index < 1 || index > dim)
+        {
+            throw out_of_range("Input index out of the input dimension: " + *pInput);
+        }
+
+        const double value = parseValue(&pCursor, pInput);
+        if(value != 0)
+        {
+            if(numValues == dim)
+            {
+                throw invalid_argument("More values than the input dimension in input: " + *pInput);
+            }
+
+            pIndices[numValues] = index - 1;
+            pValues[numValues] = value;
+            numValues++;
+        }
+    }
+
+    *pNumValues = numValues;
+    return label;
+}
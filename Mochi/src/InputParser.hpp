@@ -0,0 +1,47 @@
+#ifndef INPUT_PARSER_H_
+#define INPUT_PARSER_H_
+
+#include <cstddef>
+#include <string>
+
+using namespace std;
+
+/**
+ * Parses training and inference inputs such as "+1 1:1.232 2:2.412" into contiguous arrays of input values.
+ *
+ * On-board samples are dense, with every index from 1 to the input dimension given in order. Each value of such an input
+ * is written in place as it is parsed, without zeroing the array first nor checking the index range. The first index out
+ * of that order switches to the sparse path for the rest of the input: the values that are not given are 0, as for the
+ * MochiMochi algorithms' sparse inputs, and the given ones are written at their index. Used by the Hoeffding forest, the
+ * replay buffer and the binary logs, the MochiMochi algorithms parse their inputs themselves.
+ */
+class InputParser
+{
+private:
+    /* Parse the next index of an index:value pair, false at the end of the input. */
+    static bool parseIndex(const char** ppCursor, unsigned long* pIndex, const string* pInput);
+
+    /* Parse the label at the start of the input. */
+    static long parseLabel(const char** ppCursor, const string* pInput);
+
+    /* Parse the value of an index:value pair. */
+    static double parseValue(const char** ppCursor, const string* pInput);
+
+public:
+
+    /**
+     * Parse the given input into the given array of dim values and return its label.
+     * Throws if the input is malformed or has an index out of the input dimension.
+     */
+    static long parse(const string* pInput, double* pValues, size_t dim);
+
+    /**
+     * Parse the non-zero values of the given input and their indices, from 0, into the given arrays of up to dim
+     * elements, without touching the other values: for the sparse models, whose cost is in the number of non-zero
+     * values rather than in the input dimension. Each index is expected once. Returns the label.
+     * Throws if the input is malformed or has an index out of the input dimension.
+     */
+    static long parseSparse(const string* pInput, size_t* pIndices, double* pValues, size_t dim, size_t* pNumValues);
+};
+
+#endif // INPUT_PARSER_H_
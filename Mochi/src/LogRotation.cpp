@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "AllocationCounter.hpp"
+#include "Constants.hpp"
+#include "LogRotation.hpp"
+#include "Utils.hpp"
+
+size_t LogRotation::s_maxSegmentSize = 0;
+time_t LogRotation::s_maxSegmentAge = 0;
+size_t LogRotation::s_maxTotalSize = 0;
+bool LogRotation::s_compress = false;
+time_t LogRotation::s_messageLogStart = 0;
+vector<pair<pid_t, string>> LogRotation::s_compressions;
+thread_local size_t LogRotation::s_allocationCount = 0;
+mutex LogRotation::s_mutex;
+mutex LogRotation::s_messageLogMutex;
+
+/**
+ * Set the maximum segment size in bytes and age in seconds, the cap in bytes and whether segments are compressed.
+ */
+void LogRotation::configure(size_t maxSegmentSize, time_t maxSegmentAge, size_t maxTotalSize, bool compress)
+{
+    s_maxSegmentSize = maxSegmentSize;
+    s_maxSegmentAge = maxSegmentAge;
+    s_maxTotalSize = maxTotalSize;
+    s_compress = compress;
+}
+
+/**
+ * Whether a log file of the given size, whose segment was started at the given time, has to be rotated.
+ */
+bool LogRotation::isDue(size_t segmentSize, time_t segmentStart)
+{
+    if(segmentSize == 0)
+    {
+        return false;
+    }
+
+    return (s_maxSegmentSize > 0 && segmentSize >= s_maxSegmentSize)
+        || (s_maxSegmentAge > 0 && time(nullptr) - segmentStart >= s_maxSegmentAge);
+}
+
+/**
+ * Append an error to the application log. logError() is not used because it rotates the application log when it is
+ * due, and the errors are found while rotating, possibly the application log itself.
+ */
+static void logCompressionError(const string& message)
+{
+    ofstream ofs(LOG_FILEPATH_ORBITAI, ios_base::out | ios_base::app);
+    ofs << "[" << getTimestamp() << "][ERROR] Error Code " << ERROR_LOG_COMPRESSION << " - " << message << "\n";
+}
+
+/**
+ * Reap the compression processes that have finished, logging those that failed.
+ */
+void LogRotation::reapCompressions()
+{
+    for(vector<pair<pid_t, string>>::iterator it = s_compressions.begin(); it != s_compressions.end(); )
+    {
+        int status = 0;
+        const pid_t pid = waitpid(it->first, &status, WNOHANG);
+
+        /* Still compressing. */
+        if(pid == 0)
+        {
+            ++it;
+            continue;
+        }
+
+        /* gzip keeps the segment uncompressed when it fails, the cap then deletes it like any other segment. */
+        if(pid > 0 && (!WIFEXITED(status) || WEXITSTATUS(status) != 0))
+        {
+            logCompressionError("Failed to compress the log segment " + it->second + ", gzip "
+                + (WIFEXITED(status) ? "exited with status " + to_string(WEXITSTATUS(status)) : string("was terminated")) + ".");
+        }
+        it = s_compressions.erase(it);
+    }
+}
+
+/**
+ * Rename the given log file into a closed segment, compress it in the background and enforce the cap.
+ */
+void LogRotation::rotate(const char* filePath)
+{
+    const size_t allocationCount = ::getAllocationCount();
+    lock_guard<mutex> lock(s_mutex);
+
+    reapCompressions();
+    if(renameToSegment(filePath))
+    {
+        enforceCap();
+    }
+
+    s_allocationCount += ::getAllocationCount() - allocationCount;
+}
+
+/**
+ * Rename the given log file into a closed segment and compress it in the background.
+ */
+bool LogRotation::renameToSegment(const char* filePath)
+{
+    /* The segment is named after the log file and the time it was closed, e.g. logs/training_20210515T152659.csv. */
+    const string path(filePath);
+    const size_t slash = path.rfind('/');
+    size_t dot = path.rfind('.');
+    if(dot == string::npos || (slash != string::npos && dot < slash))
+    {
+        dot = path.size();
+    }
+
+    char timestamp[32];
+    const time_t now = time(nullptr);
+    strftime(timestamp, sizeof(timestamp), "_%Y%m%dT%H%M%S", localtime(&now));
+
+    /* Rotating twice within a second adds a counter. */
+    string segmentPath = path.substr(0, dot) + timestamp + path.substr(dot);
+    struct stat segmentStat;
+    for(int i = 1; stat(segmentPath.c_str(), &segmentStat) == 0 || stat((segmentPath + ".gz").c_str(), &segmentStat) == 0; ++i)
+    {
+        segmentPath = path.substr(0, dot) + timestamp + "_" + to_string(i) + path.substr(dot);
+    }
+
+    if(rename(filePath, segmentPath.c_str()) != 0)
+    {
+        return false;
+    }
+
+    /* Compress in the background, the logging does not wait for it. Without gzip the segment stays uncompressed. */
+    if(s_compress)
+    {
+        char gzip[] = "gzip";
+        char force[] = "-f";
+        char* argv[] = {gzip, force, &segmentPath[0], nullptr};
+        pid_t pid;
+        const int error = posix_spawnp(&pid, gzip, nullptr, nullptr, argv, environ);
+        if(error == 0)
+        {
+            s_compressions.push_back(pair<pid_t, string>(pid, segmentPath));
+        }
+        else
+        {
+            logCompressionError("Failed to start gzip to compress the log segment " + segmentPath + ": " + strerror(error) + ".");
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Rotate the application log file if it is due, before appending a message to it.
+ */
+void LogRotation::rotateMessageLogIfDue()
+{
+    lock_guard<mutex> lock(s_messageLogMutex);
+
+    const time_t now = time(nullptr);
+    if(s_messageLogStart == 0)
+    {
+        s_messageLogStart = now;
+    }
+
+    struct stat logStat;
+    if(stat(LOG_FILEPATH_ORBITAI, &logStat) == 0 && isDue(logStat.st_size, s_messageLogStart))
+    {
+        rotate(LOG_FILEPATH_ORBITAI);
+        s_messageLogStart = now;
+    }
+}
+
+/**
+ * Delete the oldest segments of the logs directory until its files fit in the cap.
+ */
+void LogRotation::enforceCap()
+{
+    if(s_maxTotalSize == 0)
+    {
+        return;
+    }
+
+    DIR* pDir = opendir(DIR_PATH_LOGS);
+    if(pDir == NULL)
+    {
+        return;
+    }
+
+    /* The segments by last modification time, the log files being written to count towards the cap too. */
+    vector<pair<time_t, string>> segments;
+    size_t totalSize = 0;
+    struct dirent* pEnt;
+    while((pEnt = readdir(pDir)) != NULL)
+    {
+        const string filePath = string(DIR_PATH_LOGS) + "/" + pEnt->d_name;
+        struct stat fileStat;
+        if(stat(filePath.c_str(), &fileStat) != 0 || !S_ISREG(fileStat.st_mode))
+        {
+            continue;
+        }
+
+        /* Segments still being compressed are not deleted, neither the segment nor its .gz file being written. */
+        totalSize += fileStat.st_size;
+        if(isSegment(pEnt->d_name) && !isBeingCompressed(filePath))
+        {
+            segments.push_back(pair<time_t, string>(fileStat.st_mtime, filePath));
+        }
+    }
+    closedir(pDir);
+
+    sort(segments.begin(), segments.end());
+
+    /* Oldest first. */
+    for(vector<pair<time_t, string>>::iterator it = segments.begin(); it != segments.end() && totalSize > s_maxTotalSize; ++it)
+    {
+        struct stat fileStat;
+        if(stat(it->second.c_str(), &fileStat) == 0 && remove(it->second.c_str()) == 0)
+        {
+            totalSize -= min(totalSize, static_cast<size_t>(fileStat.st_size));
+        }
+    }
+}
+
+/**
+ * Whether the given segment, or the .gz file of a segment, is being compressed.
+ */
+bool LogRotation::isBeingCompressed(const string& filePath)
+{
+    for(vector<pair<pid_t, string>>::const_iterator it = s_compressions.begin(); it != s_compressions.end(); ++it)
+    {
+        if(filePath == it->second || filePath == it->second + ".gz")
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Delete all the segments of the logs directory.
+ */
+void LogRotation::removeSegments()
+{
+    lock_guard<mutex> lock(s_mutex);
+    reapCompressions();
+
+    DIR* pDir = opendir(DIR_PATH_LOGS);
+    if(pDir == NULL)
+    {
+        return;
+    }
+
+    struct dirent* pEnt;
+    while((pEnt = readdir(pDir)) != NULL)
+    {
+        if(isSegment(pEnt->d_name))
+        {
+            remove((string(DIR_PATH_LOGS) + "/" + pEnt->d_name).c_str());
+        }
+    }
+    closedir(pDir);
+}
+
+/**
+ * Whether the given file name is the name of a closed segment, compressed or not: it has a "_YYYYmmddTHHMMSS" part.
+ */
+bool LogRotation::isSegment(const string& fileName)
+{
+    for(size_t i = fileName.find('_'); i != string::npos; i = fileName.find('_', i + 1))
+    {
+        if(i + 16 > fileName.size())
+        {
+            return false;
+        }
+
+        bool isTimestamp = fileName[i + 9] == 'T';
+        for(size_t j = i + 1; j < i + 16 && isTimestamp; ++j)
+        {
+            isTimestamp = j == i + 9 || (fileName[j] >= '0' && fileName[j] <= '9');
+        }
+
+        if(isTimestamp)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
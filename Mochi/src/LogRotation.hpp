@@ -0,0 +1,116 @@
+#ifndef LOG_ROTATION_H_
+#define LOG_ROTATION_H_
+
+#include <cstddef>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Rotation of the log files into segments, with a cap on the disk usage of the logs directory.
+ *
+ * A log file that reached the maximum segment size or age is renamed into a closed segment, e.g.
+ * logs/training.csv into logs/training_20210515T152659.csv, and the logging goes on in a new file. Closed segments
+ * are compressed with gzip in a background process. When the files of the logs directory take more than the cap,
+ * the oldest segments are deleted until they fit, the log files being written to are never deleted.
+ *
+ * The settings are global because the application log is written by free functions, see logMessage().
+ * Log files can be rotated by the training thread and the inference thread, rotations are serialized.
+ */
+class LogRotation
+{
+private:
+    /* Rotation settings, 0 disables the rotation by size or by age and the cap. */
+    static size_t s_maxSegmentSize;
+    static time_t s_maxSegmentAge;
+    static size_t s_maxTotalSize;
+    static bool s_compress;
+
+    /* When the application log segment was started by this process. */
+    static time_t s_messageLogStart;
+
+    /* The gzip processes compressing segments in the background and the segments they compress. */
+    static vector<pair<pid_t, string>> s_compressions;
+
+    /* Heap allocations made by the calling thread while rotating, see getAllocationCount(). */
+    static thread_local size_t s_allocationCount;
+
+    /* Serializes the rotations of the training and inference threads, and of their application log messages. */
+    static mutex s_mutex;
+    static mutex s_messageLogMutex;
+
+    /* Hide constructor. */
+    LogRotation() {};
+
+    /**
+     * Reap the compression processes that have finished, logging those that failed.
+     */
+    static void reapCompressions();
+
+    /**
+     * Rename the given log file into a closed segment and compress it in the background.
+     * Returns false if the log file could not be renamed.
+     */
+    static bool renameToSegment(const char* filePath);
+
+    /**
+     * Whether the given segment, or the .gz file of a segment, is being compressed.
+     */
+    static bool isBeingCompressed(const string& filePath);
+
+public:
+
+    /**
+     * Set the maximum segment size in bytes and age in seconds, the cap in bytes and whether segments are compressed.
+     */
+    static void configure(size_t maxSegmentSize, time_t maxSegmentAge, size_t maxTotalSize, bool compress);
+
+    /**
+     * Get the number of heap allocations made by the calling thread while rotating. Rotating is rare and is not on the hot path: these
+     * allocations are not reported as allocations by the server. Only counted when built with ORBITAI_COUNT_ALLOCATIONS.
+     */
+    static size_t getAllocationCount()
+    {
+        return s_allocationCount;
+    }
+
+    /**
+     * Whether a log file of the given size, whose segment was started at the given time, has to be rotated.
+     * Does not allocate heap memory.
+     */
+    static bool isDue(size_t segmentSize, time_t segmentStart);
+
+    /**
+     * Rename the given log file into a closed segment, compress it in the background and enforce the cap.
+     * The log file may still be open, writing to it then goes to the segment until it is reopened.
+     */
+    static void rotate(const char* filePath);
+
+    /**
+     * Rotate the application log file if it is due, before appending a message to it.
+     */
+    static void rotateMessageLogIfDue();
+
+    /**
+     * Delete the oldest segments of the logs directory until its files fit in the cap. The segments still being
+     * compressed are not deleted, the other ones are whether they are compressed or not.
+     */
+    static void enforceCap();
+
+    /**
+     * Delete all the segments of the logs directory.
+     */
+    static void removeSegments();
+
+    /**
+     * Whether the given file name is the name of a closed segment, compressed or not.
+     */
+    static bool isSegment(const string& fileName);
+};
+
+#endif // LOG_ROTATION_H_
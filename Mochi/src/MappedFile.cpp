@@ -0,0 +1,54 @@
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MappedFile.hpp"
+
+/**
+ * Constructor.
+ */
+MappedFile::MappedFile(const string& filePath) :
+    m_pData(nullptr),
+    m_size(0)
+{
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        throw runtime_error("Failed to open file: " + filePath);
+    }
+
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) != 0)
+    {
+        close(fd);
+        throw runtime_error("Failed to read the size of file: " + filePath);
+    }
+
+    /* An empty file cannot be mapped, it is read as no data. */
+    m_size = fileStat.st_size;
+    if(m_size > 0)
+    {
+        m_pData = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(m_pData == MAP_FAILED)
+        {
+            m_pData = nullptr;
+            close(fd);
+            throw runtime_error("Failed to map file: " + filePath);
+        }
+    }
+
+    close(fd);
+}
+
+/**
+ * Destructor.
+ */
+MappedFile::~MappedFile()
+{
+    if(m_pData != nullptr)
+    {
+        munmap(m_pData, m_size);
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+
+using namespace std;
+
+/**
+ * A file mapped read-only in memory, e.g. to read a log file without copying it into heap memory.
+ * The file is unmapped when the object is destroyed.
+ */
+class MappedFile
+{
+private:
+    /* The mapping, null for an empty file. */
+    void* m_pData;
+    size_t m_size;
+
+    /* Hide constructor. */
+    MappedFile() {};
+
+public:
+
+    /* Constructor. */
+    MappedFile(const string& filePath);
+
+    /* Destructor. */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* getData() const
+    {
+        return static_cast<const char*>(m_pData);
+    }
+
+    size_t getSize() const
+    {
+        return m_size;
+    }
+};
+
+#endif // MAPPED_FILE_H_
@@ -1,17 +1,179 @@
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
 #include <map>
+#include <random>
+#include <stdexcept>
 #include <vector>
 #include <string>
 #include <dirent.h>
+#include <sys/stat.h>
 
+#include "BinaryLogReader.hpp"
 #include "HyperParameters.hpp"
+#include "HoeffdingForest.hpp"
+#include "SparseAdagradRda.hpp"
+#include "SparseAdam.hpp"
+#include "LogRotation.hpp"
+#include "MappedFile.hpp"
+#include "ModelSnapshot.hpp"
+#include "QuantizedModel.hpp"
 #include "MochiMochiProxy.hpp"
 
+/**
+ * Convert a row of the training data log, e.g. "1618593464649,1,0.01,0.67", into a training input, e.g. "+1 1:0.01 2:0.67".
+ * Returns the number of input values.
+ */
+static size_t csvRowToInput(const char* pRow, const char* pEnd, string* pInput)
+{
+    pInput->clear();
+
+    /* Skip the timestamp. */
+    const char* pCursor = find(pRow, pEnd, ',');
+    if(pCursor == pEnd)
+    {
+        throw invalid_argument("Training data log row without label.");
+    }
+    ++pCursor;
+
+    /* The label, logged as an integer. */
+    const long label = strtol(pCursor, nullptr, 10);
+    pInput->append(label > 0 ? "+1" : "-1");
+    pCursor = find(pCursor, pEnd, ',');
+
+    /* The input values, indexed from 1. */
+    size_t numValues = 0;
+    while(pCursor != pEnd && *pCursor == ',')
+    {
+        const char* pValue = pCursor + 1;
+        pCursor = find(pValue, pEnd, ',');
+
+        pInput->append(" ");
+        pInput->append(to_string(++numValues));
+        pInput->append(":");
+        pInput->append(pValue, pCursor - pValue);
+    }
+
+    return numValues;
+}
+
+/**
+ * Convert a record of the binary training data log into a training input, e.g. "+1 1:0.01 2:0.67".
+ * Returns the number of input values.
+ */
+static size_t binaryRecordToInput(const BinaryLogReader& binaryLog, size_t recordIndex, string* pInput)
+{
+    pInput->assign(binaryLog.getLabel(recordIndex) > 0 ? "+1" : "-1");
+
+    /* The values are written with enough digits to be parsed back exactly. */
+    char value[40];
+    const size_t numValues = binaryLog.getParamNames().size();
+    for(size_t i = 0; i < numValues; ++i)
+    {
+        const int length = snprintf(value, sizeof(value), " %zu:%.17g", i + 1, binaryLog.getValue(recordIndex, i));
+        pInput->append(value, length);
+    }
+
+    return numValues;
+}
+
+/**
+ * Create the given algorithm with the hyperparameter values set in the properties file, null for an unknown algorithm.
+ */
+BinaryOMLInterface* MochiMochiProxy::createAlgorithm(const string& algorithmName, const vector<string>& hyperParamNames, int dim)
+{
+    if(algorithmName.compare(HyperParameters::ALGORITHM_NAME_ADAGRAD_RDA) == 0)
+    {
+        /* Get hyperparameter values. */
+        const double eta = m_pPropParser->getHyperParameterProperty<double>(algorithmName, hyperParamNames.at(0));
+        const double lambda = m_pPropParser->getHyperParameterProperty<double>(algorithmName, hyperParamNames.at(1));
+
+        /* Instanciate the online ML algorithm class into an object. */
+        return new BinaryADAGRADRDACreator(dim, eta, lambda);
+    }
+    else if(algorithmName.compare(HyperParameters::ALGORITHM_NAME_ADAM) == 0)
+    {
+        /* Instanciate the online ML algorithm class into an object. */
+        return new BinaryADAMCreator(dim);
+    }
+    else if(algorithmName.compare(HyperParameters::ALGORITHM_NAME_AROW) == 0)
+    {
+        /* Get hyperparameter values. */
+        const double r = m_pPropParser->getHyperParameterProperty<double>(algorithmName, hyperParamNames.at(0));
+
+        /* Instanciate the online ML algorithm class into an object. */
+        return new BinaryAROWCreator(dim, r);
+    }
+    else if(algorithmName.compare(HyperParameters::ALGORITHM_NAME_NHERD) == 0)
+    {
+        /* Get hyperparameter values. */
+        const double c = m_pPropParser->getHyperParameterProperty<double>(algorithmName, hyperParamNames.at(0));
+        const int diagonal = m_pPropParser->getHyperParameterProperty<int>(algorithmName, hyperParamNames.at(1));
+
+        /* Instanciate the online ML algorithm class into an object. */
+        return new BinaryNHERDCreator(dim, c, diagonal);
+    }
+    else if(algorithmName.compare(HyperParameters::ALGORITHM_NAME_PA) == 0)
+    {
+        /* Get hyperparameter values. */
+        const int select = m_pPropParser->getHyperParameterProperty<int>(algorithmName, hyperParamNames.at(0));
+        const double c = m_pPropParser->getHyperParameterProperty<double>(algorithmName, hyperParamNames.at(1));
+
+        /* Instanciate the online ML algorithm class into an object. */
+        return new BinaryPACreator(dim, c, select);
+    }
+    else if(algorithmName.compare(HyperParameters::ALGORITHM_NAME_SCW) == 0)
+    {
+        /* Get hyperparameter values. */
+        const double c = m_pPropParser->getHyperParameterProperty<double>(algorithmName, hyperParamNames.at(0));
+        const double eta = m_pPropParser->getHyperParameterProperty<double>(algorithmName, hyperParamNames.at(1));
+
+        /* Instanciate the online ML algorithm class into an object. */
+        return new BinarySCWCreator(dim, c, eta);
+    }
+    else if(algorithmName.compare(HyperParameters::ALGORITHM_NAME_HOEFFDING_FOREST) == 0)
+    {
+        /* Get hyperparameter values. */
+        const size_t trees = m_pPropParser->getHyperParameterProperty<size_t>(algorithmName, hyperParamNames.at(0));
+        const size_t nodes = m_pPropParser->getHyperParameterProperty<size_t>(algorithmName, hyperParamNames.at(1));
+        const size_t grace = m_pPropParser->getHyperParameterProperty<size_t>(algorithmName, hyperParamNames.at(2));
+        const double delta = m_pPropParser->getHyperParameterProperty<double>(algorithmName, hyperParamNames.at(3));
+        const double tau = m_pPropParser->getHyperParameterProperty<double>(algorithmName, hyperParamNames.at(4));
+        const unsigned int seed = m_pPropParser->getHyperParameterProperty<unsigned int>(algorithmName, hyperParamNames.at(5));
+
+        /* Instanciate OrbitAI's online random forest, it implements the same interface as the MochiMochi algorithms. */
+        return new HoeffdingForest(dim, trees, nodes, grace, delta, tau, seed);
+    }
+    else if(algorithmName.compare(HyperParameters::ALGORITHM_NAME_SPARSE_ADAGRAD_RDA) == 0)
+    {
+        /* Get hyperparameter values. */
+        const double eta = m_pPropParser->getHyperParameterProperty<double>(algorithmName, hyperParamNames.at(0));
+        const double lambda = m_pPropParser->getHyperParameterProperty<double>(algorithmName, hyperParamNames.at(1));
+
+        /* Instanciate OrbitAI's sparse ADAGRAD_RDA, for high-dimensional sparse inputs. */
+        return new SparseAdagradRda(dim, eta, lambda);
+    }
+    else if(algorithmName.compare(HyperParameters::ALGORITHM_NAME_SPARSE_ADAM) == 0)
+    {
+        /* Instanciate OrbitAI's sparse ADAM, for high-dimensional sparse inputs. */
+        return new SparseAdam(dim);
+    }
+
+    return nullptr;
+}
+
 /**
  * Create the enabled algorithms via the Factory Pattern implemented in the MochiMochi library.
  */
 void MochiMochiProxy::initAlgorithms(int dim, map<string, vector<string>>* pHpMap)
 {
+    /* Kept to create the algorithms again, e.g. to replace a model that drifted. */
+    m_dim = dim;
+    m_hpMap = *pHpMap;
+
     for(map<string, vector<string>>::iterator it=pHpMap->begin(); it!=pHpMap->end(); ++it)
     {
         /* The name of the online ML algorithm. */
@@ -19,59 +181,398 @@ void MochiMochiProxy::initAlgorithms(int dim, map<string, vector<string>>* pHpMa
 
         /* Check if the properties file indicates that this algorithm should be used. */
         int enable = m_pPropParser->getProperty<int>(algorithmName);
-        if(enable == 1)
+        if(enable != 1)
         {
-            if(algorithmName.compare(HyperParameters::ALGORITHM_NAME_ADAGRAD_RDA) == 0)
-            {
-                /* Get hyperparameter values. */
-                const double eta = m_pPropParser->getHyperParameterProperty<double>(algorithmName, it->second.at(0));
-                const double lambda = m_pPropParser->getHyperParameterProperty<double>(algorithmName, it->second.at(1));
+            continue;
+        }
 
-                /* Instanciate the online ML algorithm class into an object and put it in the algorithm vector. */ 
-                m_bomlCreatorVector.push_back(pair<string, BinaryOMLCreator*>(algorithmName, new BinaryADAGRADRDACreator(dim, eta, lambda)));
+        /* Without feature groups there is a single model per algorithm, trained on all the input params. */
+        const size_t numGroups = m_featureGroups.isEnabled() ? m_featureGroups.getNumGroups() : 1;
+        for(size_t group = 0; group < numGroups; ++group)
+        {
+            /* Instanciate the online ML algorithm and put it in the algorithm vector. */
+            BinaryOMLInterface* pAlgorithm = createAlgorithm(algorithmName, it->second,
+                m_featureGroups.isEnabled() ? m_featureGroups.getDim(group) : dim);
+            if(pAlgorithm != nullptr)
+            {
+                const string modelName = m_featureGroups.isEnabled() ? pAlgorithm->name() + "_" + m_featureGroups.getName(group) : pAlgorithm->name();
+                m_bomlCreatorVector.push_back(pair<string, BinaryOMLInterface*>(modelName, pAlgorithm));
+                m_modelAlgorithmNames.push_back(algorithmName);
+                m_modelGroups.push_back(group);
+                m_inTreeModels.push_back(algorithmName.compare(HyperParameters::ALGORITHM_NAME_HOEFFDING_FOREST) == 0
+                    || algorithmName.compare(HyperParameters::ALGORITHM_NAME_SPARSE_ADAGRAD_RDA) == 0
+                    || algorithmName.compare(HyperParameters::ALGORITHM_NAME_SPARSE_ADAM) == 0);
             }
-            else if(algorithmName.compare(HyperParameters::ALGORITHM_NAME_ADAM) == 0)
+        }
+    }
+
+    /* One prediction per model, the vector is reused by every inference. */
+    for(vector<pair<string, BinaryOMLInterface*>>::iterator it=m_bomlCreatorVector.begin(); it!=m_bomlCreatorVector.end(); ++it)
+    {
+        m_inferences.push_back(pair<string, int>(it->first, 0));
+    }
+    m_metrics.reset(m_bomlCreatorVector.size());
+    m_predictionCache.init(m_bomlCreatorVector.size());
+    m_publishedPredictionCache.init(m_bomlCreatorVector.size());
+
+    /* One drift detector per algorithm, the shadow models are only created on drift warnings. */
+    m_driftDetectors.assign(m_bomlCreatorVector.size(), DriftDetector(m_driftMinNumSamples));
+    m_shadowModels.assign(m_bomlCreatorVector.size(), nullptr);
+}
+
+/**
+ * Feed the prediction errors of the latest inferences to the drift detectors and act on the drifts.
+ */
+void MochiMochiProxy::detectDrift(int label)
+{
+    for(size_t i = 0; i < m_bomlCreatorVector.size(); ++i)
+    {
+        const DriftLevel level = m_driftDetectors[i].update((m_inferences[i].second > 0 ? 1 : -1) != label);
+        if(level == DriftLevel::stable && m_shadowModels[i] == nullptr)
+        {
+            continue;
+        }
+
+        /* Creating and replacing models allocates, it is counted with the allocations of the algorithms. */
+        const size_t allocationCount = getAllocationCount();
+        const string& algorithmName = m_modelAlgorithmNames[i];
+        const string& modelName = m_bomlCreatorVector[i].first;
+
+        if(level == DriftLevel::warning)
+        {
+            /* The shadow model learns the samples from the warning on, i.e. the concept the model may be drifting to. */
+            if(m_driftAction == DriftAction::shadow && m_shadowModels[i] == nullptr)
             {
-                /* Instanciate the online ML algorithm class into an object and put it in the algorithm vector. */ 
-                m_bomlCreatorVector.push_back(pair<string, BinaryOMLCreator*>(algorithmName, new BinaryADAMCreator(dim)));
+                m_shadowModels[i] = createAlgorithm(algorithmName, m_hpMap.at(algorithmName), getModelDim(i, m_dim));
             }
-            else if(algorithmName.compare(HyperParameters::ALGORITHM_NAME_AROW) == 0)
+        }
+        else if(level == DriftLevel::stable)
+        {
+            /* False alarm, the error rate went back down. */
+            delete m_shadowModels[i];
+            m_shadowModels[i] = nullptr;
+        }
+        else
+        {
+            if(m_driftAction == DriftAction::reset || m_driftAction == DriftAction::shadow)
             {
-                /* Get hyperparameter values. */
-                const double r = m_pPropParser->getHyperParameterProperty<double>(algorithmName, it->second.at(0));
+                /* Without a warning before the drift there is no shadow model to replace the model with. */
+                const bool hasShadowModel = m_shadowModels[i] != nullptr;
+                BinaryOMLInterface* pModel = m_shadowModels[i];
+                if(!hasShadowModel)
+                {
+                    pModel = createAlgorithm(algorithmName, m_hpMap.at(algorithmName), getModelDim(i, m_dim));
+                }
+
+                delete m_bomlCreatorVector[i].second;
+                m_bomlCreatorVector[i].second = pModel;
+                m_shadowModels[i] = nullptr;
 
-                /* Instanciate the online ML algorithm class into an object and put it in the algorithm vector. */ 
-                m_bomlCreatorVector.push_back(pair<string, BinaryOMLCreator*>(algorithmName, new BinaryAROWCreator(dim, r)));
+                logInfo("Drift detected, replaced model " + modelName
+                    + (hasShadowModel ? " by its shadow model" : " by a new model"));
             }
-            else if(algorithmName.compare(HyperParameters::ALGORITHM_NAME_NHERD) == 0)
+            else
             {
-                /* Get hyperparameter values. */
-                const double c = m_pPropParser->getHyperParameterProperty<double>(algorithmName, it->second.at(0));
-                const int diagonal = m_pPropParser->getHyperParameterProperty<int>(algorithmName, it->second.at(1));
+                logInfo("Drift detected for model " + modelName);
+            }
+        }
 
-                /* Instanciate the online ML algorithm class into an object and put it in the algorithm vector. */ 
-                m_bomlCreatorVector.push_back(pair<string, BinaryOMLCreator*>(algorithmName, new BinaryNHERDCreator(dim, c, diagonal)));
+        m_modelAllocationCount += getAllocationCount() - allocationCount;
+    }
+}
+
+/**
+ * Log the prequential metrics of every model.
+ */
+void MochiMochiProxy::logMetrics()
+{
+    if(m_prequentialEnabled != 1)
+    {
+        throw runtime_error("Prequential evaluation is not enabled in the properties file.");
+    }
+
+    for(size_t i = 0; i < m_inferences.size(); ++i)
+    {
+        const PrequentialMetrics::ConfusionMatrix& matrix = m_metrics.getConfusionMatrix(i);
+        logInfo("Prequential metrics of " + m_inferences[i].first + " over " + to_string(m_metrics.getNumSamples()) + " samples: "
+            + "balanced accuracy " + to_string(m_metrics.getBalancedAccuracy(i)) + ", F1 score " + to_string(m_metrics.getF1Score(i))
+            + " (TP " + to_string(matrix.truePositives) + ", FP " + to_string(matrix.falsePositives)
+            + ", TN " + to_string(matrix.trueNegatives) + ", FN " + to_string(matrix.falseNegatives) + ")");
+    }
+
+    /* Also add a row to the metrics log. */
+    m_metricsLogger.logMetrics(&m_inferences, &m_metrics);
+}
+
+/**
+ * Train the models for the given number of epochs over the given rows of a training data log.
+ * The rows are converted into training inputs by the given function, which returns their number of input values,
+ * and the models are trained on the training inputs by the other given function.
+ */
+template<typename RowToInput, typename TrainInput>
+static void replayEpochs(vector<uint32_t>* pRows, size_t dim, size_t numEpochs, bool shuffle, unsigned int seed,
+    RowToInput rowToInput, TrainInput trainInput)
+{
+    /* The training input, reused for every row. */
+    string input;
+    input.reserve(COMMAND_BUFFER_LENGTH);
+
+    mt19937 rng(seed);
+
+    for(size_t epoch = 0; epoch < numEpochs; ++epoch)
+    {
+        if(shuffle)
+        {
+            std::shuffle(pRows->begin(), pRows->end(), rng);
+        }
+
+        for(vector<uint32_t>::const_iterator it = pRows->begin(); it != pRows->end(); ++it)
+        {
+            if(rowToInput(*it, &input) != dim)
+            {
+                throw invalid_argument("Training data log row with a number of inputs other than the input dimension: " + input);
             }
-            else if(algorithmName.compare(HyperParameters::ALGORITHM_NAME_PA) == 0)
+
+            trainInput(&input);
+        }
+    }
+}
+
+/**
+ * Train the models for the given number of epochs over the training data logged in the given CSV or binary file and save them once at the end.
+ */
+void MochiMochiProxy::trainEpochs(const char* trainingLogFilePath, size_t dim, size_t numEpochs, bool shuffle, unsigned int seed, const string modelDirPath)
+{
+    MappedFile trainingLog(trainingLogFilePath);
+    const char* pData = trainingLog.getData();
+    const char* pEnd = pData + trainingLog.getSize();
+
+    if(trainingLog.getSize() > numeric_limits<uint32_t>::max())
+    {
+        throw runtime_error(string("Training data log too large to replay: ") + trainingLogFilePath);
+    }
+
+    /* The rows of the log: the offset of every CSV row or the index of every binary record. */
+    vector<uint32_t> rows;
+
+    /* Train every model on a replayed training input, or on its feature group input. */
+    auto trainInput = [&](string* pInput)
+    {
+        projectInput(pInput);
+        for(size_t i = 0; i < m_bomlCreatorVector.size(); ++i)
+        {
+            m_bomlCreatorVector[i].second->train(getModelInput(i, pInput), getModelDim(i, dim));
+        }
+    };
+
+    if(BinaryLogReader::isBinaryLog(pData, trainingLog.getSize()))
+    {
+        /* The records are read in place, their values are only formatted into the training input. */
+        BinaryLogReader binaryLog(trainingLogFilePath);
+        for(size_t i = 0; i < binaryLog.getNumRecords(); ++i)
+        {
+            rows.push_back(static_cast<uint32_t>(i));
+        }
+
+        replayEpochs(&rows, dim, numEpochs, shuffle, seed, [&](uint32_t row, string* pInput)
+        {
+            return binaryRecordToInput(binaryLog, row, pInput);
+        }, trainInput);
+    }
+    else
+    {
+        /* Compact index of the rows: the offset of every row except the header row. Empty lines are skipped. */
+        const char* pRow = find(pData, pEnd, '\n');
+        while(pRow != pEnd)
+        {
+            ++pRow;
+            if(pRow != pEnd && *pRow != '\n')
             {
-                /* Get hyperparameter values. */
-                const int select = m_pPropParser->getHyperParameterProperty<int>(algorithmName, it->second.at(0));
-                const double c = m_pPropParser->getHyperParameterProperty<double>(algorithmName, it->second.at(1));
+                rows.push_back(static_cast<uint32_t>(pRow - pData));
+            }
+            pRow = find(pRow, pEnd, '\n');
+        }
+
+        replayEpochs(&rows, dim, numEpochs, shuffle, seed, [&](uint32_t row, string* pInput)
+        {
+            const char* pRowStart = pData + row;
+            return csvRowToInput(pRowStart, find(pRowStart, pEnd, '\n'), pInput);
+        }, trainInput);
+    }
+
+    /* Checkpoint the models once, rather than after every sample. */
+    m_modelVersion++;
+    save(modelDirPath);
+
+    logInfo("Trained " + to_string(numEpochs) + " epochs over the " + to_string(rows.size()) + " samples of " + trainingLogFilePath
+        + (shuffle ? " shuffled with seed " + to_string(seed) : string("")));
+}
+
+/**
+ * Publish a copy of the saved models for inference.
+ */
+void MochiMochiProxy::publishModels(const string modelDirPath)
+{
+    /* Publishing is not on the hot path of the training thread: creating and loading the copy allocates. */
+    const size_t allocationCount = getAllocationCount();
+
+    const vector<string>& modelFilePaths = getModelFilePaths(modelDirPath);
+    PublishedModels* pModels = new PublishedModels(++m_numPublications);
+
+    for(size_t i = 0; i < m_bomlCreatorVector.size(); ++i)
+    {
+        const string& algorithmName = m_modelAlgorithmNames[i];
+        BinaryOMLInterface* pModel = createAlgorithm(algorithmName, m_hpMap.at(algorithmName), getModelDim(i, m_dim));
+        if(exists(modelFilePaths[i]) == 1)
+        {
+            pModel->load(modelFilePaths[i]);
+        }
+        pModels->models.push_back(pair<string, BinaryOMLInterface*>(m_bomlCreatorVector[i].first, pModel));
+    }
+
+    /* The inference thread switches to the new copy with its next inference. */
+    m_modelPublisher.publish(pModels);
+    m_numUnpublishedSamples = 0;
+
+    m_modelAllocationCount += getAllocationCount() - allocationCount;
+}
+
+/**
+ * Infer/predict the label with the given input using the latest published copy of the models.
+ */
+void MochiMochiProxy::inferPublished(string* pInput, size_t dim)
+{
+    /* Released when leaving the scope, also when a model throws on a malformed input. */
+    PublishedModelsReader reader(m_modelPublisher);
+    const PublishedModels* pModels = reader.get();
+    if(pModels == nullptr)
+    {
+        throw runtime_error("No models published for inference yet.");
+    }
+
+    /* Sized by the first inference, the published copies all have the same models. */
+    if(m_publishedInferences.size() != pModels->models.size())
+    {
+        m_publishedInferences.clear();
+        for(vector<pair<string, BinaryOMLInterface*>>::const_iterator it = pModels->models.begin(); it != pModels->models.end(); ++it)
+        {
+            m_publishedInferences.push_back(pair<string, int>(it->first, 0));
+        }
+    }
+
+    /* A repeated input takes the predictions cached for the same published copy, without scoring its models. */
+    if(!m_publishedPredictionCache.lookup(pInput, pModels->version, &m_publishedInferences))
+    {
+        /* The inference thread projects the input into its own feature group inputs, the models are in the same order as the trained models. */
+        if(m_publishedFeatureGroups.isEnabled())
+        {
+            m_publishedFeatureGroups.project(pInput);
+        }
 
-                /* Instanciate the online ML algorithm class into an object and put it in the algorithm vector. */ 
-                m_bomlCreatorVector.push_back(pair<string, BinaryOMLCreator*>(algorithmName, new BinaryPACreator(dim, c, select)));
+        for(size_t i = 0; i < pModels->models.size(); ++i)
+        {
+            const size_t allocationCount = getAllocationCount();
+            if(m_publishedFeatureGroups.isEnabled())
+            {
+                const size_t group = m_modelGroups[i];
+                m_publishedInferences[i].second = pModels->models[i].second->infer(m_publishedFeatureGroups.getInput(group), m_publishedFeatureGroups.getDim(group));
             }
-            else if(algorithmName.compare(HyperParameters::ALGORITHM_NAME_SCW) == 0)
+            else
             {
-                /* Get hyperparameter values. */
-                const double c = m_pPropParser->getHyperParameterProperty<double>(algorithmName, it->second.at(0));
-                const double eta = m_pPropParser->getHyperParameterProperty<double>(algorithmName, it->second.at(1));
-
-                /* Instanciate the online ML algorithm class into an object and put it in the algorithm vector. */ 
-                m_bomlCreatorVector.push_back(pair<string, BinaryOMLCreator*>(algorithmName, new BinarySCWCreator(dim, c, eta)));
+                m_publishedInferences[i].second = pModels->models[i].second->infer(pInput, dim);
             }
+            countModelAllocations(i, allocationCount, &m_publishedModelAllocationCount);
+        }
+
+        m_publishedPredictionCache.store(pModels->version, m_publishedInferences);
+    }
+
+    /* Log the inference results, only the inference thread writes the inference log. */
+    if(m_binaryLogEnabled)
+    {
+        m_binaryInferenceLogger.logInferenceResult(m_pPropParser->getInputParamNames(), pInput, &m_publishedInferences);
+    }
+    else
+    {
+        m_inferenceLogger.logInferenceResult(m_pPropParser->getInputParamNames(), pInput, &m_publishedInferences);
+    }
+}
+
+/**
+ * Export a compact snapshot of the saved models for downlink.
+ */
+void MochiMochiProxy::exportSnapshot(const string modelDirPath, const string snapshotDirPath, bool full)
+{
+    const vector<string>& modelFilePaths = getModelFilePaths(modelDirPath);
+
+    vector<pair<string, string>> models;
+    for(size_t i = 0; i < m_bomlCreatorVector.size(); ++i)
+    {
+        if(exists(modelFilePaths[i]) == 1)
+        {
+            models.push_back(pair<string, string>(m_bomlCreatorVector[i].first, modelFilePaths[i]));
         }
     }
+
+    const bool quantize = m_pPropParser->isExportQuantizeEnabled() == 1;
+    string snapshotFilePath = ModelSnapshot::exportSnapshot(models, snapshotDirPath, full, quantize);
+
+    /**
+     * The next snapshots are deltas of this one, so a delta that did not make it to the snapshot directory would leave
+     * the ground unable to reconstruct them: export a full snapshot instead, which the next deltas are based on.
+     */
+    struct stat snapshotStat;
+    if(stat(snapshotFilePath.c_str(), &snapshotStat) != 0 && !full)
+    {
+        logError("Exported snapshot not found, exporting a full snapshot instead: " + snapshotFilePath);
+        snapshotFilePath = ModelSnapshot::exportSnapshot(models, snapshotDirPath, true, quantize);
+    }
+    if(stat(snapshotFilePath.c_str(), &snapshotStat) != 0)
+    {
+        throw runtime_error("Failed to export the snapshot: " + snapshotFilePath);
+    }
+    logInfo("Exported snapshot of " + to_string(models.size()) + " models: " + snapshotFilePath + " (" + to_string(snapshotStat.st_size) + " bytes)");
+}
+
+/**
+ * Replace the saved linear models by quantized copies for inference, if set in the properties file.
+ */
+void MochiMochiProxy::quantizeModels(const string modelDirPath)
+{
+    const int bits = m_pPropParser->getInferenceQuantizeBits();
+    if(bits == 0)
+    {
+        return;
+    }
+    m_modelVersion++;
+
+    const vector<string>& modelFilePaths = getModelFilePaths(modelDirPath);
+    for(size_t i = 0; i < m_bomlCreatorVector.size(); ++i)
+    {
+        if(!QuantizedModel::isQuantizable(m_modelAlgorithmNames[i]) || exists(modelFilePaths[i]) == 0)
+        {
+            continue;
+        }
+
+        QuantizedModel* pModel = new QuantizedModel(m_bomlCreatorVector[i].first, m_modelAlgorithmNames[i],
+            getModelDim(i, m_dim), bits, m_pPropParser->getInferenceQuantizeRange());
+        try
+        {
+            pModel->load(modelFilePaths[i]);
+        }
+        catch(...)
+        {
+            delete pModel;
+            throw;
+        }
+
+        /* Only the quantized weights are kept in memory. */
+        delete m_bomlCreatorVector[i].second;
+        m_bomlCreatorVector[i].second = pModel;
+        m_inTreeModels[i] = true;
+
+        logInfo("Quantized model " + m_bomlCreatorVector[i].first + " to int" + to_string(bits) + " with weight scale " + to_string(pModel->getWeightScale()));
+    }
 }
 
 /**
@@ -97,8 +598,41 @@ void MochiMochiProxy::reset()
         }
     }
 
-    /* Delete all log files. */
+    /**
+     * The replay buffer file was deleted with the model files, the next save creates it again. The samples held in
+     * memory are dropped too, otherwise the next save would write them back and the new models would rehearse them.
+     */
+    m_replayBuffer.close();
+    m_replayBuffer.clear();
+
+    /* Delete all log files, closing the open ones first. */
+    m_trainingLogger.close();
+    m_metricsLogger.close();
+    m_binaryTrainingLogger.close();
     remove(LOG_FILEPATH_TRAINING);
-    remove(LOG_FILEPATH_INFERENCE);
+    remove(LOG_FILEPATH_TRAINING_BINARY);
+    remove(LOG_FILEPATH_METRICS);
+
+    /* While models are published, the inference log is written by the inference thread and is kept. */
+    if(m_numPublications == 0)
+    {
+        m_inferenceLogger.close();
+        m_binaryInferenceLogger.close();
+        remove(LOG_FILEPATH_INFERENCE);
+        remove(LOG_FILEPATH_INFERENCE_BINARY);
+    }
     remove(LOG_FILEPATH_ORBITAI);
+    LogRotation::removeSegments();
+
+    /* The cached predictions are dropped with the model files. */
+    m_modelVersion++;
+
+    /* The metrics and the drift detection start over with the logs. */
+    m_metrics.reset(m_bomlCreatorVector.size());
+    for(size_t i = 0; i < m_driftDetectors.size(); ++i)
+    {
+        m_driftDetectors[i].reset();
+        delete m_shadowModels[i];
+        m_shadowModels[i] = nullptr;
+    }
 }
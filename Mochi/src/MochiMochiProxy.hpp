@@ -1,15 +1,26 @@
 #ifndef MOCHI_MOCHI_PROXY_H_
 #define MOCHI_MOCHI_PROXY_H_
 
+#include <cstdlib>
+#include <map>
 #include <vector>
 #include <string>
 
 /* The Binary Machine Learning Algorithm Factory. */
 #include <mochimochi/classifier/factory/binary_oml_factory.hpp>
 
+#include "AllocationCounter.hpp"
 #include "Constants.hpp"
 #include "Utils.hpp"
+#include "BinaryLogger.hpp"
+#include "CsvLogger.hpp"
+#include "DriftDetector.hpp"
+#include "FeatureGroups.hpp"
+#include "ModelPublisher.hpp"
+#include "PredictionCache.hpp"
+#include "PrequentialMetrics.hpp"
 #include "PropertiesParser.hpp"
+#include "ReplayBuffer.hpp"
 
 using namespace std;
 
@@ -20,19 +31,274 @@ using namespace std;
 class MochiMochiProxy : public BinaryOMLInterface
 {
 private:
-    /* Vector pointer for the Binary ML algorithms creator classes. */
-    vector<pair<string, BinaryOMLCreator*>> m_bomlCreatorVector;
+    /**
+     * Vector pointer for the Binary ML algorithms creator classes and OrbitAI's own online learners, with their model names.
+     * With feature groups, every enabled algorithm has a model per group, named after the algorithm and the group, e.g. ADAM_1D.
+     */
+    vector<pair<string, BinaryOMLInterface*>> m_bomlCreatorVector;
     PropertiesParser* m_pPropParser;
 
+    /* The feature groups the models are trained on, and the algorithm name and the feature group of every model. */
+    FeatureGroups m_featureGroups;
+    vector<string> m_modelAlgorithmNames;
+    vector<size_t> m_modelGroups;
+
+    /* Whether each model is one of OrbitAI's own algorithms rather than a MochiMochi algorithm. */
+    vector<bool> m_inTreeModels;
+
+    /* The input dimension and the hyperparameter names of the algorithms, to create an algorithm again. */
+    int m_dim;
+    map<string, vector<string>> m_hpMap;
+
+    /* Whether the training data is logged, read once from the properties. */
+    int m_trainingDataLogEnabled;
+
+    /* The training data and inference results logs, as CSV or as binary logs, read once from the properties. */
+    bool m_binaryLogEnabled;
+    CsvLogger m_trainingLogger;
+    CsvLogger m_inferenceLogger;
+    BinaryLogger m_binaryTrainingLogger;
+    BinaryLogger m_binaryInferenceLogger;
+
+    /* Prequential evaluation of the models on the training samples, read once from the properties, and its periodic log. */
+    int m_prequentialEnabled;
+    size_t m_metricsLogInterval;
+    PrequentialMetrics m_metrics;
+    CsvLogger m_metricsLogger;
+
+    /* Drift detection on the prediction errors of each model, and the shadow models trained from a drift warning on. */
+    DriftAction m_driftAction;
+    size_t m_driftMinNumSamples;
+    vector<DriftDetector> m_driftDetectors;
+    vector<BinaryOMLInterface*> m_shadowModels;
+
+    /* The algorithm names and their latest predictions, reused by every inference. */
+    vector<pair<string, int>> m_inferences;
+
+    /* Version of the models, bumped by every training update or load, and the predictions cached for the inference inputs. */
+    uint64_t m_modelVersion;
+    PredictionCache m_predictionCache;
+
+    /* The model file paths of the algorithms in m_modelDirPath, built once rather than for every sample. */
+    string m_modelDirPath;
+    vector<string> m_modelFilePaths;
+    string m_replayBufferFilePath;
+
+    /* Class-balanced buffer of past training samples and the input its rehearsal samples are drawn into. */
+    ReplayBuffer m_replayBuffer;
+    string m_rehearsalInput;
+
+    /* Heap allocations made by the algorithms themselves, see getModelAllocationCount(), and by saving the in-tree models. */
+    size_t m_modelAllocationCount;
+    size_t m_modelSaveAllocationCount;
+
+    /* Copies of the models published for inference while training, every m_publicationInterval training samples. */
+    ModelPublisher m_modelPublisher;
+    size_t m_publicationInterval;
+    size_t m_numUnpublishedSamples;
+    size_t m_numPublications;
+
+    /* Only accessed by the inference thread: its own feature group inputs, the predictions of the published models and the allocations they made. */
+    FeatureGroups m_publishedFeatureGroups;
+    vector<pair<string, int>> m_publishedInferences;
+    size_t m_publishedModelAllocationCount;
+    PredictionCache m_publishedPredictionCache;
+
     /* Hide constructor. */
-    MochiMochiProxy() {};
+    MochiMochiProxy() : m_trainingLogger(LOG_FILEPATH_TRAINING), m_inferenceLogger(LOG_FILEPATH_INFERENCE),
+        m_binaryTrainingLogger(LOG_FILEPATH_TRAINING_BINARY), m_binaryInferenceLogger(LOG_FILEPATH_INFERENCE_BINARY), m_metrics(1), m_metricsLogger(LOG_FILEPATH_METRICS),
+        m_predictionCache(0, 0, 0), m_replayBuffer(0, 0, 0, 0), m_publishedPredictionCache(0, 0, 0) {};
+
+    /**
+     * Create the given algorithm with the hyperparameter values set in the properties file, null for an unknown algorithm.
+     */
+    BinaryOMLInterface* createAlgorithm(const string& algorithmName, const vector<string>& hyperParamNames, int dim);
+
+    /**
+     * Parse the given input into the inputs of the feature groups, if any. Called once per sample, before the models use it.
+     */
+    void projectInput(const string* pInput)
+    {
+        if(m_featureGroups.isEnabled())
+        {
+            m_featureGroups.project(pInput);
+        }
+    }
+
+    /**
+     * The input of the given model: the input of its feature group projected from the given input, or the given input without feature groups.
+     */
+    string* getModelInput(size_t model, string* pInput)
+    {
+        return m_featureGroups.isEnabled() ? m_featureGroups.getInput(m_modelGroups[model]) : pInput;
+    }
+
+    /**
+     * The input dimension of the given model: the dimension of its feature group, or the given dimension without feature groups.
+     */
+    size_t getModelDim(size_t model, size_t dim)
+    {
+        return m_featureGroups.isEnabled() ? m_featureGroups.getDim(m_modelGroups[model]) : dim;
+    }
+
+    /**
+     * Log the training data in the CSV or the binary training data log.
+     */
+    void logTrainingData(const string* pInput)
+    {
+        if(m_binaryLogEnabled)
+        {
+            m_binaryTrainingLogger.logTrainingData(m_pPropParser->getInputParamNames(), pInput);
+        }
+        else
+        {
+            m_trainingLogger.logTrainingData(m_pPropParser->getInputParamNames(), pInput);
+        }
+    }
+
+    /**
+     * Feed the prediction errors of the latest inferences to the drift detectors and act on the drifts:
+     * log them, replace the model that drifted by a new one, or by its shadow model trained from the drift warning on.
+     */
+    void detectDrift(int label);
+
+    /**
+     * Count the heap allocations made by the given model since the given count, while training or inferring, as made by
+     * the algorithms. Only the MochiMochi algorithms are exempted: the allocations of the in-tree models are left to
+     * the server's, so that the hot path check requires them not to allocate either.
+     */
+    void countModelAllocations(size_t model, size_t allocationCount, size_t* pModelAllocationCount) const
+    {
+        if(!m_inTreeModels[model])
+        {
+            *pModelAllocationCount += getAllocationCount() - allocationCount;
+        }
+    }
+
+    /**
+     * Train the shadow models, if any, with the given training input.
+     */
+    void trainShadowModels(string* pInput, size_t dim)
+    {
+        for(size_t i = 0; i < m_shadowModels.size(); ++i)
+        {
+            if(m_shadowModels[i] != nullptr)
+            {
+                const size_t allocationCount = getAllocationCount();
+                m_shadowModels[i]->train(getModelInput(i, pInput), getModelDim(i, dim));
+                countModelAllocations(i, allocationCount, &m_modelAllocationCount);
+            }
+        }
+    }
+
+    /**
+     * The model file paths of the algorithms in the given directory.
+     */
+    const vector<string>& getModelFilePaths(const string& modelDirPath)
+    {
+        if(m_modelFilePaths.size() != m_bomlCreatorVector.size() || m_modelDirPath != modelDirPath)
+        {
+            m_modelDirPath = modelDirPath;
+            m_replayBufferFilePath = modelDirPath + "/" + REPLAY_BUFFER_FILENAME;
+            m_modelFilePaths.clear();
+            for(vector<pair<string, BinaryOMLInterface*>>::iterator it=m_bomlCreatorVector.begin(); it!=m_bomlCreatorVector.end(); ++it)
+            {
+                m_modelFilePaths.push_back(modelDirPath + "/" + it->first);
+            }
+        }
+
+        return m_modelFilePaths;
+    }
+
+    /**
+     * Test-then-train: predict the given training input with every algorithm before they are trained on it, update the prequential metrics
+     * and detect drifts. The metrics are logged after the first sample and then every m_metricsLogInterval samples.
+     */
+    void evaluate(string* pInput, size_t dim)
+    {
+        for(size_t i = 0; i < m_bomlCreatorVector.size(); ++i)
+        {
+            const size_t allocationCount = getAllocationCount();
+            m_inferences[i].second = m_bomlCreatorVector[i].second->infer(getModelInput(i, pInput), getModelDim(i, dim));
+            countModelAllocations(i, allocationCount, &m_modelAllocationCount);
+        }
+
+        /* The label is the first element of the input. */
+        const int label = strtol(pInput->c_str(), nullptr, 10) > 0 ? 1 : -1;
+
+        if(m_prequentialEnabled == 1)
+        {
+            m_metrics.update(label, &m_inferences);
+
+            /* The first sample also logs a row, so that the metrics log is opened by the first command like the other logs. */
+            if(m_metricsLogInterval > 0 && (m_metrics.getNumSamples() == 1 || m_metrics.getNumSamples() % m_metricsLogInterval == 0))
+            {
+                m_metricsLogger.logMetrics(&m_inferences, &m_metrics);
+            }
+        }
+
+        if(m_driftAction != DriftAction::none)
+        {
+            detectDrift(label);
+        }
+    }
+
+    /**
+     * Train the algorithms on samples of the minority class drawn from the replay buffer, as many as the rehearsals set in the properties.
+     * Rehearsal samples are not logged. The feature group inputs are projected from the given training input again afterwards.
+     */
+    void rehearse(string* pInput, size_t dim)
+    {
+        size_t numRehearsals = 0;
+        for(; numRehearsals < m_replayBuffer.getNumRehearsals() && m_replayBuffer.drawMinority(&m_rehearsalInput); ++numRehearsals)
+        {
+            projectInput(&m_rehearsalInput);
+            for(size_t i = 0; i < m_bomlCreatorVector.size(); ++i)
+            {
+                const size_t allocationCount = getAllocationCount();
+                m_bomlCreatorVector[i].second->train(getModelInput(i, &m_rehearsalInput), getModelDim(i, dim));
+                countModelAllocations(i, allocationCount, &m_modelAllocationCount);
+            }
+        }
+
+        if(numRehearsals > 0)
+        {
+            projectInput(pInput);
+        }
+    }
  
 public:
     
     /* Constructor. */
-    MochiMochiProxy(PropertiesParser* pPropParser)
+    MochiMochiProxy(PropertiesParser* pPropParser) :
+        m_featureGroups(*pPropParser->getInputParamNames(), pPropParser->getFeatureGroups()),
+        m_dim(0),
+        m_binaryLogEnabled(pPropParser->getLogFormat() == LOG_FORMAT_BINARY),
+        m_trainingLogger(LOG_FILEPATH_TRAINING),
+        m_inferenceLogger(LOG_FILEPATH_INFERENCE),
+        m_binaryTrainingLogger(LOG_FILEPATH_TRAINING_BINARY),
+        m_binaryInferenceLogger(LOG_FILEPATH_INFERENCE_BINARY),
+        m_prequentialEnabled(pPropParser->isPrequentialEvaluationEnabled()),
+        m_metricsLogInterval(pPropParser->getMetricsLogInterval()),
+        m_metrics(pPropParser->getMetricsFadingFactor()),
+        m_metricsLogger(LOG_FILEPATH_METRICS),
+        m_driftAction(DriftDetector::parseAction(pPropParser->getDriftAction())),
+        m_driftMinNumSamples(pPropParser->getDriftMinNumSamples()),
+        m_modelVersion(0),
+        m_predictionCache(pPropParser->getInputDimension(), pPropParser->getInferenceCacheCapacity(), pPropParser->getInferenceCacheResolution()),
+        m_replayBuffer(pPropParser->getInputDimension(), pPropParser->getReplayCapacity(), pPropParser->getReplayRehearsals(), pPropParser->getReplaySeed()),
+        m_modelAllocationCount(0),
+        m_modelSaveAllocationCount(0),
+        m_publicationInterval(pPropParser->getPublicationInterval()),
+        m_numUnpublishedSamples(0),
+        m_numPublications(0),
+        m_publishedFeatureGroups(*pPropParser->getInputParamNames(), pPropParser->getFeatureGroups()),
+        m_publishedModelAllocationCount(0),
+        m_publishedPredictionCache(pPropParser->getInputDimension(), pPropParser->getInferenceCacheCapacity(), pPropParser->getInferenceCacheResolution())
     {
+        m_rehearsalInput.reserve(COMMAND_BUFFER_LENGTH);
         m_pPropParser = pPropParser;
+        m_trainingDataLogEnabled = pPropParser->isTrainingDataLogEnabled();
     }
 
     /* Destructor. */
@@ -40,10 +306,15 @@ public:
     {
         /* Destroy the BinaryOMLCreator pointers in the Creator map. */
         /* Do not increment "it" in the for loop because calling ->erase(it) on a vector we are iterating through is problematic. */
-        for(vector<pair<string, BinaryOMLCreator*>>::iterator it=m_bomlCreatorVector.begin(); it!=m_bomlCreatorVector.end();)
+        for(vector<pair<string, BinaryOMLInterface*>>::iterator it=m_bomlCreatorVector.begin(); it!=m_bomlCreatorVector.end();)
         {
             it = m_bomlCreatorVector.erase(it);
         }
+
+        for(vector<BinaryOMLInterface*>::iterator it=m_shadowModels.begin(); it!=m_shadowModels.end(); ++it)
+        {
+            delete *it;
+        }
     }
 
     /**
@@ -64,20 +335,67 @@ public:
         return string("MochiMochiProxy");
     }
 
+    /**
+     * Heap allocations made so far by the MochiMochi algorithms while training and inferring, by saving any model and by
+     * creating models, as opposed to allocations made by the server itself, the in-tree models' training and inference
+     * included. Only counted when built with ORBITAI_COUNT_ALLOCATIONS, see getAllocationCount().
+     */
+    size_t getModelAllocationCount()
+    {
+        return m_modelAllocationCount;
+    }
+
+    /**
+     * Heap allocations made so far by saving the in-tree models, included in getModelAllocationCount().
+     */
+    size_t getModelSaveAllocationCount()
+    {
+        return m_modelSaveAllocationCount;
+    }
+
+    /**
+     * Heap allocations made so far by the published models while inferring, counted by the inference thread.
+     */
+    size_t getPublishedModelAllocationCount()
+    {
+        return m_publishedModelAllocationCount;
+    }
+
+    /**
+     * Log the prequential metrics of every model, e.g. when requested with the metrics command.
+     */
+    void logMetrics();
+
     /**
      * Train/update the model with the given training input.
      */
     void train(string* pInput, int dim)
     {
-        for(vector<pair<string, BinaryOMLCreator*>>::iterator it=m_bomlCreatorVector.begin(); it!=m_bomlCreatorVector.end(); ++it)
+        projectInput(pInput);
+        m_modelVersion++;
+
+        /* Predict the new sample before learning it. */
+        if(m_prequentialEnabled == 1 || m_driftAction != DriftAction::none)
+        {
+            evaluate(pInput, dim);
+        }
+
+        /* Rehearse past samples of the minority class first, then learn the new sample and offer it to the replay buffer. */
+        rehearse(pInput, dim);
+
+        for(size_t i = 0; i < m_bomlCreatorVector.size(); ++i)
         {
-            it->second->train(pInput, dim);
+            const size_t allocationCount = getAllocationCount();
+            m_bomlCreatorVector[i].second->train(getModelInput(i, pInput), getModelDim(i, dim));
+            countModelAllocations(i, allocationCount, &m_modelAllocationCount);
         }
+        m_replayBuffer.add(pInput);
+        trainShadowModels(pInput, dim);
 
         /* Log the training data. */
-        if(m_pPropParser->isTrainingDataLogEnabled() == 1)
+        if(m_trainingDataLogEnabled == 1)
         {
-            logTrainingData(m_pPropParser->getInputParamNames(), pInput);
+            logTrainingData(pInput);
         }
     }
 
@@ -87,35 +405,135 @@ public:
      */
     void trainAndSave(string* pInput, size_t dim, const string modelDirPath)
     {
-        for(vector<pair<string, BinaryOMLCreator*>>::iterator it=m_bomlCreatorVector.begin(); it!=m_bomlCreatorVector.end(); ++it)
+        const vector<string>& modelFilePaths = getModelFilePaths(modelDirPath);
+        projectInput(pInput);
+        m_modelVersion++;
+
+        /* Predict the new sample before learning it. */
+        if(m_prequentialEnabled == 1 || m_driftAction != DriftAction::none)
+        {
+            evaluate(pInput, dim);
+        }
+
+        /* Rehearse past samples of the minority class first, so that the saved models include the rehearsals. */
+        rehearse(pInput, dim);
+
+        for(size_t i = 0; i < m_bomlCreatorVector.size(); ++i)
+        {
+            /* Serializing a model allocates, so does copying its file path into the by-value argument. */
+            const size_t allocationCount = getAllocationCount();
+            if(m_inTreeModels[i])
+            {
+                /* Only saving an in-tree model is exempted, training it must not allocate. */
+                m_bomlCreatorVector[i].second->train(getModelInput(i, pInput), getModelDim(i, dim));
+                const size_t saveAllocationCount = getAllocationCount();
+                m_bomlCreatorVector[i].second->save(modelFilePaths[i]);
+                m_modelSaveAllocationCount += getAllocationCount() - saveAllocationCount;
+                m_modelAllocationCount += getAllocationCount() - saveAllocationCount;
+            }
+            else
+            {
+                m_bomlCreatorVector[i].second->trainAndSave(getModelInput(i, pInput), getModelDim(i, dim), modelFilePaths[i]);
+                m_modelAllocationCount += getAllocationCount() - allocationCount;
+            }
+        }
+        trainShadowModels(pInput, dim);
+
+        /* The replay buffer is saved with the models. */
+        if(m_replayBuffer.isEnabled())
         {
-            it->second->trainAndSave(pInput, dim, modelDirPath + "/" + it->second->name());
+            m_replayBuffer.add(pInput);
+            m_replayBuffer.save(m_replayBufferFilePath);
         }
 
         /* Log the training data. */
-        if(m_pPropParser->isTrainingDataLogEnabled() == 1)
+        if(m_trainingDataLogEnabled == 1)
         {
-            logTrainingData(m_pPropParser->getInputParamNames(), pInput);
+            logTrainingData(pInput);
         }
     }
 
+    /**
+     * Train/update the model with the given training input, save/serialize the model and publish a copy of the models
+     * for inference every publication interval training samples.
+     * Note that for this proxy function the path argument is the parent directory path rather than the model file path.
+     */
+    void trainAndPublish(string* pInput, size_t dim, const string modelDirPath)
+    {
+        trainAndSave(pInput, dim, modelDirPath);
+
+        if(++m_numUnpublishedSamples >= m_publicationInterval)
+        {
+            publishModels(modelDirPath);
+        }
+    }
+
+    /**
+     * Publish a copy of the saved models for inference, see inferPublished().
+     * The copy is loaded from the model files, the models that have not been saved yet are published untrained.
+     * Note that for this proxy function the path argument is the parent directory path rather than the model file path.
+     */
+    void publishModels(const string modelDirPath);
+
+    /**
+     * Infer/predict the label with the given input using the latest published copy of the models, and log the inference results.
+     * Called by the inference thread while the training thread trains the models, it is not blocked by training nor by checkpoints.
+     */
+    void inferPublished(string* pInput, size_t dim);
+
+    /**
+     * The path of the training data log, CSV or binary.
+     */
+    const char* getTrainingLogFilePath()
+    {
+        return m_binaryLogEnabled ? LOG_FILEPATH_TRAINING_BINARY : LOG_FILEPATH_TRAINING;
+    }
+
+    /**
+     * Train the models for the given number of epochs over the training data logged in the given CSV or binary file and save them once at the end.
+     * The log file is memory mapped and only a compact index of its rows is kept in memory. With shuffle, the rows are visited in a new
+     * random order in every epoch, drawn from the given seed. The replayed samples are not logged again.
+     * Note that for this proxy function the path argument is the parent directory path rather than the model file path.
+     */
+    void trainEpochs(const char* trainingLogFilePath, size_t dim, size_t numEpochs, bool shuffle, unsigned int seed, const string modelDirPath);
+
+    /**
+     * Export a compact snapshot of the saved models for downlink, as a delta of the previously exported snapshot unless full is set.
+     * Models that have not been saved yet are skipped. See ModelSnapshot.
+     */
+    void exportSnapshot(const string modelDirPath, const string snapshotDirPath, bool full);
+
     /**
      * Infer/predict the label with the given input.
      * Note that for this proxy function the return value is not the prediction result.
      */
     int infer(string* pInput, size_t dim)
     {
-        /* This vector will contain the predictions made by the trained algorithms. */
-        vector<pair<string, int>> inferences;
-
-        for(vector<pair<string, BinaryOMLCreator*>>::iterator it=m_bomlCreatorVector.begin(); it!=m_bomlCreatorVector.end(); ++it)
+        /* A repeated input takes the predictions cached for the current models, without scoring them. */
+        if(!m_predictionCache.lookup(pInput, m_modelVersion, &m_inferences))
         {
-            int label = it->second->infer(pInput, dim);
-            inferences.push_back(pair<string, int>(it->second->name(), label));
+            projectInput(pInput);
+
+            /* The predictions made by the trained algorithms, in the same order as the algorithms. */
+            for(size_t i = 0; i < m_bomlCreatorVector.size(); ++i)
+            {
+                const size_t allocationCount = getAllocationCount();
+                m_inferences[i].second = m_bomlCreatorVector[i].second->infer(getModelInput(i, pInput), getModelDim(i, dim));
+                countModelAllocations(i, allocationCount, &m_modelAllocationCount);
+            }
+
+            m_predictionCache.store(m_modelVersion, m_inferences);
         }
 
         /* Log the inference results. */
-        logInferenceResult(m_pPropParser->getInputParamNames(), pInput, &inferences);
+        if(m_binaryLogEnabled)
+        {
+            m_binaryInferenceLogger.logInferenceResult(m_pPropParser->getInputParamNames(), pInput, &m_inferences);
+        }
+        else
+        {
+            m_inferenceLogger.logInferenceResult(m_pPropParser->getInputParamNames(), pInput, &m_inferences);
+        }
         
         /**
          * Multiple model predictions are invoked.
@@ -130,18 +548,19 @@ public:
      */
     void load(const string modelDirPath)
     {
-        string modelFilePath;
+        const vector<string>& modelFilePaths = getModelFilePaths(modelDirPath);
+        m_modelVersion++;
 
-        for(vector<pair<string, BinaryOMLCreator*>>::iterator it=m_bomlCreatorVector.begin(); it!=m_bomlCreatorVector.end(); ++it)
+        for(size_t i = 0; i < m_bomlCreatorVector.size(); ++i)
         {
             /* The file path to the serialized model. */
-            modelFilePath = modelDirPath + "/" + it->second->name();
+            const string& modelFilePath = modelFilePaths[i];
 
             /* If the serialized model file exists then load it. */
             if(exists(modelFilePath) == 1)
             {
                 /* Load the model. */
-                it->second->load(modelFilePath);
+                m_bomlCreatorVector[i].second->load(modelFilePath);
 
                 /* Log that the model has been loaded. */
                 logInfo("Loaded model: " + modelFilePath);
@@ -153,6 +572,45 @@ public:
                 logError(ERROR_SERIALIZED_MODE_NOT_EXIST, "Serialized model file does not exist, training it from sratch instead of loading: " + modelFilePath);
             }
         }
+
+        /* Load the replay buffer saved with the models. */
+        if(m_replayBuffer.isEnabled())
+        {
+            if(exists(m_replayBufferFilePath) == 0)
+            {
+                logError(ERROR_SERIALIZED_MODE_NOT_EXIST, "Replay buffer file does not exist, starting from an empty buffer: " + m_replayBufferFilePath);
+            }
+            else if(m_replayBuffer.load(m_replayBufferFilePath))
+            {
+                logInfo("Loaded replay buffer: " + m_replayBufferFilePath);
+            }
+            else
+            {
+                logError(ERROR_REPLAY_BUFFER_INCOMPATIBLE, "Replay buffer saved with another input dimension or capacity, starting from an empty buffer: " + m_replayBufferFilePath);
+            }
+        }
+    }
+
+    /**
+     * Replace the saved linear models by quantized copies for inference, if set in the properties file, see QuantizedModel.
+     * Called in inference mode once the models are loaded. The other models are kept as they are.
+     * Note that for this proxy function the path argument is the parent directory path rather than the model file path.
+     */
+    void quantizeModels(const string modelDirPath);
+
+    /**
+     * Log the stats of the prediction cache of the inferences, or of the inferences with the published models while models are published.
+     */
+    void logPredictionCacheStats()
+    {
+        if(m_numPublications > 0)
+        {
+            m_publishedPredictionCache.logStats("Prediction cache of the published models");
+        }
+        else
+        {
+            m_predictionCache.logStats("Prediction cache");
+        }
     }
 
     /**
@@ -161,9 +619,16 @@ public:
      */
     void save(const string modelDirPath)
     {
-        for(vector<pair<string, BinaryOMLCreator*>>::iterator it=m_bomlCreatorVector.begin(); it!=m_bomlCreatorVector.end(); ++it)
+        const vector<string>& modelFilePaths = getModelFilePaths(modelDirPath);
+
+        for(size_t i = 0; i < m_bomlCreatorVector.size(); ++i)
+        {
+            m_bomlCreatorVector[i].second->save(modelFilePaths[i]);
+        }
+
+        if(m_replayBuffer.isEnabled())
         {
-            it->second->save(modelDirPath + "/" + it->second->name());
+            m_replayBuffer.save(m_replayBufferFilePath);
         }
     }
 };
@@ -0,0 +1,81 @@
+#include "ModelPublisher.hpp"
+
+/**
+ * Constructor.
+ */
+ModelPublisher::ModelPublisher() :
+    m_pLatest(nullptr),
+    m_pReading(nullptr)
+{
+}
+
+/**
+ * Destructor.
+ */
+ModelPublisher::~ModelPublisher()
+{
+    delete m_pLatest.load();
+
+    for(vector<PublishedModels*>::iterator it = m_retired.begin(); it != m_retired.end(); ++it)
+    {
+        delete *it;
+    }
+}
+
+/**
+ * Publish the given copy of the models.
+ */
+void ModelPublisher::publish(PublishedModels* pModels)
+{
+    PublishedModels* pReplaced = m_pLatest.exchange(pModels);
+    if(pReplaced != nullptr)
+    {
+        m_retired.push_back(pReplaced);
+    }
+
+    /**
+     * Delete the replaced copies the inference thread does not read. It may only read the one it announced:
+     * it checks that the copy it announced is still the latest after announcing it, and from now on the latest is the new one.
+     */
+    PublishedModels* pReading = m_pReading.load();
+    for(vector<PublishedModels*>::iterator it = m_retired.begin(); it != m_retired.end();)
+    {
+        if(*it != pReading)
+        {
+            delete *it;
+            it = m_retired.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+/**
+ * Get the latest published copy of the models and hold it until release().
+ */
+const PublishedModels* ModelPublisher::acquire()
+{
+    /* Announce the copy before reading it, and retry if it was replaced in between, in which case it may already be deleted. */
+    PublishedModels* pModels = m_pLatest.load();
+    while(true)
+    {
+        m_pReading.store(pModels);
+
+        PublishedModels* pLatest = m_pLatest.load();
+        if(pLatest == pModels)
+        {
+            return pModels;
+        }
+        pModels = pLatest;
+    }
+}
+
+/**
+ * Stop reading the copy returned by acquire().
+ */
+void ModelPublisher::release()
+{
+    m_pReading.store(nullptr);
+}
@@ -0,0 +1,122 @@
+#ifndef MODEL_PUBLISHER_H_
+#define MODEL_PUBLISHER_H_
+
+#include <atomic>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* The Binary Machine Learning Algorithm Factory. */
+#include <mochimochi/classifier/factory/binary_oml_factory.hpp>
+
+using namespace std;
+
+/**
+ * An immutable copy of the models, published for inference while the models themselves keep being trained.
+ * The models are deleted with the copy.
+ */
+struct PublishedModels
+{
+    /* Incremented by every publication. */
+    size_t version;
+
+    /* The algorithm names and their models, in the same order as the trained models. */
+    vector<pair<string, BinaryOMLInterface*>> models;
+
+    PublishedModels(size_t version) : version(version) {}
+
+    ~PublishedModels()
+    {
+        for(vector<pair<string, BinaryOMLInterface*>>::iterator it = models.begin(); it != models.end(); ++it)
+        {
+            delete it->second;
+        }
+    }
+
+    PublishedModels(const PublishedModels&) = delete;
+    PublishedModels& operator=(const PublishedModels&) = delete;
+};
+
+/**
+ * Publishes copies of the models from the training thread to the inference thread, RCU style: the training thread
+ * swaps the latest copy with an atomic pointer exchange and the inference thread reads it without taking a lock,
+ * so that an inference is never blocked by a training update or a checkpoint and always uses the latest copy.
+ *
+ * A replaced copy is deleted by a later publication once the inference thread no longer reads it. The inference
+ * thread announces the copy it reads in a hazard pointer, so there can only be one inference thread.
+ */
+class ModelPublisher
+{
+private:
+    /* The latest published copy, null until the first publication. */
+    atomic<PublishedModels*> m_pLatest;
+
+    /* The copy the inference thread is reading, null between inferences. */
+    atomic<PublishedModels*> m_pReading;
+
+    /* Replaced copies that were still being read when replaced, only accessed by the training thread. */
+    vector<PublishedModels*> m_retired;
+
+public:
+
+    /* Constructor. */
+    ModelPublisher();
+
+    /* Destructor, the inference thread must have stopped reading. */
+    ~ModelPublisher();
+
+    ModelPublisher(const ModelPublisher&) = delete;
+    ModelPublisher& operator=(const ModelPublisher&) = delete;
+
+    /**
+     * Publish the given copy of the models, which is owned by the publisher from now on.
+     * Called by the training thread.
+     */
+    void publish(PublishedModels* pModels);
+
+    /**
+     * Get the latest published copy of the models, null if none was published yet, and hold it until release().
+     * Called by the inference thread, does not lock nor allocate.
+     */
+    const PublishedModels* acquire();
+
+    /**
+     * Stop reading the copy returned by acquire().
+     */
+    void release();
+};
+
+/**
+ * Holds the latest published copy of the models for the scope of an inference: acquired when constructed and
+ * released when destroyed, also when the inference throws.
+ */
+class PublishedModelsReader
+{
+private:
+    ModelPublisher& m_publisher;
+    const PublishedModels* m_pModels;
+
+public:
+
+    /* Constructor, acquires the latest published copy. */
+    PublishedModelsReader(ModelPublisher& publisher) : m_publisher(publisher), m_pModels(publisher.acquire()) {}
+
+    /* Destructor, releases the copy. */
+    ~PublishedModelsReader()
+    {
+        m_publisher.release();
+    }
+
+    PublishedModelsReader(const PublishedModelsReader&) = delete;
+    PublishedModelsReader& operator=(const PublishedModelsReader&) = delete;
+
+    /**
+     * The acquired copy of the models, null if none was published yet.
+     */
+    const PublishedModels* get() const
+    {
+        return m_pModels;
+    }
+};
+
+#endif // MODEL_PUBLISHER_H_
@@ -0,0 +1,479 @@
+#include <cerrno>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+
+#include "Utils.hpp"
+#include "ModelSnapshot.hpp"
+
+/* Identifies a snapshot file and its format version. */
+static const char SNAPSHOT_MAGIC[8] = {'O', 'A', 'I', 'S', 'N', 'A', 'P', '1'};
+
+/* File of the base directory holding the number of the last exported snapshot. */
+static const char* SNAPSHOT_NUMBER_FILENAME = "SNAPSHOT";
+
+/* Token types. */
+enum TokenType {
+    TOKEN_INTEGER = 0,
+    TOKEN_DOUBLE = 1,
+    TOKEN_FLOAT = 2,
+    TOKEN_TEXT = 3
+};
+
+/* Codes of the whitespace following a token. */
+enum SeparatorCode {
+    SEPARATOR_NONE = 0,
+    SEPARATOR_SPACE = 1,
+    SEPARATOR_NEWLINE = 2,
+    SEPARATOR_OTHER = 3
+};
+
+/**
+ * A token of a model archive and the whitespace following it.
+ */
+struct SnapshotToken
+{
+    int type;
+    int64_t integer;
+    uint64_t bits;
+    string text;
+    string separator;
+};
+
+static bool isSeparator(char c)
+{
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+/**
+ * Parse an integer that is written back identically, e.g. not "007" or "+7".
+ */
+static bool parseInteger(const string& text, int64_t* pValue)
+{
+    size_t i = text[0] == '-' ? 1 : 0;
+    if(i == text.size() || (text[i] == '0' && text.size() > i + 1) || (i == 1 && text == "-0"))
+    {
+        return false;
+    }
+    for(; i < text.size(); ++i)
+    {
+        if(text[i] < '0' || text[i] > '9')
+        {
+            return false;
+        }
+    }
+
+    errno = 0;
+    const long long value = strtoll(text.c_str(), nullptr, 10);
+    if(errno == ERANGE)
+    {
+        return false;
+    }
+
+    *pValue = value;
+    return true;
+}
+
+/**
+ * Write a floating point value with 17 digits, as the Boost text archives do.
+ */
+static string formatDouble(double value)
+{
+    char digits[40];
+    snprintf(digits, sizeof(digits), "%.17e", value);
+    return string(digits);
+}
+
+/**
+ * Parse a floating point value that is written back identically with 17 digits.
+ */
+static bool parseDouble(const string& text, double* pValue)
+{
+    if(text.find_first_of("0123456789") == string::npos)
+    {
+        return false;
+    }
+
+    char* pEnd;
+    const double value = strtod(text.c_str(), &pEnd);
+    if(*pEnd != '\0' || formatDouble(value) != text)
+    {
+        return false;
+    }
+
+    *pValue = value;
+    return true;
+}
+
+/**
+ * Split a model archive into tokens, returning the whitespace before the first token.
+ */
+static string tokenize(const string& archive, bool quantize, vector<SnapshotToken>* pTokens)
+{
+    size_t i = 0;
+    while(i < archive.size() && isSeparator(archive[i]))
+    {
+        ++i;
+    }
+    const string leading = archive.substr(0, i);
+
+    while(i < archive.size())
+    {
+        SnapshotToken token;
+        const size_t tokenStart = i;
+        while(i < archive.size() && !isSeparator(archive[i]))
+        {
+            ++i;
+        }
+        token.text = archive.substr(tokenStart, i - tokenStart);
+
+        const size_t separatorStart = i;
+        while(i < archive.size() && isSeparator(archive[i]))
+        {
+            ++i;
+        }
+        token.separator = archive.substr(separatorStart, i - separatorStart);
+
+        double value;
+        if(parseInteger(token.text, &token.integer))
+        {
+            token.type = TOKEN_INTEGER;
+        }
+        else if(parseDouble(token.text, &value))
+        {
+            /* Values out of the range of floats are kept as doubles. */
+            if(quantize && fabs(value) <= FLT_MAX)
+            {
+                const float quantized = static_cast<float>(value);
+                uint32_t bits;
+                memcpy(&bits, &quantized, sizeof(bits));
+                token.type = TOKEN_FLOAT;
+                token.bits = bits;
+            }
+            else
+            {
+                token.type = TOKEN_DOUBLE;
+                memcpy(&token.bits, &value, sizeof(token.bits));
+            }
+        }
+        else
+        {
+            token.type = TOKEN_TEXT;
+        }
+
+        pTokens->push_back(token);
+    }
+
+    return leading;
+}
+
+/**
+ * Write the tokens back as they are reconstructed on ground.
+ */
+static string render(const string& leading, const vector<SnapshotToken>& tokens)
+{
+    string archive = leading;
+    for(vector<SnapshotToken>::const_iterator it = tokens.begin(); it != tokens.end(); ++it)
+    {
+        if(it->type == TOKEN_INTEGER)
+        {
+            archive += to_string(it->integer);
+        }
+        else if(it->type == TOKEN_DOUBLE)
+        {
+            double value;
+            memcpy(&value, &it->bits, sizeof(value));
+            archive += formatDouble(value);
+        }
+        else if(it->type == TOKEN_FLOAT)
+        {
+            const uint32_t bits = static_cast<uint32_t>(it->bits);
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            archive += formatDouble(value);
+        }
+        else
+        {
+            archive += it->text;
+        }
+        archive += it->separator;
+    }
+
+    return archive;
+}
+
+/**
+ * Whether a model can be encoded as a delta of the given base: the same archive except for the values of its
+ * integers and floating point values, so that only the values have to be encoded.
+ */
+static bool isDeltaOf(const string& leading, const vector<SnapshotToken>& tokens, const string& baseLeading,
+    const vector<SnapshotToken>& baseTokens)
+{
+    if(leading != baseLeading || tokens.size() != baseTokens.size())
+    {
+        return false;
+    }
+
+    for(size_t i = 0; i < tokens.size(); ++i)
+    {
+        if(tokens[i].type != baseTokens[i].type || tokens[i].separator != baseTokens[i].separator
+            || (tokens[i].type == TOKEN_TEXT && tokens[i].text != baseTokens[i].text))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void writeVarint(string* pBytes, uint64_t value)
+{
+    while(value >= 0x80)
+    {
+        pBytes->push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    pBytes->push_back(static_cast<char>(value));
+}
+
+static void writeString(string* pBytes, const string& str)
+{
+    writeVarint(pBytes, str.size());
+    pBytes->append(str);
+}
+
+/**
+ * Write the given number of low bytes of a value, most significant first so that the leading zero bytes of XORed
+ * values come first.
+ */
+static void writeBigEndian(string* pBytes, uint64_t value, int numBytes)
+{
+    for(int i = numBytes - 1; i >= 0; --i)
+    {
+        pBytes->push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+static void writeUint32(string* pBytes, uint32_t value)
+{
+    for(int i = 0; i < 4; ++i)
+    {
+        pBytes->push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+/**
+ * Encode a model, as a delta of its base tokens if given. A delta only has the values of the tokens, the rest of
+ * the archive is the base's and the ground tokenizes the base as the server does given the quantization flag.
+ */
+static void encodeModel(string* pBytes, const string& name, const string& leading, const vector<SnapshotToken>& tokens,
+    const vector<SnapshotToken>* pBaseTokens, bool quantize)
+{
+    writeString(pBytes, name);
+    if(pBaseTokens != nullptr)
+    {
+        pBytes->push_back(1);
+        pBytes->push_back(quantize ? 1 : 0);
+    }
+    else
+    {
+        pBytes->push_back(0);
+        writeString(pBytes, leading);
+        writeVarint(pBytes, tokens.size());
+    }
+
+    for(size_t i = 0; i < tokens.size(); ++i)
+    {
+        const SnapshotToken& token = tokens[i];
+        if(pBaseTokens == nullptr)
+        {
+            pBytes->push_back(static_cast<char>(token.type));
+        }
+
+        if(token.type == TOKEN_INTEGER)
+        {
+            /* Zigzag encoding of the difference, small negative values get small codes too. */
+            const uint64_t base = pBaseTokens != nullptr ? static_cast<uint64_t>((*pBaseTokens)[i].integer) : 0;
+            const int64_t delta = static_cast<int64_t>(static_cast<uint64_t>(token.integer) - base);
+            writeVarint(pBytes, (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+        }
+        else if(token.type == TOKEN_DOUBLE || token.type == TOKEN_FLOAT)
+        {
+            const uint64_t base = pBaseTokens != nullptr ? (*pBaseTokens)[i].bits : 0;
+            writeBigEndian(pBytes, token.bits ^ base, token.type == TOKEN_DOUBLE ? 8 : 4);
+        }
+        else if(pBaseTokens == nullptr)
+        {
+            writeString(pBytes, token.text);
+        }
+
+        if(pBaseTokens != nullptr)
+        {
+            continue;
+        }
+
+        if(token.separator.empty())
+        {
+            pBytes->push_back(SEPARATOR_NONE);
+        }
+        else if(token.separator == " ")
+        {
+            pBytes->push_back(SEPARATOR_SPACE);
+        }
+        else if(token.separator == "\n")
+        {
+            pBytes->push_back(SEPARATOR_NEWLINE);
+        }
+        else
+        {
+            pBytes->push_back(SEPARATOR_OTHER);
+            writeString(pBytes, token.separator);
+        }
+    }
+}
+
+/**
+ * Order-0 adaptive binary arithmetic coder: each bit of a byte is coded with the probability learned for the bits
+ * of the byte preceding it.
+ */
+static string compress(const string& bytes)
+{
+    string compressed;
+    uint32_t x1 = 0;
+    uint32_t x2 = 0xFFFFFFFF;
+
+    /* Probabilities of a 1 bit, 16 bits fixed point, per partial byte. */
+    vector<uint16_t> probabilities(256, 1 << 15);
+
+    for(size_t i = 0; i < bytes.size(); ++i)
+    {
+        const uint8_t byte = static_cast<uint8_t>(bytes[i]);
+        uint32_t context = 1;
+
+        for(int b = 7; b >= 0; --b)
+        {
+            const int bit = (byte >> b) & 1;
+            uint16_t& p = probabilities[context];
+
+            const uint32_t xmid = x1 + static_cast<uint32_t>((static_cast<uint64_t>(x2 - x1) * p) >> 16);
+            if(bit)
+            {
+                x2 = xmid;
+                p += (65536 - p) >> 4;
+            }
+            else
+            {
+                x1 = xmid + 1;
+                p -= p >> 4;
+            }
+            context = (context << 1) | bit;
+
+            /* Shift out the leading bytes that can no longer change. */
+            while(((x1 ^ x2) & 0xFF000000) == 0)
+            {
+                compressed.push_back(static_cast<char>(x2 >> 24));
+                x1 <<= 8;
+                x2 = (x2 << 8) | 0xFF;
+            }
+        }
+    }
+
+    /* Flush. */
+    for(int i = 3; i >= 0; --i)
+    {
+        compressed.push_back(static_cast<char>((x1 >> (8 * i)) & 0xFF));
+    }
+
+    return compressed;
+}
+
+static string readFile(const string& filePath)
+{
+    ifstream file(filePath, ios::binary);
+    if(!file.good())
+    {
+        throw runtime_error("Failed to read file: " + filePath);
+    }
+
+    ostringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+static void writeFile(const string& filePath, const string& content)
+{
+    ofstream file(filePath, ios::binary | ios::trunc);
+    file << content;
+    if(!file.good())
+    {
+        throw runtime_error("Failed to write file: " + filePath);
+    }
+}
+
+/**
+ * Export a snapshot of the given model files into the given directory.
+ */
+string ModelSnapshot::exportSnapshot(const vector<pair<string, string>>& models, const string& snapshotDirPath, bool full, bool quantize)
+{
+    const string baseDirPath = snapshotDirPath + "/base";
+    mkdir(snapshotDirPath.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+    mkdir(baseDirPath.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+
+    /* The number of the previous snapshot, 0 if there is none. */
+    const string numberFilePath = baseDirPath + "/" + SNAPSHOT_NUMBER_FILENAME;
+    uint32_t baseNumber = 0;
+    if(exists(numberFilePath))
+    {
+        baseNumber = static_cast<uint32_t>(strtoul(readFile(numberFilePath).c_str(), nullptr, 10));
+    }
+    const uint32_t number = baseNumber + 1;
+    if(full)
+    {
+        baseNumber = 0;
+    }
+
+    string body;
+    writeVarint(&body, models.size());
+
+    for(vector<pair<string, string>>::const_iterator it = models.begin(); it != models.end(); ++it)
+    {
+        vector<SnapshotToken> tokens;
+        const string leading = tokenize(readFile(it->second), quantize, &tokens);
+
+        /* A model that changed shape, e.g. a Hoeffding tree that split, is encoded in full. */
+        const string baseFilePath = baseDirPath + "/" + it->first;
+        vector<SnapshotToken> baseTokens;
+        bool isDelta = false;
+        if(baseNumber > 0 && exists(baseFilePath))
+        {
+            const string baseLeading = tokenize(readFile(baseFilePath), quantize, &baseTokens);
+            isDelta = isDeltaOf(leading, tokens, baseLeading, baseTokens);
+        }
+
+        encodeModel(&body, it->first, leading, tokens, isDelta ? &baseTokens : nullptr, quantize);
+
+        /* The next snapshot is a delta of the model as reconstructed on ground. */
+        writeFile(baseFilePath, render(leading, tokens));
+    }
+
+    string snapshot(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    writeUint32(&snapshot, number);
+    writeUint32(&snapshot, baseNumber);
+    writeUint32(&snapshot, static_cast<uint32_t>(body.size()));
+    snapshot += compress(body);
+
+    char fileName[32];
+    snprintf(fileName, sizeof(fileName), "snapshot_%06u.bin", number);
+    const string snapshotFilePath = snapshotDirPath + "/" + fileName;
+    writeFile(snapshotFilePath, snapshot);
+    writeFile(numberFilePath, to_string(number) + "\n");
+
+    return snapshotFilePath;
+}
@@ -0,0 +1,42 @@
+#ifndef MODEL_SNAPSHOT_H_
+#define MODEL_SNAPSHOT_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Exports compact snapshots of the saved model files for downlink, reconstructed on ground by tools/reconstruct.py.
+ *
+ * The model files are text archives of mostly numbers. Each archive is split into tokens: integers, floating point
+ * values written with 17 digits and other text, with the whitespace between them. Integers are encoded as varints
+ * and floating point values as their 8 bytes, or as the 4 bytes of their nearest float with quantization.
+ * Against the previously exported snapshot, integers are encoded as their difference and floating point values as
+ * the XOR of their bits, which zeroes the leading bytes of values that changed little. The encoded snapshot is then
+ * compressed with an adaptive binary arithmetic coder.
+ *
+ * File format: "OAISNAP1", the snapshot number, the number of the snapshot it is a delta of (0 for none) and the
+ * length of the encoded snapshot as little-endian uint32, followed by the compressed encoded snapshot.
+ *
+ * The models as reconstructed on ground are kept in the base/ subdirectory of the snapshot directory, so that
+ * the deltas of the next snapshot are against exactly what the ground has.
+ */
+class ModelSnapshot
+{
+private:
+    /* Hide constructor. */
+    ModelSnapshot() {};
+
+public:
+
+    /**
+     * Export a snapshot of the given model files, given as model name and file path pairs, into the given directory.
+     * The snapshot is a delta of the previous one unless full is set. Floating point values are quantized to floats
+     * if quantize is set. Returns the path of the snapshot file.
+     */
+    static string exportSnapshot(const vector<pair<string, string>>& models, const string& snapshotDirPath, bool full, bool quantize);
+};
+
+#endif // MODEL_SNAPSHOT_H_
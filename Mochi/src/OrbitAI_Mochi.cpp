@@ -3,16 +3,20 @@
 #include <sys/types.h>  /* For mkdkir */
 #include <sys/stat.h>   /* For mkdkir */
 #include <unistd.h>
+#include <poll.h>       /* For poll */
 #include <string>
 #include <map>
+#include <thread>
 #include <vector>
 
+#include "AllocationCounter.hpp"
 #include "Constants.hpp"
 #include "Utils.hpp"
 #include "PropertiesParser.hpp"
 #include "HyperParameters.hpp"
 #include "SocketServer.hpp"
 #include "MochiMochiProxy.hpp"
+#include "TrainingScheduler.hpp"
 
 using namespace std;
 
@@ -20,17 +24,46 @@ using namespace std;
 enum class Mode {
     trainNew = 0,
     trainContinue = 1,
-    infer = 2
+    infer = 2,
+    trainInfer = 3
 };
 
 /* Flag to keep track if models were loaded or not. */
 int gModelsLoadedFlag = 0;
 
+#ifdef ORBITAI_COUNT_ALLOCATIONS
+/* Training and inference commands processed since the start or the last reset. The first one opens the log files and loads the models. */
+size_t gNumHotPathCommands = 0;
+
+/* Queued training samples trained since the start or the last reset. The first one opens the log files. */
+size_t gNumHotPathSamples = 0;
+#endif
+
 /**
  * Process the received command.
+ * The training or inference input is extracted into the given input string, whose capacity is reused from command to command.
+ * The training inputs are queued when the training scheduler is enabled.
  * Returns flag indicating if the program loop should be exited or not.
  */
-int processReceivedCommand(int mode, int dim, string *pReceivedCommand, MochiMochiProxy *pMochiMochiProxy, int *pErrorCode);
+int processReceivedCommand(int mode, int dim, string *pReceivedCommand, string *pInput, MochiMochiProxy *pMochiMochiProxy, TrainingScheduler *pTrainingScheduler, int *pErrorCode);
+
+/**
+ * Train the oldest queued training sample if the training budget allows, or regardless of the budget if it is ignored.
+ * Returns whether a sample was trained.
+ */
+bool trainQueuedSample(int mode, int dim, TrainingScheduler *pTrainingScheduler, MochiMochiProxy *pMochiMochiProxy, bool ignoreBudget);
+
+/**
+ * Extract the training or inference input of the received command into the given input string.
+ * The first four characters of the command are its total length.
+ */
+void extractInput(const string *pReceivedCommand, string *pInput);
+
+/**
+ * Serve the inference requests received on the given port with the models published by the training, see Mode::trainInfer.
+ * Run by the inference thread until the connection is closed.
+ */
+void serveInference(int portNumber, int dim, MochiMochiProxy *pMochiMochiProxy);
 
 
 /**
@@ -61,10 +94,14 @@ int main(int argc, char *argv[])
         /* Load the properties file and parse it into a map. */
         PropertiesParser propParser(argv[1]);
 
+        /* Rotate the log files by size and age, and cap the disk usage of the logs directory. */
+        LogRotation::configure(propParser.getLogRotateSize(), propParser.getLogRotateAge(),
+            propParser.getLogCap(), propParser.isLogCompressEnabled() == 1);
+
         /* The socket serve's port number. */
         const int portNumber = propParser.getPortNumber();
 
-        /* Get mode: 0 - new training, 1 - continue training, or 2 - inference. */
+        /* Get mode: 0 - new training, 1 - continue training, 2 - inference, or 3 - training and inference. */
         const int mode = propParser.getMode();
 
         /* The input dimension. */
@@ -81,9 +118,36 @@ int main(int argc, char *argv[])
         /* Init the enabled algorithms. */
         mochiMochiProxy.initAlgorithms(dim, &hpMap);
 
+        /* Schedule the training within a CPU budget per tick, if set in the properties file. */
+        TrainingScheduler trainingScheduler(propParser.getScheduleTick(), propParser.getScheduleBudget(),
+            propParser.getScheduleQueueCapacity(), propParser.getScheduleSubsample());
+
+        /**
+         * When training and inferring at the same time, the training continues from the saved models and a copy of them
+         * is published for the inference thread, which serves the inference requests on its own port.
+         */
+        if(mode == static_cast<int>(Mode::trainInfer))
+        {
+            mochiMochiProxy.load(DIR_PATH_MODELS);
+            gModelsLoadedFlag = 1;
+            mochiMochiProxy.publishModels(DIR_PATH_MODELS);
+
+            /* The inference thread ends with the process. */
+            thread(serveInference, propParser.getInferencePortNumber(), dim, &mochiMochiProxy).detach();
+        }
+
         /* The buffer for received commands. */
         char buffer[COMMAND_BUFFER_LENGTH];
 
+        /**
+         * The received command and the training or inference input it contains.
+         * Their memory is allocated once so that processing a training or inference command does not allocate heap memory.
+         */
+        string receivedCmd;
+        receivedCmd.reserve(COMMAND_BUFFER_LENGTH);
+        string input;
+        input.reserve(COMMAND_BUFFER_LENGTH);
+
         /* Create Socket Server object. */
         SocketServer socketServer;
 
@@ -107,17 +171,31 @@ int main(int argc, char *argv[])
         /* Wait for a connection and read from the connection. */
         while(1)
         {
+            /**
+             * With the training scheduler, a pending command is always processed before the next queued training sample,
+             * which is trained if no command is received before the budget of the current tick allows it.
+             */
+            if(trainingScheduler.isEnabled())
+            {
+                struct pollfd pollFd = {connection, POLLIN, 0};
+                if(poll(&pollFd, 1, trainingScheduler.getTimeout()) == 0)
+                {
+                    trainQueuedSample(mode, dim, &trainingScheduler, &mochiMochiProxy, false);
+                    continue;
+                }
+            }
+
             /* Read received command. */
             auto bytesRead = read(connection, buffer, COMMAND_BUFFER_LENGTH);
 
             /* Get string representation of the command. */
-            string receivedCmd(buffer, bytesRead);
+            receivedCmd.assign(buffer, bytesRead);
 
             /* Print out received command. */
             //std::cout << "Received: " << receivedCmd << std::endl;
 
             /* Process the received command and break out the server loop if it's an exit command. */
-            breakLoop = processReceivedCommand(mode, dim, &receivedCmd, &mochiMochiProxy, &cmdErrorCode);
+            breakLoop = processReceivedCommand(mode, dim, &receivedCmd, &input, &mochiMochiProxy, &trainingScheduler, &cmdErrorCode);
 
             /* Check for error and log if any. */
             if(cmdErrorCode != NO_ERROR)
@@ -132,6 +210,23 @@ int main(int argc, char *argv[])
             }
         }
 
+        /* The samples still queued are trained before exiting, regardless of the budget. */
+        if(trainingScheduler.isEnabled())
+        {
+            while(trainQueuedSample(mode, dim, &trainingScheduler, &mochiMochiProxy, true))
+            {
+            }
+            trainingScheduler.logStats();
+        }
+
+#ifdef ORBITAI_COUNT_ALLOCATIONS
+        /* The allocations exempted from the hot path check are reported rather than hidden. */
+        logInfo("Heap allocations exempted from the hot path check: " + to_string(mochiMochiProxy.getModelAllocationCount())
+            + " by the MochiMochi algorithms and by saving or creating models, of which "
+            + to_string(mochiMochiProxy.getModelSaveAllocationCount()) + " by saving the in-tree models, and "
+            + to_string(LogRotation::getAllocationCount()) + " by rotating the logs");
+#endif
+
         /* Close connection and socket. */
         socketServer.shutdownSocketServer(&sockfd, &connection);
 
@@ -155,7 +250,7 @@ int main(int argc, char *argv[])
  * Process the received command.
  * Returns flag indicating if the program loop should be exited or not.
  */
-int processReceivedCommand(int mode, int dim, string *pReceivedCommand, MochiMochiProxy *pMochiMochiProxy, int *pErrorCode)
+int processReceivedCommand(int mode, int dim, string *pReceivedCommand, string *pInput, MochiMochiProxy *pMochiMochiProxy, TrainingScheduler *pTrainingScheduler, int *pErrorCode)
 {
     /* Assume no errors. */
     *pErrorCode = NO_ERROR;
@@ -166,6 +261,15 @@ int processReceivedCommand(int mode, int dim, string *pReceivedCommand, MochiMoc
         {
             /* Delete all model and log files. */
             pMochiMochiProxy->reset();
+
+            /* The queued samples are shed with the models. */
+            pTrainingScheduler->clear();
+
+#ifdef ORBITAI_COUNT_ALLOCATIONS
+            /* The log files are opened again by the next command. */
+            gNumHotPathCommands = 0;
+            gNumHotPathSamples = 0;
+#endif
         }
         else if(pReceivedCommand->compare(0, COMMAND_SAVE_LENGTH, COMMAND_SAVE) == 0)
         {
@@ -177,15 +281,111 @@ int processReceivedCommand(int mode, int dim, string *pReceivedCommand, MochiMoc
             /* Exit the server loop. */
             return EXIT_PROGRAM_LOOP_YES;
         }
+        else if(pReceivedCommand->compare(0, COMMAND_METRICS_LENGTH, COMMAND_METRICS) == 0)
+        {
+            /* Log the prequential metrics of the models trained so far. */
+            pMochiMochiProxy->logMetrics();
+        }
+        else if(pReceivedCommand->compare(0, COMMAND_STATS_LENGTH, COMMAND_STATS) == 0)
+        {
+            /* Log the stats of the training scheduler and of the prediction cache. */
+            pTrainingScheduler->logStats();
+            pMochiMochiProxy->logPredictionCacheStats();
+        }
+        else if(pReceivedCommand->compare(0, COMMAND_EXPORT_LENGTH, COMMAND_EXPORT) == 0)
+        {
+            /**
+             * Export a snapshot of the saved models for downlink, e.g.:
+             *
+             * export
+             * export full
+             *
+             * The snapshot is a delta of the previously exported one, unless full is given.
+             */
+            istringstream args(pReceivedCommand->substr(COMMAND_EXPORT_LENGTH));
+
+            string fullArg;
+            const bool full = static_cast<bool>(args >> fullArg);
+            if(full && fullArg.compare("full") != 0)
+            {
+                throw invalid_argument("Invalid export argument: " + fullArg);
+            }
+
+            pMochiMochiProxy->exportSnapshot(DIR_PATH_MODELS, DIR_PATH_SNAPSHOTS, full);
+        }
+        else if(pReceivedCommand->compare(0, COMMAND_EPOCHS_LENGTH, COMMAND_EPOCHS) == 0)
+        {
+            /**
+             * Train for a number of epochs over the logged training data, e.g.:
+             *
+             * epochs 10
+             * epochs 10 shuffle
+             * epochs 10 shuffle 42
+             *
+             * The optional shuffle argument visits the samples in a new random order in every epoch, optionally seeded.
+             */
+            istringstream args(pReceivedCommand->substr(COMMAND_EPOCHS_LENGTH));
+
+            int numEpochs = 0;
+            args >> numEpochs;
+            if(args.fail() || numEpochs < 1)
+            {
+                throw invalid_argument("Invalid number of epochs.");
+            }
+
+            bool shuffle = false;
+            unsigned int seed = EPOCHS_SHUFFLE_SEED_DEFAULT;
+            string shuffleArg;
+            if(args >> shuffleArg)
+            {
+                if(shuffleArg.compare("shuffle") != 0)
+                {
+                    throw invalid_argument("Invalid epochs argument: " + shuffleArg);
+                }
+                shuffle = true;
+
+                if(!(args >> seed))
+                {
+                    seed = EPOCHS_SHUFFLE_SEED_DEFAULT;
+                }
+            }
+
+            if(mode == static_cast<int>(Mode::infer))
+            {
+                /* Models are not trained in inference mode. */
+                *pErrorCode = ERROR_PROCESSING_RECEIVED_COMMAND;
+                return EXIT_PROGRAM_LOOP_NO;
+            }
+
+            /* Load models if they weren't loaded already, when continuing the training. */
+            if(mode == static_cast<int>(Mode::trainContinue) && gModelsLoadedFlag == 0)
+            {
+                /* Load all the models. */
+                pMochiMochiProxy->load(DIR_PATH_MODELS);
+
+                /* Mark models as having been loaded. */
+                gModelsLoadedFlag = 1;
+            }
+
+            /* Train over the training data log and save the models once. */
+            pMochiMochiProxy->trainEpochs(pMochiMochiProxy->getTrainingLogFilePath(), dim, numEpochs, shuffle, seed, DIR_PATH_MODELS);
+
+            /* The refined models are used for inference right away. */
+            if(mode == static_cast<int>(Mode::trainInfer))
+            {
+                pMochiMochiProxy->publishModels(DIR_PATH_MODELS);
+            }
+        }
         else
         {
             /**
              * Entering this else block means that the receive command is either for training or inference.
-             * There are three possible modes:
+             * There are four possible modes:
              * 
              *  Mode 0: New Training.
              *  Mode 1: Continue Training.
              *  Mode 2: Inference.
+             *  Mode 3: Continue Training, with inference requests received on their own port.
              * 
              * Command structure:
              * - First four characters is the total length of the received message.
@@ -201,17 +401,28 @@ int processReceivedCommand(int mode, int dim, string *pReceivedCommand, MochiMoc
              * 
              */ 
 
-            /* First four characters is the total length of the received message. */
-            int messageLength = std::stoi(pReceivedCommand->substr(0, 4));
+#ifdef ORBITAI_COUNT_ALLOCATIONS
+            /* Count the allocations made by the server while processing the command, not those made by the algorithms or the log rotation. */
+            const size_t allocationCount = getAllocationCount();
+            const size_t modelAllocationCount = pMochiMochiProxy->getModelAllocationCount();
+            const size_t rotationAllocationCount = LogRotation::getAllocationCount();
+#endif
 
-            /* The rest is the actual training or inference input. */
-            string input = pReceivedCommand->substr(5, messageLength-5);
+            /* First four characters is the total length of the received message, the rest is the actual training or inference input. */
+            extractInput(pReceivedCommand, pInput);
 
             switch(mode)
             {
                 case static_cast<int>(Mode::trainNew):
-                    /* Train and save models. */
-                    pMochiMochiProxy->trainAndSave(&input, dim, DIR_PATH_MODELS);
+                    /* Train and save models, or queue the sample for the training scheduler. */
+                    if(pTrainingScheduler->isEnabled())
+                    {
+                        pTrainingScheduler->enqueue(pInput);
+                    }
+                    else
+                    {
+                        pMochiMochiProxy->trainAndSave(pInput, dim, DIR_PATH_MODELS);
+                    }
                     break;
 
                 case static_cast<int>(Mode::trainContinue):
@@ -226,8 +437,15 @@ int processReceivedCommand(int mode, int dim, string *pReceivedCommand, MochiMoc
                         gModelsLoadedFlag = 1;
                     }
 
-                    /* Train and save models. */
-                    pMochiMochiProxy->trainAndSave(&input, dim, DIR_PATH_MODELS);
+                    /* Train and save models, or queue the sample for the training scheduler. */
+                    if(pTrainingScheduler->isEnabled())
+                    {
+                        pTrainingScheduler->enqueue(pInput);
+                    }
+                    else
+                    {
+                        pMochiMochiProxy->trainAndSave(pInput, dim, DIR_PATH_MODELS);
+                    }
 
                     break;
 
@@ -239,19 +457,47 @@ int processReceivedCommand(int mode, int dim, string *pReceivedCommand, MochiMoc
                         /* Load all the models. */
                         pMochiMochiProxy->load(DIR_PATH_MODELS);
 
+                        /* Replace the linear models by their quantized copies, if set in the properties file. */
+                        pMochiMochiProxy->quantizeModels(DIR_PATH_MODELS);
+
                         /* Mark models as having been loaded. */
                         gModelsLoadedFlag = 1;
                     }
 
                     // TODO: Log prediction results.
-                    pMochiMochiProxy->infer(&input, dim);
+                    pMochiMochiProxy->infer(pInput, dim);
 
                     break;
 
+                case static_cast<int>(Mode::trainInfer):
+                    /* Train and save models, and publish them for inference from time to time, or queue the sample for the training scheduler. */
+                    if(pTrainingScheduler->isEnabled())
+                    {
+                        pTrainingScheduler->enqueue(pInput);
+                    }
+                    else
+                    {
+                        pMochiMochiProxy->trainAndPublish(pInput, dim, DIR_PATH_MODELS);
+                    }
+                    break;
+
                 default:
                     /* Unexpected command */
                     *pErrorCode = ERROR_PROCESSING_RECEIVED_COMMAND;
             }
+
+#ifdef ORBITAI_COUNT_ALLOCATIONS
+            /* Steady state training and inference must not allocate. */
+            const size_t serverAllocationCount = (getAllocationCount() - allocationCount)
+                - (pMochiMochiProxy->getModelAllocationCount() - modelAllocationCount)
+                - (LogRotation::getAllocationCount() - rotationAllocationCount);
+
+            if(gNumHotPathCommands > 0 && serverAllocationCount > 0)
+            {
+                logError(ERROR_HOT_PATH_ALLOCATION, "Processing the command made " + to_string(serverAllocationCount) + " heap allocations: " + *pReceivedCommand);
+            }
+            gNumHotPathCommands++;
+#endif
         }
     }
     catch(const exception& e)
@@ -266,4 +512,163 @@ int processReceivedCommand(int mode, int dim, string *pReceivedCommand, MochiMoc
     }
 
     return EXIT_PROGRAM_LOOP_NO;
+}
+
+/**
+ * Train the oldest queued training sample if the training budget allows, or regardless of the budget if it is ignored.
+ */
+bool trainQueuedSample(int mode, int dim, TrainingScheduler *pTrainingScheduler, MochiMochiProxy *pMochiMochiProxy, bool ignoreBudget)
+{
+    string *pInput = pTrainingScheduler->beginTraining(ignoreBudget);
+    if(pInput == nullptr)
+    {
+        return false;
+    }
+
+    try
+    {
+#ifdef ORBITAI_COUNT_ALLOCATIONS
+        /* Count the allocations made by the server while training the sample, not those made by the algorithms or the log rotation. */
+        const size_t allocationCount = getAllocationCount();
+        const size_t modelAllocationCount = pMochiMochiProxy->getModelAllocationCount();
+        const size_t rotationAllocationCount = LogRotation::getAllocationCount();
+#endif
+
+        if(mode == static_cast<int>(Mode::trainInfer))
+        {
+            pMochiMochiProxy->trainAndPublish(pInput, dim, DIR_PATH_MODELS);
+        }
+        else
+        {
+            pMochiMochiProxy->trainAndSave(pInput, dim, DIR_PATH_MODELS);
+        }
+
+#ifdef ORBITAI_COUNT_ALLOCATIONS
+        /* Steady state training must not allocate. */
+        const size_t serverAllocationCount = (getAllocationCount() - allocationCount)
+            - (pMochiMochiProxy->getModelAllocationCount() - modelAllocationCount)
+            - (LogRotation::getAllocationCount() - rotationAllocationCount);
+
+        if(gNumHotPathSamples > 0 && serverAllocationCount > 0)
+        {
+            logError(ERROR_HOT_PATH_ALLOCATION, "Training the queued sample made " + to_string(serverAllocationCount) + " heap allocations: " + *pInput);
+        }
+        gNumHotPathSamples++;
+#endif
+    }
+    catch(const exception& e)
+    {
+        /* Log error. */
+        ostringstream oss;
+        oss << "Exception thrown while training a queued sample. The exception's explanatory string: " << e.what();
+        logError(oss.str());
+        logError(ERROR_PROCESSING_RECEIVED_COMMAND, "Failed to train the following queued sample: " + *pInput);
+    }
+
+    /* The sample is released whether it was trained or not. */
+    pTrainingScheduler->endTraining();
+
+    return true;
+}
+
+/**
+ * Extract the training or inference input of the received command into the given input string.
+ */
+void extractInput(const string *pReceivedCommand, string *pInput)
+{
+    /* First four characters is the total length of the received message. */
+    char messageLengthChars[5] = {0};
+    pReceivedCommand->copy(messageLengthChars, 4);
+    char* pEnd;
+    const int messageLength = strtol(messageLengthChars, &pEnd, 10);
+    if(pEnd == messageLengthChars)
+    {
+        throw invalid_argument("Invalid message length: " + string(messageLengthChars));
+    }
+
+    /* The rest is the actual training or inference input. */
+    pInput->assign(*pReceivedCommand, 5, messageLength-5);
+}
+
+
+/**
+ * Serve the inference requests received on the given port with the models published by the training.
+ */
+void serveInference(int portNumber, int dim, MochiMochiProxy *pMochiMochiProxy)
+{
+    /* The buffer for received requests. */
+    char buffer[COMMAND_BUFFER_LENGTH];
+
+    /* The received request and its inference input, allocated once like those of the training commands. */
+    string receivedRequest;
+    receivedRequest.reserve(COMMAND_BUFFER_LENGTH);
+    string input;
+    input.reserve(COMMAND_BUFFER_LENGTH);
+
+    /* Init the Socket Server and wait for the inference connection. */
+    SocketServer socketServer;
+    int connection;
+    int sockfd;
+    int errorCode = socketServer.initSocketServer(portNumber, &sockfd, &connection);
+
+    if(errorCode != NO_ERROR)
+    {
+        logError(errorCode, "Failed to initialize the inference Socket Server.");
+        return;
+    }
+
+#ifdef ORBITAI_COUNT_ALLOCATIONS
+    /* Inference requests processed so far. The first one opens the inference log. */
+    size_t numHotPathRequests = 0;
+#endif
+
+    /* The requests are inference inputs such as "0031 -1 1:1.232 2:2.412 3:2.123", with the same structure as the training commands. */
+    while(1)
+    {
+        auto bytesRead = read(connection, buffer, COMMAND_BUFFER_LENGTH);
+        if(bytesRead <= 0)
+        {
+            /* The connection was closed. */
+            break;
+        }
+
+        receivedRequest.assign(buffer, bytesRead);
+
+        try
+        {
+#ifdef ORBITAI_COUNT_ALLOCATIONS
+            /* Count the allocations made by the inference thread, not those made by the published models or the log rotation. */
+            const size_t allocationCount = getAllocationCount();
+            const size_t modelAllocationCount = pMochiMochiProxy->getPublishedModelAllocationCount();
+            const size_t rotationAllocationCount = LogRotation::getAllocationCount();
+#endif
+
+            extractInput(&receivedRequest, &input);
+            pMochiMochiProxy->inferPublished(&input, dim);
+
+#ifdef ORBITAI_COUNT_ALLOCATIONS
+            /* Steady state inference must not allocate. */
+            const size_t serverAllocationCount = (getAllocationCount() - allocationCount)
+                - (pMochiMochiProxy->getPublishedModelAllocationCount() - modelAllocationCount)
+                - (LogRotation::getAllocationCount() - rotationAllocationCount);
+
+            if(numHotPathRequests > 0 && serverAllocationCount > 0)
+            {
+                logError(ERROR_HOT_PATH_ALLOCATION, "Processing the inference request made " + to_string(serverAllocationCount) + " heap allocations: " + receivedRequest);
+            }
+            numHotPathRequests++;
+#endif
+        }
+        catch(const exception& e)
+        {
+            /* Log error. */
+            ostringstream oss;
+            oss << "Exception thrown while processing the received inference request. The exception's explanatory string: " << e.what();
+            logError(oss.str());
+            logError(ERROR_PROCESSING_RECEIVED_COMMAND, "Failed to process the following inference request: " + receivedRequest);
+        }
+    }
+
+    /* Close connection and socket. */
+    socketServer.shutdownSocketServer(&sockfd, &connection);
 }
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "InputParser.hpp"
+#include "Utils.hpp"
+#include "PredictionCache.hpp"
+
+/* Version of the slots that hold no predictions, never a model version. */
+#define EMPTY_SLOT_VERSION                  numeric_limits<uint64_t>::max()
+
+/* FNV-1a offset basis and prime, combining the quantized values one word at a time. */
+#define HASH_OFFSET_BASIS                   14695981039346656037ULL
+#define HASH_PRIME                          1099511628211ULL
+
+/**
+ * Final mix of MurmurHash3, so that every bit of the quantized values spreads to the low bits the slot is taken from.
+ */
+static uint64_t mix(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+/**
+ * Constructor.
+ */
+PredictionCache::PredictionCache(size_t dim, size_t capacity, double resolution) :
+    m_dim(dim),
+    m_capacity(capacity),
+    m_resolution(resolution),
+    m_numModels(0),
+    m_hash(0),
+    m_slot(0),
+    m_numLookups(0),
+    m_numHits(0)
+{
+    if(resolution < 0)
+    {
+        throw invalid_argument("Invalid resolution of the prediction cache, expected 0 or a positive value.");
+    }
+
+    if(!isEnabled())
+    {
+        return;
+    }
+
+    m_hashes.assign(capacity, 0);
+    m_versions.assign(capacity, EMPTY_SLOT_VERSION);
+    m_keys.assign(capacity * dim, 0);
+    m_values.assign(dim, 0);
+    m_key.assign(dim, 0);
+}
+
+/**
+ * Allocate the slots for the predictions of the given number of models.
+ */
+void PredictionCache::init(size_t numModels)
+{
+    if(!isEnabled())
+    {
+        return;
+    }
+
+    m_numModels = numModels;
+    m_predictions.assign(m_capacity * numModels, 0);
+    fill(m_versions.begin(), m_versions.end(), EMPTY_SLOT_VERSION);
+}
+
+/**
+ * Look up the predictions made by the given model version for the given input.
+ */
+bool PredictionCache::lookup(const string* pInput, uint64_t version, vector<pair<string, int>>* pInferences)
+{
+    if(!isEnabled())
+    {
+        return false;
+    }
+
+    InputParser::parse(pInput, m_values.data(), m_dim);
+
+    uint64_t hash = HASH_OFFSET_BASIS;
+    for(size_t i = 0; i < m_dim; ++i)
+    {
+        if(m_resolution > 0)
+        {
+            m_key[i] = static_cast<uint64_t>(llround(m_values[i] / m_resolution));
+        }
+        else
+        {
+            /* The values as they are, with -0 as 0. */
+            const double value = m_values[i] == 0 ? 0.0 : m_values[i];
+            memcpy(&m_key[i], &value, sizeof(uint64_t));
+        }
+
+        hash = (hash ^ m_key[i]) * HASH_PRIME;
+    }
+
+    m_hash = mix(hash);
+    m_slot = m_hash % m_capacity;
+    m_numLookups.fetch_add(1, memory_order_relaxed);
+
+    if(m_versions[m_slot] != version || m_hashes[m_slot] != m_hash
+        || !equal(m_key.begin(), m_key.end(), m_keys.begin() + m_slot * m_dim))
+    {
+        return false;
+    }
+
+    const int* pPredictions = &m_predictions[m_slot * m_numModels];
+    for(size_t i = 0; i < m_numModels; ++i)
+    {
+        (*pInferences)[i].second = pPredictions[i];
+    }
+
+    m_numHits.fetch_add(1, memory_order_relaxed);
+    return true;
+}
+
+/**
+ * Store the given predictions in the slot of the input of the latest lookup.
+ */
+void PredictionCache::store(uint64_t version, const vector<pair<string, int>>& inferences)
+{
+    if(!isEnabled())
+    {
+        return;
+    }
+
+    m_hashes[m_slot] = m_hash;
+    m_versions[m_slot] = version;
+    copy(m_key.begin(), m_key.end(), m_keys.begin() + m_slot * m_dim);
+
+    int* pPredictions = &m_predictions[m_slot * m_numModels];
+    for(size_t i = 0; i < m_numModels; ++i)
+    {
+        pPredictions[i] = inferences[i].second;
+    }
+}
+
+/**
+ * Log the stats of the cache under the given name.
+ */
+void PredictionCache::logStats(const string& name)
+{
+    if(!isEnabled())
+    {
+        logInfo(name + " disabled.");
+        return;
+    }
+
+    const uint64_t numLookups = m_numLookups.load(memory_order_relaxed);
+    const uint64_t numHits = m_numHits.load(memory_order_relaxed);
+
+    char hitRate[32];
+    snprintf(hitRate, sizeof(hitRate), "%.1f", numLookups > 0 ? 100.0 * numHits / numLookups : 0.0);
+
+    logInfo(name + ": " + to_string(numLookups) + " lookups, " + to_string(numHits) + " hits (" + hitRate + "%), "
+        + to_string(m_capacity) + " slots");
+}
@@ -0,0 +1,89 @@
+#ifndef PREDICTION_CACHE_H_
+#define PREDICTION_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Bounded cache of the predictions of the models for the inference inputs, so that a repeated input, e.g. from a run
+ * of identical photodiode readings or from the spacecraft dwelling in an attitude, skips the scoring of every model.
+ *
+ * The input values are quantized to multiples of a resolution, or kept as they are with a resolution of 0, and the
+ * cache is keyed by a hash of the quantized values. Each key has a single slot, a new input replaces the one in its
+ * slot. The quantized values are kept with the predictions so that a hash collision is a miss rather than a wrong hit.
+ * The predictions are stored with the version of the models that made them, which the models bump on every training
+ * update or load: a lookup with another version is a miss, so invalidating the cache takes no work.
+ *
+ * The memory is allocated once, looking up and storing predictions does not allocate.
+ */
+class PredictionCache
+{
+private:
+    size_t m_dim;
+    size_t m_capacity;
+    double m_resolution;
+    size_t m_numModels;
+
+    /* Per slot: the hash, the model version and the quantized values of the input, and the predictions of every model. */
+    vector<uint64_t> m_hashes;
+    vector<uint64_t> m_versions;
+    vector<uint64_t> m_keys;
+    vector<int> m_predictions;
+
+    /* The values, quantized values, hash and slot of the input of the latest lookup. */
+    vector<double> m_values;
+    vector<uint64_t> m_key;
+    uint64_t m_hash;
+    size_t m_slot;
+
+    /* Read by the thread logging the stats while the inference thread looks up its inputs. */
+    atomic<uint64_t> m_numLookups;
+    atomic<uint64_t> m_numHits;
+
+    /* Hide constructor. */
+    PredictionCache() {};
+
+public:
+
+    /**
+     * Constructor, given the input dimension, the number of slots, 0 to disable the cache, and the resolution the
+     * input values are quantized to, 0 for none. Throws if the resolution is negative.
+     */
+    PredictionCache(size_t dim, size_t capacity, double resolution);
+
+    PredictionCache(const PredictionCache&) = delete;
+    PredictionCache& operator=(const PredictionCache&) = delete;
+
+    bool isEnabled() const
+    {
+        return m_capacity > 0;
+    }
+
+    /**
+     * Allocate the slots for the predictions of the given number of models, once the models are created.
+     */
+    void init(size_t numModels);
+
+    /**
+     * Look up the predictions made by the given model version for the given input, e.g. "+1 1:0.11 2:0.22", whose label
+     * is ignored. On a hit the predictions are copied into the given inferences, in the same order as the models.
+     */
+    bool lookup(const string* pInput, uint64_t version, vector<pair<string, int>>* pInferences);
+
+    /**
+     * Store the given predictions, made by the given model version for the input of the latest lookup.
+     */
+    void store(uint64_t version, const vector<pair<string, int>>& inferences);
+
+    /**
+     * Log the stats of the cache under the given name.
+     */
+    void logStats(const string& name);
+};
+
+#endif // PREDICTION_CACHE_H_
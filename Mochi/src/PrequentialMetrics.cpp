@@ -0,0 +1,86 @@
+#include "PrequentialMetrics.hpp"
+
+/**
+ * Constructor.
+ */
+PrequentialMetrics::PrequentialMetrics(double fadingFactor) :
+    m_fadingFactor(fadingFactor > 0 && fadingFactor < 1 ? fadingFactor : 1),
+    m_numSamples(0)
+{
+}
+
+/**
+ * Clear the confusion matrices of the given number of models.
+ */
+void PrequentialMetrics::reset(size_t numModels)
+{
+    m_numSamples = 0;
+    m_confusionMatrices.assign(numModels, ConfusionMatrix{0, 0, 0, 0});
+}
+
+/**
+ * Update the confusion matrices with the predictions of the models for a sample with the given label.
+ */
+void PrequentialMetrics::update(int label, const vector<pair<string, int>>* pPredictions)
+{
+    for(size_t i = 0; i < m_confusionMatrices.size() && i < pPredictions->size(); ++i)
+    {
+        ConfusionMatrix& matrix = m_confusionMatrices[i];
+
+        if(m_fadingFactor < 1)
+        {
+            matrix.truePositives *= m_fadingFactor;
+            matrix.falsePositives *= m_fadingFactor;
+            matrix.trueNegatives *= m_fadingFactor;
+            matrix.falseNegatives *= m_fadingFactor;
+        }
+
+        const bool positivePrediction = (*pPredictions)[i].second > 0;
+        if(label > 0)
+        {
+            (positivePrediction ? matrix.truePositives : matrix.falseNegatives) += 1;
+        }
+        else
+        {
+            (positivePrediction ? matrix.falsePositives : matrix.trueNegatives) += 1;
+        }
+    }
+
+    m_numSamples++;
+}
+
+/**
+ * Mean of the recalls of the classes seen, 0 before any sample.
+ */
+double PrequentialMetrics::getBalancedAccuracy(size_t model) const
+{
+    const ConfusionMatrix& matrix = m_confusionMatrices[model];
+    const double positives = matrix.truePositives + matrix.falseNegatives;
+    const double negatives = matrix.trueNegatives + matrix.falsePositives;
+
+    double recallSum = 0;
+    int numClasses = 0;
+    if(positives > 0)
+    {
+        recallSum += matrix.truePositives / positives;
+        numClasses++;
+    }
+    if(negatives > 0)
+    {
+        recallSum += matrix.trueNegatives / negatives;
+        numClasses++;
+    }
+
+    return numClasses > 0 ? recallSum / numClasses : 0;
+}
+
+/**
+ * Harmonic mean of the precision and the recall of the positive class.
+ */
+double PrequentialMetrics::getF1Score(size_t model) const
+{
+    const ConfusionMatrix& matrix = m_confusionMatrices[model];
+    const double denominator = 2 * matrix.truePositives + matrix.falsePositives + matrix.falseNegatives;
+
+    return denominator > 0 ? 2 * matrix.truePositives / denominator : 0;
+}
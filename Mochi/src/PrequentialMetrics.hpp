@@ -0,0 +1,80 @@
+#ifndef PREQUENTIAL_METRICS_H_
+#define PREQUENTIAL_METRICS_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Prequential (test-then-train) evaluation of the models: each training sample is predicted by every model before
+ * the models are updated on it, and the per-model confusion matrices are updated with the predictions.
+ * The balanced accuracy and the F1 score are computed from the confusion matrices, as analyze.py does offline.
+ *
+ * With a fading factor below 1 the confusion matrix counts are multiplied by it before every update, so that the
+ * metrics reflect about the last 1 / (1 - fading factor) samples rather than all the samples since the start.
+ * Updating the metrics is O(1) per model and sample and does not allocate heap memory.
+ */
+class PrequentialMetrics
+{
+public:
+    /* Confusion matrix of a model, the +1 label is the positive class. */
+    struct ConfusionMatrix
+    {
+        double truePositives;
+        double falsePositives;
+        double trueNegatives;
+        double falseNegatives;
+    };
+
+private:
+    double m_fadingFactor;
+    uint64_t m_numSamples;
+    vector<ConfusionMatrix> m_confusionMatrices;
+
+    /* Hide constructor. */
+    PrequentialMetrics() {};
+
+public:
+
+    /* Constructor, a fading factor of 1 (or outside of ]0, 1]) does not fade the counts. */
+    PrequentialMetrics(double fadingFactor);
+
+    /**
+     * Clear the confusion matrices of the given number of models.
+     */
+    void reset(size_t numModels);
+
+    /**
+     * Update the confusion matrices with the predictions of the models for a sample with the given label.
+     * The predictions are in the same order as the models, labels and predictions are +1 or -1.
+     */
+    void update(int label, const vector<pair<string, int>>* pPredictions);
+
+    /**
+     * The number of samples evaluated since the start or the last reset.
+     */
+    uint64_t getNumSamples() const
+    {
+        return m_numSamples;
+    }
+
+    const ConfusionMatrix& getConfusionMatrix(size_t model) const
+    {
+        return m_confusionMatrices[model];
+    }
+
+    /**
+     * Mean of the recalls of the classes seen, 0 before any sample.
+     */
+    double getBalancedAccuracy(size_t model) const;
+
+    /**
+     * Harmonic mean of the precision and the recall of the positive class, 0 without any positive label or prediction.
+     */
+    double getF1Score(size_t model) const;
+};
+
+#endif // PREQUENTIAL_METRICS_H_
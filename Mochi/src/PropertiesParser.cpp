@@ -7,9 +7,36 @@
 const string PropertiesParser::PROPS_PREFIX = "esa.mo.nmf.apps.OrbitAI.";
 const string PropertiesParser::PROPS_PREFIX_MOCHI = PropertiesParser::PROPS_PREFIX + "mochi.";
 const string PropertiesParser::PROPS_LOG_TRAINING_DATA = "log.data.training";
+const string PropertiesParser::PROPS_LOG_FORMAT = "log.format";
+const string PropertiesParser::PROPS_LOG_ROTATE_SIZE = "log.rotate.size";
+const string PropertiesParser::PROPS_LOG_ROTATE_AGE = "log.rotate.age";
+const string PropertiesParser::PROPS_LOG_CAP = "log.cap";
+const string PropertiesParser::PROPS_LOG_COMPRESS = "log.compress";
 const string PropertiesParser::PROPS_PORT_NUMBER  = "port";
+const string PropertiesParser::PROPS_PORT_NUMBER_INFERENCE  = "port.inference";
+const string PropertiesParser::PROPS_PUBLICATION_INTERVAL  = "publish.interval";
 const string PropertiesParser::PROPS_MODE  = "mode";
 const string PropertiesParser::PROPS_INPUTS  = "inputs";
+const string PropertiesParser::PROPS_GROUPS  = "groups";
+const string PropertiesParser::PROPS_GROUP_PREFIX  = "group.";
+const string PropertiesParser::PROPS_GROUP_INPUTS  = ".inputs";
+const string PropertiesParser::PROPS_REPLAY_CAPACITY  = "replay.capacity";
+const string PropertiesParser::PROPS_REPLAY_REHEARSALS  = "replay.rehearsals";
+const string PropertiesParser::PROPS_REPLAY_SEED  = "replay.seed";
+const string PropertiesParser::PROPS_METRICS_PREQUENTIAL  = "metrics.prequential";
+const string PropertiesParser::PROPS_METRICS_FADING  = "metrics.fading";
+const string PropertiesParser::PROPS_METRICS_LOG_INTERVAL  = "metrics.log.interval";
+const string PropertiesParser::PROPS_DRIFT_ACTION  = "drift.action";
+const string PropertiesParser::PROPS_DRIFT_MIN_SAMPLES  = "drift.min.samples";
+const string PropertiesParser::PROPS_EXPORT_QUANTIZE  = "export.quantize";
+const string PropertiesParser::PROPS_INFERENCE_QUANTIZE  = "inference.quantize";
+const string PropertiesParser::PROPS_INFERENCE_QUANTIZE_RANGE  = "inference.quantize.range";
+const string PropertiesParser::PROPS_INFERENCE_CACHE  = "inference.cache";
+const string PropertiesParser::PROPS_INFERENCE_CACHE_RESOLUTION  = "inference.cache.resolution";
+const string PropertiesParser::PROPS_SCHEDULE_TICK  = "schedule.tick";
+const string PropertiesParser::PROPS_SCHEDULE_BUDGET  = "schedule.budget";
+const string PropertiesParser::PROPS_SCHEDULE_QUEUE  = "schedule.queue";
+const string PropertiesParser::PROPS_SCHEDULE_SUBSAMPLE  = "schedule.subsample";
 
 /**
  * Constructor.
@@ -18,20 +45,41 @@ PropertiesParser::PropertiesParser(char* propertiesFilePath)
 {
     loadProperties(propertiesFilePath);
 
-    /* Create string stream from the string of comma separated param names. */
-    string paramNamesString = getProperty<string>(PropertiesParser::PROPS_PREFIX, PropertiesParser::PROPS_INPUTS);
-    stringstream s_stream(paramNamesString);
+    /* Create a vector of param names from the string of comma separated param names. */
+    m_paramNames = splitNames(getProperty<string>(PropertiesParser::PROPS_PREFIX, PropertiesParser::PROPS_INPUTS));
+
+    /* Set dimension class member. */
+    m_dimension = m_paramNames.size();
+
+    /* The feature groups, each with its own comma separated param names. */
+    const string groupNamesString = getProperty<string>(PropertiesParser::PROPS_GROUPS);
+    if(!groupNamesString.empty())
+    {
+        vector<string> groupNames = splitNames(groupNamesString);
+        for(vector<string>::iterator it = groupNames.begin(); it != groupNames.end(); ++it)
+        {
+            const string groupInputs = getProperty<string>(PropertiesParser::PROPS_GROUP_PREFIX + *it + PropertiesParser::PROPS_GROUP_INPUTS);
+            m_featureGroups.push_back(pair<string, vector<string>>(*it, groupInputs.empty() ? vector<string>() : splitNames(groupInputs)));
+        }
+    }
+}
+
+/**
+ * Split a string of comma separated names into a vector of names.
+ */
+vector<string> PropertiesParser::splitNames(const string& namesString)
+{
+    stringstream s_stream(namesString);
+    vector<string> names;
 
-    /* Create a vector of param names. */
     while(s_stream.good())
     {
         string substr;
         getline(s_stream, substr, ',');
-        m_paramNames.push_back(substr);
+        names.push_back(substr);
     }
 
-    /* Set dimension class member. */
-    m_dimension = m_paramNames.size();
+    return names;
 }
 
 /**
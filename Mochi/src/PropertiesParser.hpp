@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <map>
+#include <utility>
 #include <string>
 #include <sstream>
 
@@ -15,11 +16,15 @@ private:
     map<string, string> m_propsMap;
     size_t m_dimension;
     vector<string> m_paramNames;
+    vector<pair<string, vector<string>>> m_featureGroups;
 
     /* Hide constructor */
     PropertiesParser();
 
     void loadProperties(char* propertiesFilePath);
+
+    /* Split a string of comma separated names into a vector of names. */
+    static vector<string> splitNames(const string& namesString);
  
 public:
 
@@ -27,9 +32,36 @@ public:
     static const string PROPS_PREFIX;
     static const string PROPS_PREFIX_MOCHI;
     static const string PROPS_LOG_TRAINING_DATA;
+    static const string PROPS_LOG_FORMAT;
+    static const string PROPS_LOG_ROTATE_SIZE;
+    static const string PROPS_LOG_ROTATE_AGE;
+    static const string PROPS_LOG_CAP;
+    static const string PROPS_LOG_COMPRESS;
     static const string PROPS_PORT_NUMBER;
+    static const string PROPS_PORT_NUMBER_INFERENCE;
+    static const string PROPS_PUBLICATION_INTERVAL;
     static const string PROPS_MODE;
     static const string PROPS_INPUTS;
+    static const string PROPS_GROUPS;
+    static const string PROPS_GROUP_PREFIX;
+    static const string PROPS_GROUP_INPUTS;
+    static const string PROPS_REPLAY_CAPACITY;
+    static const string PROPS_REPLAY_REHEARSALS;
+    static const string PROPS_REPLAY_SEED;
+    static const string PROPS_METRICS_PREQUENTIAL;
+    static const string PROPS_METRICS_FADING;
+    static const string PROPS_METRICS_LOG_INTERVAL;
+    static const string PROPS_DRIFT_ACTION;
+    static const string PROPS_DRIFT_MIN_SAMPLES;
+    static const string PROPS_EXPORT_QUANTIZE;
+    static const string PROPS_INFERENCE_QUANTIZE;
+    static const string PROPS_INFERENCE_QUANTIZE_RANGE;
+    static const string PROPS_INFERENCE_CACHE;
+    static const string PROPS_INFERENCE_CACHE_RESOLUTION;
+    static const string PROPS_SCHEDULE_TICK;
+    static const string PROPS_SCHEDULE_BUDGET;
+    static const string PROPS_SCHEDULE_QUEUE;
+    static const string PROPS_SCHEDULE_SUBSAMPLE;
 
     PropertiesParser(char* propertiesFilePath);
 
@@ -37,7 +69,7 @@ public:
     T getProperty(string prefix, string key)
     {   
         istringstream stringValue(m_propsMap[prefix + key]);
-        T castValue;
+        T castValue = T();
         stringValue >> castValue;
 
         return castValue;
@@ -53,7 +85,7 @@ public:
     T getHyperParameterProperty(string algorithmName, string hyperParamName)
     {
         istringstream stringValue(m_propsMap[PropertiesParser::PROPS_PREFIX_MOCHI + algorithmName + ".hparam." + hyperParamName]);
-        T castValue;
+        T castValue = T();
         stringValue >> castValue;
 
         return castValue;
@@ -64,17 +96,159 @@ public:
         return getProperty<int>(PropertiesParser::PROPS_LOG_TRAINING_DATA);
     }
 
+    /* Get the format of the training and inference logs: csv or binary. */
+    string getLogFormat()
+    {
+        return getProperty<string>(PropertiesParser::PROPS_LOG_FORMAT);
+    }
+
+    /* Get the size in bytes a log file is rotated at, 0 for no rotation by size. */
+    size_t getLogRotateSize()
+    {
+        return getProperty<size_t>(PropertiesParser::PROPS_LOG_ROTATE_SIZE);
+    }
+
+    /* Get the age in seconds a log file is rotated at, 0 for no rotation by age. */
+    long getLogRotateAge()
+    {
+        return getProperty<long>(PropertiesParser::PROPS_LOG_ROTATE_AGE);
+    }
+
+    /* Get the cap in bytes on the files of the logs directory, 0 for no cap. */
+    size_t getLogCap()
+    {
+        return getProperty<size_t>(PropertiesParser::PROPS_LOG_CAP);
+    }
+
+    /* Flag indicating whether or not rotated log files are compressed. */
+    int isLogCompressEnabled()
+    {
+        return getProperty<int>(PropertiesParser::PROPS_LOG_COMPRESS);
+    }
+
     int getPortNumber()
     {
         return getProperty<int>(PropertiesParser::PROPS_PORT_NUMBER);
     }
 
-    /* Get mode: 0 - new training, 1 - continue training, or 2 - inference. */
+    /* Get the port number of the inference requests in the training and inference mode. */
+    int getInferencePortNumber()
+    {
+        return getProperty<int>(PropertiesParser::PROPS_PORT_NUMBER_INFERENCE);
+    }
+
+    /* Get the number of training samples between two publications of the models for inference in the training and inference mode. */
+    size_t getPublicationInterval()
+    {
+        return getProperty<size_t>(PropertiesParser::PROPS_PUBLICATION_INTERVAL);
+    }
+
+    /* Get mode: 0 - new training, 1 - continue training, 2 - inference, or 3 - continue training and inference. */
     int getMode()
     {
         return getProperty<int>(PropertiesParser::PROPS_MODE);
     }
 
+    /* Get the number of samples held per class by the replay buffer, 0 disables it. */
+    size_t getReplayCapacity()
+    {
+        return getProperty<size_t>(PropertiesParser::PROPS_REPLAY_CAPACITY);
+    }
+
+    /* Get the number of rehearsal updates drawn from the replay buffer for each training sample. */
+    size_t getReplayRehearsals()
+    {
+        return getProperty<size_t>(PropertiesParser::PROPS_REPLAY_REHEARSALS);
+    }
+
+    unsigned int getReplaySeed()
+    {
+        return getProperty<unsigned int>(PropertiesParser::PROPS_REPLAY_SEED);
+    }
+
+    int isPrequentialEvaluationEnabled()
+    {
+        return getProperty<int>(PropertiesParser::PROPS_METRICS_PREQUENTIAL);
+    }
+
+    /* Get the fading factor of the prequential metrics, 1 for no fading. */
+    double getMetricsFadingFactor()
+    {
+        return getProperty<double>(PropertiesParser::PROPS_METRICS_FADING);
+    }
+
+    /* Get the number of training samples between two rows of the metrics log, 0 for none. */
+    size_t getMetricsLogInterval()
+    {
+        return getProperty<size_t>(PropertiesParser::PROPS_METRICS_LOG_INTERVAL);
+    }
+
+    /* Get the action taken on a drift: none, log, reset or shadow. */
+    string getDriftAction()
+    {
+        return getProperty<string>(PropertiesParser::PROPS_DRIFT_ACTION);
+    }
+
+    /* Get the number of samples a drift detector has to see before it can detect a drift. */
+    size_t getDriftMinNumSamples()
+    {
+        return getProperty<size_t>(PropertiesParser::PROPS_DRIFT_MIN_SAMPLES);
+    }
+
+    /* Flag indicating whether or not the floating point values of exported model snapshots are quantized to floats. */
+    int isExportQuantizeEnabled()
+    {
+        return getProperty<int>(PropertiesParser::PROPS_EXPORT_QUANTIZE);
+    }
+
+    /* Get the bits of the quantized weights of the linear models in inference mode: 8 or 16, 0 for no quantization. */
+    int getInferenceQuantizeBits()
+    {
+        return getProperty<int>(PropertiesParser::PROPS_INFERENCE_QUANTIZE);
+    }
+
+    /* Get the range of the input values quantized for the quantized models, i.e. the largest input magnitude. */
+    double getInferenceQuantizeRange()
+    {
+        return getProperty<double>(PropertiesParser::PROPS_INFERENCE_QUANTIZE_RANGE);
+    }
+
+    /* Get the number of inference inputs whose predictions are cached, 0 for no cache. */
+    size_t getInferenceCacheCapacity()
+    {
+        return getProperty<size_t>(PropertiesParser::PROPS_INFERENCE_CACHE);
+    }
+
+    /* Get the resolution the input values are quantized to in the keys of the prediction cache, 0 for the exact values. */
+    double getInferenceCacheResolution()
+    {
+        return getProperty<double>(PropertiesParser::PROPS_INFERENCE_CACHE_RESOLUTION);
+    }
+
+    /* Get the length in ms of the ticks the training budget is given for. */
+    long getScheduleTick()
+    {
+        return getProperty<long>(PropertiesParser::PROPS_SCHEDULE_TICK);
+    }
+
+    /* Get the CPU time in ms the training is given per tick, 0 to train the samples as they are received. */
+    long getScheduleBudget()
+    {
+        return getProperty<long>(PropertiesParser::PROPS_SCHEDULE_BUDGET);
+    }
+
+    /* Get the number of training samples the queue holds. */
+    size_t getScheduleQueueCapacity()
+    {
+        return getProperty<size_t>(PropertiesParser::PROPS_SCHEDULE_QUEUE);
+    }
+
+    /* Get the subsampling of the training samples under overload: one in every that many is queued, 0 or 1 for all. */
+    size_t getScheduleSubsample()
+    {
+        return getProperty<size_t>(PropertiesParser::PROPS_SCHEDULE_SUBSAMPLE);
+    }
+
     vector<string>* getInputParamNames()
     {
         return &m_paramNames;
@@ -85,6 +259,12 @@ public:
         return m_dimension;
     }
 
+    /* Get the feature groups: the group names with the names of their input params, empty if no group is set. */
+    const vector<pair<string, vector<string>>>& getFeatureGroups()
+    {
+        return m_featureGroups;
+    }
+
 };
 
 #endif // PROPERTIES_PARSER_H_
\ No newline at end of file
@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+
+#include "HyperParameters.hpp"
+#include "InputParser.hpp"
+#include "QuantizedModel.hpp"
+
+/* Number of tokens of the archive header: "22 serialization::archive 15", then the tracking level and version of the model. */
+#define ARCHIVE_HEADER_NUM_TOKENS       5
+
+/* Largest magnitude of a quantized input. */
+#define INPUT_QUANTIZED_MAX         32767
+
+/**
+ * Position of the weight vector among the vectors of the archive of the given linear model, -1 if it is not linear.
+ */
+static int getWeightVectorIndex(const string& algorithmName)
+{
+    if(algorithmName == HyperParameters::ALGORITHM_NAME_ADAM || algorithmName == HyperParameters::ALGORITHM_NAME_ADAGRAD_RDA
+        || algorithmName == HyperParameters::ALGORITHM_NAME_PA)
+    {
+        return 0;
+    }
+    else if(algorithmName == HyperParameters::ALGORITHM_NAME_AROW || algorithmName == HyperParameters::ALGORITHM_NAME_NHERD
+        || algorithmName == HyperParameters::ALGORITHM_NAME_SCW)
+    {
+        return 1;
+    }
+
+    return -1;
+}
+
+/**
+ * Integer dot product of the quantized weights and inputs, the products fit in 32 bits and their sum in 64 bits.
+ */
+template<typename T>
+static int64_t dot(const T* pWeights, const int16_t* pInputs, size_t dim)
+{
+    int64_t sum = 0;
+    for(size_t i = 0; i < dim; ++i)
+    {
+        sum += static_cast<int32_t>(pWeights[i]) * pInputs[i];
+    }
+
+    return sum;
+}
+
+/**
+ * Quantize the given weights into the given integers with the given scale.
+ */
+template<typename T>
+static void quantize(const vector<double>& weights, double scale, vector<T>* pQuantized)
+{
+    pQuantized->resize(weights.size());
+    for(size_t i = 0; i < weights.size(); ++i)
+    {
+        (*pQuantized)[i] = static_cast<T>(lround(weights[i] / scale));
+    }
+}
+
+/**
+ * Constructor.
+ */
+QuantizedModel::QuantizedModel(const string& name, const string& algorithmName, size_t dim, int bits, double inputRange) :
+    m_name(name),
+    m_algorithmName(algorithmName),
+    m_dim(dim),
+    m_bits(bits),
+    m_weightScale(1),
+    m_inputScale(inputRange / INPUT_QUANTIZED_MAX),
+    m_x(dim, 0),
+    m_xq(dim, 0)
+{
+    if(bits != 8 && bits != 16)
+    {
+        throw invalid_argument("Invalid number of bits of the quantized weights, expected 8 or 16: " + to_string(bits));
+    }
+
+    if(!(inputRange > 0))
+    {
+        throw invalid_argument("Invalid range of the quantized inputs, expected a positive value.");
+    }
+
+    if(getWeightVectorIndex(algorithmName) < 0)
+    {
+        throw invalid_argument("Not a linear model, it cannot be quantized: " + algorithmName);
+    }
+}
+
+/**
+ * Whether the given algorithm is a linear model that can be quantized.
+ */
+bool QuantizedModel::isQuantizable(const string& algorithmName)
+{
+    return getWeightVectorIndex(algorithmName) >= 0;
+}
+
+/**
+ * Quantized models are not trained.
+ */
+void QuantizedModel::train(string* pInput, int dim)
+{
+    throw runtime_error("Quantized model " + m_name + " is inference only.");
+}
+
+/**
+ * Quantized models are not trained.
+ */
+void QuantizedModel::trainAndSave(string* pInput, size_t dim, const string modelFilePath)
+{
+    train(pInput, dim);
+}
+
+/**
+ * Infer/predict the label of the given input with the integer scoring kernel.
+ */
+int QuantizedModel::infer(string* pInput, size_t dim)
+{
+    InputParser::parse(pInput, m_x.data(), m_dim);
+
+    /* Inputs out of the range saturate. */
+    for(size_t i = 0; i < m_dim; ++i)
+    {
+        const double value = round(m_x[i] / m_inputScale);
+        m_xq[i] = static_cast<int16_t>(max(-static_cast<double>(INPUT_QUANTIZED_MAX), min(static_cast<double>(INPUT_QUANTIZED_MAX), value)));
+    }
+
+    const int64_t score = m_bits == 8 ? dot(m_weights8.data(), m_xq.data(), m_dim) : dot(m_weights16.data(), m_xq.data(), m_dim);
+    return score > 0 ? 1 : -1;
+}
+
+/**
+ * Read the weights of the given saved model and quantize them.
+ */
+void QuantizedModel::load(const string modelFilePath)
+{
+    ifstream ifs(modelFilePath);
+    if(!ifs)
+    {
+        throw runtime_error("Failed to open model file: " + modelFilePath);
+    }
+
+    string token;
+    for(size_t i = 0; i < ARCHIVE_HEADER_NUM_TOKENS; ++i)
+    {
+        ifs >> token;
+    }
+
+    /* Each vector is written as its size, the version of its items and its values. */
+    vector<double> weights;
+    const int weightVectorIndex = getWeightVectorIndex(m_algorithmName);
+    for(int vectorIndex = 0; vectorIndex <= weightVectorIndex; ++vectorIndex)
+    {
+        size_t size;
+        unsigned int itemVersion;
+        if(!(ifs >> size >> itemVersion) || size != m_dim)
+        {
+            throw runtime_error("Model file without a weight vector of the input dimension: " + modelFilePath);
+        }
+
+        /* The values are parsed with strtod rather than by the stream, which fails on subnormal values. */
+        weights.resize(size);
+        for(size_t i = 0; i < size; ++i)
+        {
+            char* pEnd = nullptr;
+            if(ifs >> token)
+            {
+                weights[i] = strtod(token.c_str(), &pEnd);
+            }
+
+            if(pEnd == nullptr || *pEnd != '\0')
+            {
+                throw runtime_error("Model file without a weight vector of the input dimension: " + modelFilePath);
+            }
+        }
+    }
+
+    /* The largest weight magnitude maps to the largest quantized weight. */
+    double maxWeight = 0;
+    for(vector<double>::const_iterator it = weights.begin(); it != weights.end(); ++it)
+    {
+        maxWeight = max(maxWeight, fabs(*it));
+    }
+
+    const int maxQuantized = (1 << (m_bits - 1)) - 1;
+    m_weightScale = maxWeight > 0 ? maxWeight / maxQuantized : 1;
+
+    if(m_bits == 8)
+    {
+        quantize(weights, m_weightScale, &m_weights8);
+    }
+    else
+    {
+        quantize(weights, m_weightScale, &m_weights16);
+    }
+}
+
+/**
+ * The saved double model is kept as it is.
+ */
+void QuantizedModel::save(const string modelFilePath)
+{
+}
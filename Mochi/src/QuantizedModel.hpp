@@ -0,0 +1,97 @@
+#ifndef QUANTIZED_MODEL_H_
+#define QUANTIZED_MODEL_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* The Binary Machine Learning Algorithm Factory, for the interface shared with the MochiMochi algorithms. */
+#include <mochimochi/classifier/factory/binary_oml_factory.hpp>
+
+using namespace std;
+
+/**
+ * Inference-only fixed point copy of a linear model, for inference deployments (mode 2) on small processors.
+ *
+ * The weights of a saved linear model are quantized to int8 or int16 with a per-model scale, the largest weight
+ * magnitude mapping to the largest integer. The input values are quantized to int16 over a fixed range shared by the
+ * models. A prediction is the sign of the integer dot product of the quantized weights and inputs, which is the sign
+ * of the double dot product up to the rounding of both, the scales being positive. The MochiMochi linear models
+ * predict the sign of that dot product too, see tools/quantize.py for the parity of both on a validation set.
+ *
+ * The weight vector is read from the Boost text archive of the saved model: it is the first vector of the archive
+ * for ADAM, ADAGRAD_RDA and PA, and the vector of means, following the covariances, for AROW, NHERD and SCW.
+ */
+class QuantizedModel : public BinaryOMLInterface
+{
+private:
+    /* Name of the quantized model, algorithm name and input dimension. */
+    string m_name;
+    string m_algorithmName;
+    size_t m_dim;
+
+    /* Bits of the quantized weights, 8 or 16, and the quantized weights: only the vector of that width is filled. */
+    int m_bits;
+    vector<int8_t> m_weights8;
+    vector<int16_t> m_weights16;
+
+    /* The value of a quantized weight unit, and of a quantized input unit. */
+    double m_weightScale;
+    double m_inputScale;
+
+    /* Input buffers reused by every inference. */
+    vector<double> m_x;
+    vector<int16_t> m_xq;
+
+    /* Hide constructor. */
+    QuantizedModel() {};
+
+public:
+
+    /**
+     * Constructor, the weights are quantized by load(). Inputs are quantized over [-inputRange, inputRange].
+     */
+    QuantizedModel(const string& name, const string& algorithmName, size_t dim, int bits, double inputRange);
+
+    /**
+     * Whether the given algorithm is a linear model that can be quantized.
+     */
+    static bool isQuantizable(const string& algorithmName);
+
+    string name()
+    {
+        return m_name;
+    }
+
+    double getWeightScale()
+    {
+        return m_weightScale;
+    }
+
+    /**
+     * Quantized models are not trained, throws.
+     */
+    void train(string* pInput, int dim);
+
+    /**
+     * Quantized models are not trained, throws.
+     */
+    void trainAndSave(string* pInput, size_t dim, const string modelFilePath);
+
+    /**
+     * Infer/predict the label (+1 or -1) of the given input with the integer scoring kernel.
+     */
+    int infer(string* pInput, size_t dim);
+
+    /**
+     * Read the weights of the given saved model and quantize them.
+     */
+    void load(const string modelFilePath);
+
+    /**
+     * The saved double model is kept as it is, nothing is saved.
+     */
+    void save(const string modelFilePath);
+};
+
+#endif // QUANTIZED_MODEL_H_
@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <unistd.h>
+
+#include "InputParser.hpp"
+#include "MappedFile.hpp"
+#include "ReplayBuffer.hpp"
+
+/* Identifies a saved replay buffer and its format version. */
+static const char REPLAY_BUFFER_MAGIC[8] = {'O', 'A', 'I', 'R', 'P', 'L', 'Y', '1'};
+
+/**
+ * Constructor, a capacity of 0 disables the buffer.
+ */
+ReplayBuffer::ReplayBuffer(size_t dim, size_t capacity, size_t numRehearsals, unsigned int seed) :
+    m_dim(dim),
+    m_capacity(capacity),
+    m_numRehearsals(numRehearsals),
+    m_values(2 * capacity * dim),
+    m_rng(seed),
+    m_fd(-1)
+{
+    m_numSeen[0] = m_numSeen[1] = 0;
+    m_size[0] = m_size[1] = 0;
+}
+
+/**
+ * Destructor.
+ */
+ReplayBuffer::~ReplayBuffer()
+{
+    close();
+}
+
+/**
+ * Offer a training input such as "+1 1:1.232 2:2.412" to the reservoir of its class.
+ */
+void ReplayBuffer::add(const string* pInput)
+{
+    if(!isEnabled())
+    {
+        return;
+    }
+
+    /* The label comes first. */
+    const char* pCursor = pInput->c_str();
+    char* pEnd;
+    const long label = strtol(pCursor, &pEnd, 10);
+    if(pEnd == pCursor)
+    {
+        throw invalid_argument("Missing label in input: " + *pInput);
+    }
+
+    /* Reservoir sampling: the n-th sample of a class replaces a random held one with probability capacity / n. */
+    const int classIndex = label > 0 ? 1 : 0;
+    const uint64_t numSeen = ++m_numSeen[classIndex];
+
+    size_t slot;
+    if(m_size[classIndex] < m_capacity)
+    {
+        slot = m_size[classIndex]++;
+    }
+    else
+    {
+        const uint64_t draw = uniform_int_distribution<uint64_t>(0, numSeen - 1)(m_rng);
+        if(draw >= m_capacity)
+        {
+            return;
+        }
+        slot = static_cast<size_t>(draw);
+    }
+
+    /* The label is parsed again with the values, a dense input is written in place. */
+    InputParser::parse(pInput, &m_values[(classIndex * m_capacity + slot) * m_dim], m_dim);
+}
+
+/**
+ * Write a random sample of the minority class into the given input string in the training input format.
+ */
+bool ReplayBuffer::drawMinority(string* pInput)
+{
+    if(m_numSeen[0] == m_numSeen[1])
+    {
+        return false;
+    }
+
+    const int classIndex = m_numSeen[0] < m_numSeen[1] ? 0 : 1;
+    if(m_size[classIndex] == 0)
+    {
+        return false;
+    }
+
+    const size_t slot = uniform_int_distribution<size_t>(0, m_size[classIndex] - 1)(m_rng);
+    const double* pValues = &m_values[(classIndex * m_capacity + slot) * m_dim];
+
+    /* Values are written with enough digits to be read back exactly. */
+    char value[64];
+    pInput->assign(classIndex == 1 ? "+1" : "-1");
+    for(size_t i = 0; i < m_dim; ++i)
+    {
+        const int length = snprintf(value, sizeof(value), " %zu:%.17g", i + 1, pValues[i]);
+        pInput->append(value, length);
+    }
+
+    return true;
+}
+
+/**
+ * Load the buffer saved in the given file.
+ */
+bool ReplayBuffer::load(const string& filePath)
+{
+    MappedFile file(filePath);
+
+    FileHeader header;
+    if(file.getSize() < sizeof(header))
+    {
+        throw runtime_error("Truncated replay buffer file: " + filePath);
+    }
+    memcpy(&header, file.getData(), sizeof(header));
+
+    if(memcmp(header.magic, REPLAY_BUFFER_MAGIC, sizeof(header.magic)) != 0)
+    {
+        throw runtime_error("Not a replay buffer file: " + filePath);
+    }
+
+    /* The buffer is sized by the properties, it cannot hold a buffer saved with other ones. */
+    if(header.dim != m_dim || header.capacity != m_capacity)
+    {
+        return false;
+    }
+
+    if(header.size[0] > m_capacity || header.size[1] > m_capacity
+        || file.getSize() != sizeof(header) + m_values.size() * sizeof(double))
+    {
+        throw runtime_error("Corrupted replay buffer file: " + filePath);
+    }
+
+    for(int classIndex = 0; classIndex < 2; ++classIndex)
+    {
+        m_numSeen[classIndex] = header.numSeen[classIndex];
+        m_size[classIndex] = static_cast<size_t>(header.size[classIndex]);
+    }
+    memcpy(m_values.data(), file.getData() + sizeof(header), m_values.size() * sizeof(double));
+
+    return true;
+}
+
+/**
+ * Save the buffer to the given file. The file stays open for the next saves.
+ */
+void ReplayBuffer::save(const string& filePath)
+{
+    if(m_fd < 0 || m_filePath != filePath)
+    {
+        close();
+
+        m_fd = open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if(m_fd < 0)
+        {
+            throw runtime_error("Failed to open replay buffer file: " + filePath);
+        }
+        m_filePath = filePath;
+    }
+
+    FileHeader header;
+    memcpy(header.magic, REPLAY_BUFFER_MAGIC, sizeof(header.magic));
+    header.dim = m_dim;
+    header.capacity = m_capacity;
+    for(int classIndex = 0; classIndex < 2; ++classIndex)
+    {
+        header.numSeen[classIndex] = m_numSeen[classIndex];
+        header.size[classIndex] = m_size[classIndex];
+    }
+
+    /* The file always has the same size, it is overwritten in place. */
+    const size_t valuesSize = m_values.size() * sizeof(double);
+    if(pwrite(m_fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))
+        || pwrite(m_fd, m_values.data(), valuesSize, sizeof(header)) != static_cast<ssize_t>(valuesSize))
+    {
+        throw runtime_error("Failed to write replay buffer file: " + filePath);
+    }
+}
+
+/**
+ * Close the saved buffer file, e.g. before deleting it. The next save opens it again.
+ */
+void ReplayBuffer::close()
+{
+    if(m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+/**
+ * Drop all the samples held and seen.
+ */
+void ReplayBuffer::clear()
+{
+    m_numSeen[0] = m_numSeen[1] = 0;
+    m_size[0] = m_size[1] = 0;
+    fill(m_values.begin(), m_values.end(), 0.0);
+}
@@ -0,0 +1,111 @@
+#ifndef REPLAY_BUFFER_H_
+#define REPLAY_BUFFER_H_
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * A fixed-memory, class-balanced replay buffer of training samples.
+ * Each of the two classes has its own reservoir of the same capacity, holding a uniform random sample of all the
+ * samples of that class seen so far, so that the rarer class is not crowded out by the more frequent one.
+ * The samples of the minority class are drawn from it for rehearsal training.
+ *
+ * The input values are stored as doubles, the memory used is 2 * capacity * dim * 8 bytes whatever the number of
+ * samples seen. Adding, drawing and saving samples do not allocate heap memory.
+ */
+class ReplayBuffer
+{
+private:
+    /* Header of the saved buffer, followed by the values of both reservoirs. */
+    struct FileHeader
+    {
+        char magic[8];
+        uint64_t dim;
+        uint64_t capacity;
+        uint64_t numSeen[2];
+        uint64_t size[2];
+    };
+
+    size_t m_dim;
+    size_t m_capacity;
+    size_t m_numRehearsals;
+
+    /* Per class, index 0 for the -1 label and 1 for the +1 label: the samples seen and the samples held. */
+    uint64_t m_numSeen[2];
+    size_t m_size[2];
+
+    /* The input values of the samples held, capacity * dim values per class. */
+    vector<double> m_values;
+
+    /* Random number generator of the reservoir sampling and of the rehearsal draws. */
+    mt19937 m_rng;
+
+    /* The saved buffer file, kept open so that saving after every sample does not allocate. */
+    string m_filePath;
+    int m_fd;
+
+    /* Hide constructor. */
+    ReplayBuffer() {};
+
+public:
+
+    /* Constructor, a capacity of 0 disables the buffer. */
+    ReplayBuffer(size_t dim, size_t capacity, size_t numRehearsals, unsigned int seed);
+
+    /* Destructor. */
+    ~ReplayBuffer();
+
+    ReplayBuffer(const ReplayBuffer&) = delete;
+    ReplayBuffer& operator=(const ReplayBuffer&) = delete;
+
+    bool isEnabled() const
+    {
+        return m_capacity > 0;
+    }
+
+    /**
+     * The number of rehearsal updates triggered by each new training sample.
+     */
+    size_t getNumRehearsals() const
+    {
+        return m_numRehearsals;
+    }
+
+    /**
+     * Offer a training input such as "+1 1:1.232 2:2.412" to the reservoir of its class.
+     */
+    void add(const string* pInput);
+
+    /**
+     * Write a random sample of the minority class, the class with fewer samples seen, into the given input string
+     * in the training input format. Returns false if the classes are balanced or the minority reservoir is empty.
+     */
+    bool drawMinority(string* pInput);
+
+    /**
+     * Load the buffer saved in the given file.
+     * Returns false, leaving the buffer empty, if it was saved with another input dimension or capacity.
+     */
+    bool load(const string& filePath);
+
+    /**
+     * Save the buffer to the given file. The file stays open for the next saves.
+     */
+    void save(const string& filePath);
+
+    /**
+     * Close the saved buffer file, e.g. before deleting it. The next save opens it again.
+     */
+    void close();
+
+    /**
+     * Drop all the samples held and seen, the memory is kept for the next samples.
+     */
+    void clear();
+};
+
+#endif // REPLAY_BUFFER_H_
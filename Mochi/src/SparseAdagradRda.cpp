@@ -0,0 +1,79 @@
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include "SparseAdagradRda.hpp"
+
+/**
+ * Constructor.
+ */
+SparseAdagradRda::SparseAdagradRda(size_t dim, double eta, double lambda) :
+    SparseLinearModel(dim),
+    m_eta(eta),
+    m_lambda(lambda),
+    m_gradientSums(dim, 0),
+    m_squaredGradientSums(dim, 0)
+{
+}
+
+/**
+ * The weight of the given feature after the latest update, with the L1 regularization of the updates it was left out of.
+ */
+double SparseAdagradRda::weight(size_t index)
+{
+    const double gradientSum = m_gradientSums[index];
+    const double truncatedSum = fabs(gradientSum) - m_lambda * m_timestep;
+    if(truncatedSum <= 0 || m_squaredGradientSums[index] == 0)
+    {
+        return 0;
+    }
+
+    return (gradientSum > 0 ? -m_eta : m_eta) * truncatedSum / sqrt(m_squaredGradientSums[index]);
+}
+
+/**
+ * Add the given gradient to the sums of the given feature.
+ */
+void SparseAdagradRda::update(size_t index, double gradient)
+{
+    m_gradientSums[index] += gradient;
+    m_squaredGradientSums[index] += gradient * gradient;
+}
+
+/**
+ * Load a saved/serialized model.
+ */
+void SparseAdagradRda::load(const string modelFilePath)
+{
+    ifstream ifs(modelFilePath);
+    boost::archive::text_iarchive ia(ifs);
+
+    uint64_t timestep;
+    vector<double> gradientSums;
+    vector<double> squaredGradientSums;
+    ia >> timestep >> gradientSums >> squaredGradientSums;
+
+    if(gradientSums.size() != m_dim || squaredGradientSums.size() != m_dim)
+    {
+        throw runtime_error("Model file of another input dimension: " + modelFilePath);
+    }
+
+    m_timestep = timestep;
+    m_gradientSums.swap(gradientSums);
+    m_squaredGradientSums.swap(squaredGradientSums);
+}
+
+/**
+ * Save/serialize the trained model.
+ */
+void SparseAdagradRda::save(const string modelFilePath)
+{
+    ofstream ofs(modelFilePath);
+    boost::archive::text_oarchive oa(ofs);
+
+    oa << m_timestep << m_gradientSums << m_squaredGradientSums;
+}
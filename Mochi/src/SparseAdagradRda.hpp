@@ -0,0 +1,60 @@
+#ifndef SPARSE_ADAGRAD_RDA_H_
+#define SPARSE_ADAGRAD_RDA_H_
+
+#include <string>
+#include <vector>
+
+#include "SparseLinearModel.hpp"
+
+using namespace std;
+
+/**
+ * ADAGRAD with L1 regularized dual averaging (RDA) for high-dimensional sparse inputs.
+ *
+ * The weight of a feature is a closed form of the sum and the sum of squares of its gradients and of the number of
+ * updates t: w = -sign(g) * eta * (|g| - lambda * t) / sqrt(h), or 0 while |g| <= lambda * t. Only the sums of the
+ * features of a sample change when it is learned, so the weights are computed just in time from the sums when they
+ * are read: the L1 regularization of every other weight is applied lazily yet exactly, the weights being those of the
+ * dense update that recomputes all of them after every sample.
+ */
+class SparseAdagradRda : public SparseLinearModel
+{
+private:
+    /* Hyperparameters. */
+    double m_eta;
+    double m_lambda;
+
+    /* Per feature, the sum of the gradients and the sum of their squares. */
+    vector<double> m_gradientSums;
+    vector<double> m_squaredGradientSums;
+
+    /* Hide constructor. */
+    SparseAdagradRda() : SparseLinearModel(0) {};
+
+protected:
+    double weight(size_t index);
+
+    void update(size_t index, double gradient);
+
+public:
+
+    /* Constructor. */
+    SparseAdagradRda(size_t dim, double eta, double lambda);
+
+    string name()
+    {
+        return string("SPARSE_ADAGRAD_RDA");
+    }
+
+    /**
+     * Load a saved/serialized model.
+     */
+    void load(const string modelFilePath);
+
+    /**
+     * Save/serialize the trained model.
+     */
+    void save(const string modelFilePath);
+};
+
+#endif // SPARSE_ADAGRAD_RDA_H_
@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include "SparseAdam.hpp"
+
+/* Step size, decay rates of the moment estimates and epsilon, as recommended in the Adam paper. */
+#define ADAM_ALPHA                                            0.001
+#define ADAM_BETA1                                              0.9
+#define ADAM_BETA2                                            0.999
+#define ADAM_EPSILON                                           1e-8
+
+/* Skipped updates replayed one by one when a feature is brought up to date, the steps of the later ones are summed up. */
+#define ADAM_CATCH_UP_NUM_REPLAYED                               64
+
+/**
+ * Constructor.
+ */
+SparseAdam::SparseAdam(size_t dim) :
+    SparseLinearModel(dim),
+    m_weights(dim, 0),
+    m_firstMoments(dim, 0),
+    m_secondMoments(dim, 0),
+    m_timesteps(dim, 0),
+    m_firstBiasCorrection(0),
+    m_secondBiasCorrection(0),
+    m_biasCorrectionTimestep(0)
+{
+}
+
+/**
+ * Compute the bias corrections of the latest update, unless they already are.
+ */
+void SparseAdam::updateBiasCorrections()
+{
+    if(m_biasCorrectionTimestep == m_timestep)
+    {
+        return;
+    }
+
+    m_firstBiasCorrection = 1 - pow(ADAM_BETA1, static_cast<double>(m_timestep));
+    m_secondBiasCorrection = 1 - pow(ADAM_BETA2, static_cast<double>(m_timestep));
+    m_biasCorrectionTimestep = m_timestep;
+}
+
+/**
+ * Bring the given feature up to date with the given update.
+ */
+void SparseAdam::catchUp(size_t index, uint64_t timestep)
+{
+    const uint64_t numSkipped = timestep - m_timesteps[index];
+    if(numSkipped == 0)
+    {
+        return;
+    }
+
+    double firstMoment = m_firstMoments[index];
+    double secondMoment = m_secondMoments[index];
+
+    if(secondMoment > 0)
+    {
+        /* The first skipped updates are replayed as the dense update makes them, with a zero gradient. */
+        const uint64_t numReplayed = min(numSkipped, static_cast<uint64_t>(ADAM_CATCH_UP_NUM_REPLAYED));
+        double firstBetaPower = pow(ADAM_BETA1, static_cast<double>(m_timesteps[index]));
+        double secondBetaPower = pow(ADAM_BETA2, static_cast<double>(m_timesteps[index]));
+        for(uint64_t j = 0; j < numReplayed; ++j)
+        {
+            firstMoment *= ADAM_BETA1;
+            secondMoment *= ADAM_BETA2;
+            firstBetaPower *= ADAM_BETA1;
+            secondBetaPower *= ADAM_BETA2;
+            m_weights[index] -= ADAM_ALPHA * (firstMoment / (1 - firstBetaPower))
+                / (sqrt(secondMoment / (1 - secondBetaPower)) + ADAM_EPSILON);
+        }
+
+        /**
+         * The steps of the remaining ones are alpha * m / sqrt(v) * (beta1 / sqrt(beta2))^j after j of them, taking the
+         * bias corrections of the latest update and neglecting epsilon: a geometric series, added up in closed form.
+         */
+        const uint64_t numRemaining = numSkipped - numReplayed;
+        if(numRemaining > 0)
+        {
+            updateBiasCorrections();
+
+            const double ratio = ADAM_BETA1 / sqrt(ADAM_BETA2);
+            const double sum = ratio * (1 - pow(ratio, static_cast<double>(numRemaining))) / (1 - ratio);
+            m_weights[index] -= ADAM_ALPHA * firstMoment / sqrt(secondMoment)
+                * sqrt(m_secondBiasCorrection) / m_firstBiasCorrection * sum;
+
+            firstMoment *= pow(ADAM_BETA1, static_cast<double>(numRemaining));
+            secondMoment *= pow(ADAM_BETA2, static_cast<double>(numRemaining));
+        }
+    }
+
+    m_firstMoments[index] = firstMoment;
+    m_secondMoments[index] = secondMoment;
+    m_timesteps[index] = timestep;
+}
+
+/**
+ * The weight of the given feature after the latest update, with the updates it was left out of applied.
+ */
+double SparseAdam::weight(size_t index)
+{
+    catchUp(index, m_timestep);
+    return m_weights[index];
+}
+
+/**
+ * Update the weight of the given feature with the given gradient, as the dense update does.
+ */
+void SparseAdam::update(size_t index, double gradient)
+{
+    catchUp(index, m_timestep - 1);
+    updateBiasCorrections();
+
+    double& firstMoment = m_firstMoments[index];
+    double& secondMoment = m_secondMoments[index];
+    firstMoment = ADAM_BETA1 * firstMoment + (1 - ADAM_BETA1) * gradient;
+    secondMoment = ADAM_BETA2 * secondMoment + (1 - ADAM_BETA2) * gradient * gradient;
+
+    m_weights[index] -= ADAM_ALPHA * (firstMoment / m_firstBiasCorrection)
+        / (sqrt(secondMoment / m_secondBiasCorrection) + ADAM_EPSILON);
+    m_timesteps[index] = m_timestep;
+}
+
+/**
+ * Load a saved/serialized model.
+ */
+void SparseAdam::load(const string modelFilePath)
+{
+    ifstream ifs(modelFilePath);
+    boost::archive::text_iarchive ia(ifs);
+
+    uint64_t timestep;
+    vector<double> weights;
+    vector<double> firstMoments;
+    vector<double> secondMoments;
+    vector<uint64_t> timesteps;
+    ia >> timestep >> weights >> firstMoments >> secondMoments >> timesteps;
+
+    if(weights.size() != m_dim || firstMoments.size() != m_dim || secondMoments.size() != m_dim || timesteps.size() != m_dim)
+    {
+        throw runtime_error("Model file of another input dimension: " + modelFilePath);
+    }
+
+    m_timestep = timestep;
+    m_weights.swap(weights);
+    m_firstMoments.swap(firstMoments);
+    m_secondMoments.swap(secondMoments);
+    m_timesteps.swap(timesteps);
+    updateBiasCorrections();
+}
+
+/**
+ * Save/serialize the trained model, the features are saved as they are and brought up to date after loading.
+ */
+void SparseAdam::save(const string modelFilePath)
+{
+    ofstream ofs(modelFilePath);
+    boost::archive::text_oarchive oa(ofs);
+
+    oa << m_timestep << m_weights << m_firstMoments << m_secondMoments << m_timesteps;
+}
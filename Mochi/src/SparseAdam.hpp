@@ -0,0 +1,74 @@
+#ifndef SPARSE_ADAM_H_
+#define SPARSE_ADAM_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SparseLinearModel.hpp"
+
+using namespace std;
+
+/**
+ * ADAM for high-dimensional sparse inputs, with the step size and decay rates of the Adam paper.
+ *
+ * In the dense update every weight keeps moving after an update that left its feature out, driven by its decaying
+ * moment estimates. Here a feature is brought up to date just in time, when its weight is next read: the first 64
+ * updates it was left out of are replayed with a zero gradient, as the dense update makes them, and the steps of the
+ * later ones, whose moment estimates have decayed by then, are added up in closed form as a geometric series. The
+ * weights are those of the dense update, up to the bias corrections and epsilon neglected in that sum.
+ */
+class SparseAdam : public SparseLinearModel
+{
+private:
+    /* Per feature, the weight, the first and second moment estimates, and the update they are up to date with. */
+    vector<double> m_weights;
+    vector<double> m_firstMoments;
+    vector<double> m_secondMoments;
+    vector<uint64_t> m_timesteps;
+
+    /* Bias corrections of the moment estimates, and the update they were computed for. */
+    double m_firstBiasCorrection;
+    double m_secondBiasCorrection;
+    uint64_t m_biasCorrectionTimestep;
+
+    /**
+     * Bring the given feature up to date with the given update, from the update it was last up to date with.
+     */
+    void catchUp(size_t index, uint64_t timestep);
+
+    /**
+     * Compute the bias corrections of the latest update, unless they already are.
+     */
+    void updateBiasCorrections();
+
+    /* Hide constructor. */
+    SparseAdam() : SparseLinearModel(0) {};
+
+protected:
+    double weight(size_t index);
+
+    void update(size_t index, double gradient);
+
+public:
+
+    /* Constructor. */
+    SparseAdam(size_t dim);
+
+    string name()
+    {
+        return string("SPARSE_ADAM");
+    }
+
+    /**
+     * Load a saved/serialized model.
+     */
+    void load(const string modelFilePath);
+
+    /**
+     * Save/serialize the trained model.
+     */
+    void save(const string modelFilePath);
+};
+
+#endif // SPARSE_ADAM_H_
@@ -0,0 +1,76 @@
+#include "InputParser.hpp"
+#include "SparseLinearModel.hpp"
+
+/**
+ * Constructor.
+ */
+SparseLinearModel::SparseLinearModel(size_t dim) :
+    m_indices(dim, 0),
+    m_values(dim, 0),
+    m_numValues(0),
+    m_dim(dim),
+    m_timestep(0)
+{
+}
+
+/**
+ * Parse the given input into its non-zero values and return its label.
+ */
+int SparseLinearModel::parse(string* pInput)
+{
+    const long label = InputParser::parseSparse(pInput, m_indices.data(), m_values.data(), m_dim, &m_numValues);
+    return label > 0 ? 1 : -1;
+}
+
+/**
+ * The dot product of the weights and the latest parsed input.
+ */
+double SparseLinearModel::margin()
+{
+    double sum = 0;
+    for(size_t i = 0; i < m_numValues; ++i)
+    {
+        sum += weight(m_indices[i]) * m_values[i];
+    }
+
+    return sum;
+}
+
+/**
+ * Train/update the model with the given training input.
+ */
+void SparseLinearModel::train(string* pInput, int dim)
+{
+    const int label = parse(pInput);
+
+    /* No update without hinge loss. */
+    if(label * margin() >= 1)
+    {
+        return;
+    }
+
+    /* The gradient of the hinge loss is -y * x, zero for the features that are not in the input. */
+    m_timestep++;
+    for(size_t i = 0; i < m_numValues; ++i)
+    {
+        update(m_indices[i], -label * m_values[i]);
+    }
+}
+
+/**
+ * Train/update the model with the given training input and save/serialize the model.
+ */
+void SparseLinearModel::trainAndSave(string* pInput, size_t dim, const string modelFilePath)
+{
+    train(pInput, dim);
+    save(modelFilePath);
+}
+
+/**
+ * Infer/predict the label of the given input.
+ */
+int SparseLinearModel::infer(string* pInput, size_t dim)
+{
+    parse(pInput);
+    return margin() > 0 ? 1 : -1;
+}
@@ -0,0 +1,78 @@
+#ifndef SPARSE_LINEAR_MODEL_H_
+#define SPARSE_LINEAR_MODEL_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* The Binary Machine Learning Algorithm Factory, for the interface shared with the MochiMochi algorithms. */
+#include <mochimochi/classifier/factory/binary_oml_factory.hpp>
+
+using namespace std;
+
+/**
+ * Linear binary classifier trained on the hinge loss, for high-dimensional sparse inputs such as hashed or expanded
+ * features. Training and inferring only touch the features with a non-zero value in the input, so that their cost
+ * scales with the number of non-zero values rather than with the input dimension.
+ *
+ * An update is made for every training sample whose margin y * w.x is below 1. The features left out of an update
+ * would have had a zero gradient, and the optimizers derived from this class apply such updates just in time, when the
+ * weight of a feature is next read, instead of on every update.
+ */
+class SparseLinearModel : public BinaryOMLInterface
+{
+private:
+    /* The non-zero values of the latest parsed input and their indices, from 0, allocated once. */
+    vector<size_t> m_indices;
+    vector<double> m_values;
+    size_t m_numValues;
+
+    /**
+     * Parse the given input into its non-zero values and return its label, +1 or -1.
+     */
+    int parse(string* pInput);
+
+    /**
+     * The dot product of the weights and the latest parsed input.
+     */
+    double margin();
+
+protected:
+    /* Input dimension. */
+    size_t m_dim;
+
+    /* Number of updates made so far. */
+    uint64_t m_timestep;
+
+    /**
+     * The weight of the given feature after the latest update, with the updates it was left out of applied.
+     */
+    virtual double weight(size_t index) = 0;
+
+    /**
+     * Update the weight of the given feature with the given hinge loss gradient, m_timestep being the update number.
+     */
+    virtual void update(size_t index, double gradient) = 0;
+
+    /* Constructor. */
+    SparseLinearModel(size_t dim);
+
+public:
+
+    /**
+     * Train/update the model with the given training input.
+     */
+    void train(string* pInput, int dim);
+
+    /**
+     * Train/update the model with the given training input and save/serialize the model.
+     */
+    void trainAndSave(string* pInput, size_t dim, const string modelFilePath);
+
+    /**
+     * Infer/predict the label (+1 or -1) of the given input, the sign of the dot product of the weights and the input.
+     */
+    int infer(string* pInput, size_t dim);
+};
+
+#endif // SPARSE_LINEAR_MODEL_H_
@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <stdexcept>
+
+#include "Constants.hpp"
+#include "Utils.hpp"
+#include "TrainingScheduler.hpp"
+
+#define NS_PER_MS                                           1000000
+
+/**
+ * Read the given clock in ns.
+ */
+static int64_t now(clockid_t clock)
+{
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * Constructor.
+ */
+TrainingScheduler::TrainingScheduler(long tickLength, long budget, size_t capacity, size_t subsample) :
+    m_tickLength(static_cast<int64_t>(tickLength) * NS_PER_MS),
+    m_budget(static_cast<int64_t>(budget) * NS_PER_MS),
+    m_subsample(subsample),
+    m_head(0),
+    m_size(0),
+    m_tickStart(now(CLOCK_MONOTONIC)),
+    m_tickCpuTime(0),
+    m_trainingStart(0),
+    m_overloaded(false),
+    m_numSkipped(0),
+    m_numReceived(0),
+    m_numTrained(0),
+    m_numShed(0),
+    m_numSubsampled(0),
+    m_numTicks(0),
+    m_numOverloadedTicks(0),
+    m_maxSize(0),
+    m_cpuTime(0)
+{
+    if(budget < 0)
+    {
+        throw invalid_argument("Invalid training budget, expected 0 or a positive number of ms: " + to_string(budget));
+    }
+
+    if(!isEnabled())
+    {
+        return;
+    }
+
+    if(tickLength < budget)
+    {
+        throw invalid_argument("Invalid training tick, expected at least the " + to_string(budget) + " ms of the training budget: " + to_string(tickLength));
+    }
+
+    if(capacity == 0)
+    {
+        throw invalid_argument("Invalid training queue capacity, expected at least 1 sample.");
+    }
+
+    /* Allocated once, a queued input is never longer than the command it is extracted from. */
+    m_queue.resize(capacity);
+    for(vector<string>::iterator it = m_queue.begin(); it != m_queue.end(); ++it)
+    {
+        it->reserve(COMMAND_BUFFER_LENGTH);
+    }
+}
+
+/**
+ * Start a new tick if the current one is over.
+ */
+void TrainingScheduler::updateTick()
+{
+    const int64_t elapsed = now(CLOCK_MONOTONIC) - m_tickStart;
+    if(elapsed < m_tickLength)
+    {
+        return;
+    }
+
+    /* The tick that is over is overloaded if it spent its budget without emptying the queue, the ticks that followed it while the server was busy are not. */
+    m_overloaded = m_tickCpuTime >= m_budget && m_size > 0;
+    if(m_overloaded)
+    {
+        m_numOverloadedTicks++;
+    }
+
+    const int64_t numTicks = elapsed / m_tickLength;
+    m_numTicks += numTicks;
+    m_tickStart += numTicks * m_tickLength;
+    m_tickCpuTime = 0;
+}
+
+/**
+ * Queue the given training input, or subsample it out under overload.
+ */
+void TrainingScheduler::enqueue(const string* pInput)
+{
+    updateTick();
+    m_numReceived++;
+
+    if(m_overloaded && m_subsample > 1)
+    {
+        if(++m_numSkipped < m_subsample)
+        {
+            m_numSubsampled++;
+            return;
+        }
+    }
+    m_numSkipped = 0;
+
+    /* The oldest sample is shed rather than the new one, the freshest samples matter most to track the conditions. */
+    if(m_size == m_queue.size())
+    {
+        m_head = (m_head + 1) % m_queue.size();
+        m_size--;
+        m_numShed++;
+    }
+
+    m_queue[(m_head + m_size) % m_queue.size()].assign(*pInput);
+    m_size++;
+    m_maxSize = max(m_maxSize, m_size);
+}
+
+/**
+ * The oldest queued training input, if it can be trained.
+ */
+string* TrainingScheduler::beginTraining(bool ignoreBudget)
+{
+    updateTick();
+
+    if(m_size == 0 || (!ignoreBudget && m_tickCpuTime >= m_budget))
+    {
+        return nullptr;
+    }
+
+    m_trainingStart = now(CLOCK_THREAD_CPUTIME_ID);
+    return &m_queue[m_head];
+}
+
+/**
+ * Release the trained input and charge its training CPU time to the budget.
+ */
+void TrainingScheduler::endTraining()
+{
+    const int64_t cpuTime = now(CLOCK_THREAD_CPUTIME_ID) - m_trainingStart;
+    m_tickCpuTime += cpuTime;
+    m_cpuTime += cpuTime;
+
+    m_head = (m_head + 1) % m_queue.size();
+    m_size--;
+    m_numTrained++;
+}
+
+/**
+ * Shed all the queued samples.
+ */
+void TrainingScheduler::clear()
+{
+    m_numShed += m_size;
+    m_head = 0;
+    m_size = 0;
+}
+
+/**
+ * How long to wait for a command before training the next queued sample, in ms.
+ */
+int TrainingScheduler::getTimeout()
+{
+    updateTick();
+
+    if(m_size == 0)
+    {
+        return -1;
+    }
+    else if(m_tickCpuTime < m_budget)
+    {
+        return 0;
+    }
+
+    /* Rounded up, so that the wait does not end just before the next tick. */
+    const int64_t remaining = m_tickStart + m_tickLength - now(CLOCK_MONOTONIC);
+    return static_cast<int>(max(static_cast<int64_t>(1), (remaining + NS_PER_MS - 1) / NS_PER_MS));
+}
+
+/**
+ * Log the stats of the scheduling decisions.
+ */
+void TrainingScheduler::logStats()
+{
+    if(!isEnabled())
+    {
+        logInfo("Training scheduler disabled, the training samples are trained as they are received.");
+        return;
+    }
+
+    char cpuTime[32];
+    snprintf(cpuTime, sizeof(cpuTime), "%.3f", static_cast<double>(m_cpuTime) / 1e9);
+
+    logInfo("Training scheduler: " + to_string(m_numReceived) + " samples received, " + to_string(m_numTrained) + " trained, "
+        + to_string(m_numShed) + " shed, " + to_string(m_numSubsampled) + " subsampled, " + to_string(m_size) + " queued (at most "
+        + to_string(m_maxSize) + "), " + to_string(m_numOverloadedTicks) + " of " + to_string(m_numTicks) + " ticks overloaded, "
+        + cpuTime + " s of CPU time training");
+}
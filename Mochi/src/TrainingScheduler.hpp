@@ -0,0 +1,112 @@
+#ifndef TRAINING_SCHEDULER_H_
+#define TRAINING_SCHEDULER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Schedules the training under CPU contention with the other experiments, so that the training never delays the
+ * commands, e.g. inference requests, received on the same connection.
+ *
+ * The training samples are queued in a bounded ring of inputs allocated once, and trained one at a time while the
+ * training has CPU budget left in the current tick. The CPU time is that of the server thread, so the time the thread
+ * waits for the CPU while the other experiments run is not charged to the budget. The server processes every pending
+ * command before training the next queued sample.
+ *
+ * A sample received while the queue is full sheds the oldest queued sample. A tick that ends with its budget spent
+ * and samples still queued is overloaded: while the previous tick was overloaded, only one in every subsample received
+ * training samples is queued, the others are subsampled out.
+ */
+class TrainingScheduler
+{
+private:
+    /* Length of a tick and CPU budget of the training per tick, in ns. A budget of 0 disables the scheduler. */
+    int64_t m_tickLength;
+    int64_t m_budget;
+
+    /* One in every m_subsample training samples is queued under overload, 0 or 1 to queue them all. */
+    size_t m_subsample;
+
+    /* Ring of the queued training inputs, allocated once: the oldest is at m_head. */
+    vector<string> m_queue;
+    size_t m_head;
+    size_t m_size;
+
+    /* Start of the current tick on the monotonic clock, and CPU time spent training in it, in ns. */
+    int64_t m_tickStart;
+    int64_t m_tickCpuTime;
+
+    /* Thread CPU time at the start of the training of the oldest queued sample, in ns. */
+    int64_t m_trainingStart;
+
+    /* Whether the previous tick was overloaded, and the samples received since the last one queued under overload. */
+    bool m_overloaded;
+    size_t m_numSkipped;
+
+    /* Stats of the scheduling decisions. */
+    uint64_t m_numReceived;
+    uint64_t m_numTrained;
+    uint64_t m_numShed;
+    uint64_t m_numSubsampled;
+    uint64_t m_numTicks;
+    uint64_t m_numOverloadedTicks;
+    size_t m_maxSize;
+    int64_t m_cpuTime;
+
+    /* Start a new tick if the current one is over. */
+    void updateTick();
+
+    /* Hide constructor. */
+    TrainingScheduler() {};
+
+public:
+
+    /**
+     * Constructor, given the tick length and the CPU budget of the training per tick in ms, the queue capacity and the
+     * subsampling under overload. A budget of 0 disables the scheduler, the samples are then trained as they are received.
+     * Throws if the scheduler is enabled with a tick shorter than its budget or without queue capacity.
+     */
+    TrainingScheduler(long tickLength, long budget, size_t capacity, size_t subsample);
+
+    bool isEnabled() const
+    {
+        return m_budget > 0;
+    }
+
+    /**
+     * Queue the given training input, or subsample it out under overload. Sheds the oldest queued sample if the queue is full.
+     */
+    void enqueue(const string* pInput);
+
+    /**
+     * The oldest queued training input, to be trained and then released with endTraining(). Null if the queue is
+     * empty or, unless the budget is ignored, if the budget of the current tick is spent.
+     */
+    string* beginTraining(bool ignoreBudget = false);
+
+    /**
+     * Release the input returned by beginTraining() and charge its training CPU time to the budget.
+     */
+    void endTraining();
+
+    /**
+     * Shed all the queued samples.
+     */
+    void clear();
+
+    /**
+     * How long to wait for a command before training the next queued sample, in ms: 0 if it can be trained right
+     * away, until the next tick if the budget is spent, or -1 to wait for the next command if the queue is empty.
+     */
+    int getTimeout();
+
+    /**
+     * Log the stats of the scheduling decisions.
+     */
+    void logStats();
+};
+
+#endif // TRAINING_SCHEDULER_H_
@@ -13,6 +13,7 @@
 #include <sys/stat.h>
 
 #include "Constants.hpp"
+#include "LogRotation.hpp"
 
 using namespace std;
 
@@ -25,42 +26,6 @@ static inline bool exists(const string& name)
   return (stat (name.c_str(), &buffer) == 0); 
 }
 
-/**
- * Transform a string with separator characters into a vector of substrings.
- */
-static inline void str2vector(string str, char sep, vector<string>* pResult)
-{
-    /* Create string stream from the string. */
-    stringstream s_stream(str);
-    
-    /* Loop. */
-    while(s_stream.good())
-    {
-        string substr;
-
-        /* Get first string delimited by the given separator. */
-        getline(s_stream, substr, sep);
-
-        /* Insert substring into vector. */
-        pResult->push_back(substr);
-    }
-}
-
-/**
- * Get timestamp as milliseconds.
- */
-static inline string getTimestampMs()
-{
-    const auto now = chrono::system_clock::now();
-    chrono::milliseconds nowMs = chrono::duration_cast<chrono::milliseconds>(
-        now.time_since_epoch());
-
-    stringstream nowMsStr;
-    nowMsStr << nowMs.count();
-
-    return nowMsStr.str();
-}
-
 /**
  * Get a precise timestamp as a string.
  * Taken from: https://gist.github.com/bschlinker/844a88c09dcf7a61f6a8df1e52af7730
@@ -87,6 +52,9 @@ static inline string getTimestamp()
  */
 static inline void logMessage(string message, string level)
 {
+    /* Start a new log file if the current one is due for rotation. */
+    LogRotation::rotateMessageLogIfDue();
+
     /* Open the message log file. */
     ofstream ofs;
     ofs.open(LOG_FILEPATH_ORBITAI, std::ios_base::out | std::ios_base::app);
@@ -122,158 +90,4 @@ static inline void logInfo(string message)
     logMessage(message, "INFO");
 }
 
-/**
- * Log the inference results in a CSV file.
- * The pointer to the param names is only required in case the file is created for the first time and a header row is needed.
- */ 
-static inline void logInferenceResult(vector<string>* pParamNames, string* pInput, vector<pair<string, int>>* pInferences)
-{
-    /* Write the header row if the file is being created. */
-    bool writeHeader = !exists(LOG_FILEPATH_INFERENCE);
-
-    /* Open the file, append to it if it already exists. */
-    ofstream ofs;
-    ofs.open(LOG_FILEPATH_INFERENCE, std::ios_base::out | std::ios_base::app);
-
-    /* Write header row. */
-    if(writeHeader)
-    {
-        /* First two columns are the timestamp and the target label. */
-        ofs << "timestamp,label,";
-
-        /* Then the param names. */
-        for (vector<string>::iterator it = pParamNames->begin(); it != pParamNames->end(); ++it)
-        {
-            ofs << *it << ",";
-        }
-
-        /* And finally the name of the algorithms that made the label inferences/predictions. */
-        for (vector<pair<string, int>>::iterator it = pInferences->begin(); it != pInferences->end(); ++it)
-        {
-            ofs << it->first;
-
-            /* Append comma if it's not the last element of the CSV row that's being built. */
-            if(it != pInferences->end() - 1)
-            {
-                ofs << ",";
-            }
-        }
-
-        /* End line for the header row. */
-        ofs << std::endl;
-    }
-
-    /* Write the inference/prediction row. */
-    /* The data input needs to be converted from whitespace-separated to comma-separated. */
-    vector<string> inputs;
-    str2vector(*pInput, ' ', &inputs);
-
-    /* The first two values are the timestamp and the target label. */
-    /* The target label is the first element of the data input vector. */
-    ofs << getTimestampMs() << "," << std::stoi(inputs.at(0)) << ",";
-
-    /** 
-     * The remaining elements of the data input vector are the data inputs themselves.
-     * Each data input is prefix with an index and colon, they have to be removed prior to logging.
-     *      Before: [1:5.232, 2:4.412, 3:3.123, 4:2.23223]
-     *      After:  [  5.232,   4.412,   3.123,   2.23223]
-     */
-    for (vector<string>::iterator it = inputs.begin()+1; it != inputs.end(); ++it)
-    {
-        /* Fetch the input value, ignore the index and colon character. */
-        vector<string> inputPair;
-        str2vector(*it, ':', &inputPair);
-
-        /* Write input value. */
-        ofs << inputPair.at(1) << ",";
-    }
-
-    /* Then write the inference/prediction results. */
-    for (vector<pair<string, int>>::iterator it = pInferences->begin(); it != pInferences->end(); ++it)
-    {
-        /* Write inference. */
-        ofs << it->second;
-
-        /* Append comma if it's not the last element of the CSV row that's being built. */
-        if(it != pInferences->end() - 1)
-        {
-            ofs << ",";
-        }
-    }
-
-    /* End line for the inference/prediction row. */
-    ofs << std::endl;
-
-    /* Close the file. */
-    ofs.close();
-}
-
-static inline void logTrainingData(vector<string>* pParamNames, string* pInput)
-{
-    /* Write the header row if the file is being created. */
-    bool writeHeader = !exists(LOG_FILEPATH_TRAINING);
-
-    /* Open the file, append to it if it already exists. */
-    ofstream ofs;
-    ofs.open(LOG_FILEPATH_TRAINING, std::ios_base::out | std::ios_base::app);
-
-    /* Write header row. */
-    if(writeHeader)
-    {
-        /* First two columns are the timestamp and the target label. */
-        ofs << "timestamp,label,";
-
-        /* Then the param names. */
-        for (vector<string>::iterator it = pParamNames->begin(); it != pParamNames->end(); ++it)
-        {
-            ofs << *it;
-
-            /* Append comma if it's not the last element of the CSV row that's being built. */
-            if(it != pParamNames->end() - 1)
-            {
-                ofs << ",";
-            }
-        }
-
-        /* End line for the header row. */
-        ofs << std::endl;
-    }
-
-    /* Write the training data row. */
-    /* The data input needs to be converted from whitespace-separated to comma-separated. */
-    vector<string> inputs;
-    str2vector(*pInput, ' ', &inputs);
-
-    /* The first two values are the timestamp and the target label. */
-    /* The target label is the first element of the data input vector. */
-    ofs << getTimestampMs() << "," << std::stoi(inputs.at(0)) << ",";
-
-    /** 
-     * The remaining elements of the data input vector are the data inputs themselves.
-     * Each data input is prefix with an index and colon, they have to be removed prior to logging.
-     *      Before: [1:5.232, 2:4.412, 3:3.123, 4:2.23223]
-     *      After:  [  5.232,   4.412,   3.123,   2.23223]
-     */
-    for (vector<string>::iterator it = inputs.begin()+1; it != inputs.end(); ++it)
-    {
-        /* Fetch the input value, ignore the index and colon character. */
-        vector<string> inputPair;
-        str2vector(*it, ':', &inputPair);
-
-        /* Write input value. */
-        ofs << inputPair.at(1);
-
-        /* Append comma if it's not the last element of the CSV row that's being built. */
-        if(it != inputs.end() - 1)
-        {
-            ofs << ",";
-        }
-    }
-
-    ofs << std::endl;
-
-    /* Close the file. */
-    ofs.close();
-}
-
 #endif // LOGGING_H_
\ No newline at end of file
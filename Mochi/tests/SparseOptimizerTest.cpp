@@ -0,0 +1,305 @@
+/**
+ * Check the lazy updates of SPARSE_ADAGRAD_RDA and SPARSE_ADAM against dense reference implementations that update
+ * every weight after every training sample, on a small sparse stream. Run from the Mochi directory, see "make test".
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "SparseAdagradRda.hpp"
+#include "SparseAdam.hpp"
+
+using namespace std;
+
+/* Input dimension and number of samples of the stream, the weights are compared every CHECKPOINT samples. */
+#define STREAM_DIM                                               50
+#define STREAM_NUM_SAMPLES                                     3000
+#define STREAM_CHECKPOINT                                       500
+
+/* Features 1 to 5 are in every sample, 3 of the other ones in each sample. */
+#define STREAM_NUM_FREQUENT                                       5
+#define STREAM_NUM_RARE_PER_SAMPLE                                3
+
+/* Hyperparameters of ADAGRAD_RDA. */
+#define RDA_ETA                                                 0.1
+#define RDA_LAMBDA                                           0.0001
+
+/* The same constants as SparseAdam.cpp. */
+#define ADAM_ALPHA                                            0.001
+#define ADAM_BETA1                                              0.9
+#define ADAM_BETA2                                            0.999
+#define ADAM_EPSILON                                           1e-8
+
+/**
+ * Tolerance of the ADAM weights, 1% of the step size: the updates that a feature was left out of for more than 64
+ * updates are summed up with the bias corrections of the latest update and without epsilon. The differences come from
+ * the first hundreds of updates, while the bias corrections still change, and then stay around 1.5e-6 on this stream.
+ */
+#define ADAM_TOLERANCE                                         1e-5
+
+/* Number of failed checks. */
+static int numFailures = 0;
+
+/**
+ * Report a failed check.
+ */
+static void check(bool passed, const string& description)
+{
+    if(!passed)
+    {
+        cerr << "FAILED: " << description << endl;
+        numFailures++;
+    }
+}
+
+/**
+ * A sample of the stream, as the input string given to the models and as the dense input of the reference updates.
+ */
+struct Sample
+{
+    string input;
+    vector<double> x;
+    int label;
+};
+
+/**
+ * Generate the stream: the label is the sign of a fixed random linear function of the input, with 5% label noise so
+ * that the hinge loss keeps making updates.
+ */
+static vector<Sample> generateStream()
+{
+    mt19937 generator(1);
+    auto uniform = [&generator](int n) { return static_cast<int>(generator() % n); };
+
+    vector<double> truth(STREAM_DIM);
+    for(size_t j = 0; j < STREAM_DIM; ++j)
+    {
+        truth[j] = (uniform(2001) - 1000) / 1000.0;
+    }
+
+    vector<Sample> stream(STREAM_NUM_SAMPLES);
+    for(Sample& sample : stream)
+    {
+        vector<size_t> indices;
+        for(size_t j = 0; j < STREAM_NUM_FREQUENT; ++j)
+        {
+            indices.push_back(j);
+        }
+        for(int k = 0; k < STREAM_NUM_RARE_PER_SAMPLE; ++k)
+        {
+            indices.push_back(STREAM_NUM_FREQUENT + uniform(STREAM_DIM - STREAM_NUM_FREQUENT));
+        }
+
+        /* The values are read back from their text so that the models and the references see the same doubles. */
+        sample.x.assign(STREAM_DIM, 0);
+        string body;
+        for(size_t j : indices)
+        {
+            if(sample.x[j] != 0)
+            {
+                continue;
+            }
+
+            char text[32];
+            snprintf(text, sizeof(text), " %zu:%.3f", j + 1, (uniform(2001) - 1000) / 1000.0);
+            body += text;
+            sample.x[j] = atof(text + to_string(j + 1).size() + 2);
+        }
+
+        double margin = 0;
+        for(size_t j = 0; j < STREAM_DIM; ++j)
+        {
+            margin += truth[j] * sample.x[j];
+        }
+        sample.label = margin > 0 ? 1 : -1;
+        if(uniform(20) == 0)
+        {
+            sample.label = -sample.label;
+        }
+
+        sample.input = (sample.label > 0 ? "+1" : "-1") + body;
+    }
+
+    return stream;
+}
+
+/**
+ * Dense ADAGRAD_RDA: the gradient sums of every feature are updated after every sample with a hinge loss, a zero
+ * gradient for the features that are not in the sample, and every weight is computed from them.
+ */
+class DenseAdagradRda
+{
+private:
+    vector<double> m_gradientSums;
+    vector<double> m_squaredGradientSums;
+    uint64_t m_timestep;
+
+public:
+    DenseAdagradRda() : m_gradientSums(STREAM_DIM, 0), m_squaredGradientSums(STREAM_DIM, 0), m_timestep(0) {}
+
+    double weight(size_t j) const
+    {
+        const double truncatedSum = fabs(m_gradientSums[j]) - RDA_LAMBDA * m_timestep;
+        if(truncatedSum <= 0 || m_squaredGradientSums[j] == 0)
+        {
+            return 0;
+        }
+
+        return (m_gradientSums[j] > 0 ? -RDA_ETA : RDA_ETA) * truncatedSum / sqrt(m_squaredGradientSums[j]);
+    }
+
+    double margin(const vector<double>& x) const
+    {
+        double sum = 0;
+        for(size_t j = 0; j < STREAM_DIM; ++j)
+        {
+            sum += weight(j) * x[j];
+        }
+        return sum;
+    }
+
+    void train(const Sample& sample)
+    {
+        if(sample.label * margin(sample.x) >= 1)
+        {
+            return;
+        }
+
+        m_timestep++;
+        for(size_t j = 0; j < STREAM_DIM; ++j)
+        {
+            const double gradient = -sample.label * sample.x[j];
+            m_gradientSums[j] += gradient;
+            m_squaredGradientSums[j] += gradient * gradient;
+        }
+    }
+};
+
+/**
+ * Dense ADAM: the moment estimates and the weight of every feature are updated after every sample with a hinge loss,
+ * with a zero gradient for the features that are not in the sample.
+ */
+class DenseAdam
+{
+private:
+    vector<double> m_weights;
+    vector<double> m_firstMoments;
+    vector<double> m_secondMoments;
+    uint64_t m_timestep;
+
+public:
+    DenseAdam() : m_weights(STREAM_DIM, 0), m_firstMoments(STREAM_DIM, 0), m_secondMoments(STREAM_DIM, 0), m_timestep(0) {}
+
+    double weight(size_t j) const
+    {
+        return m_weights[j];
+    }
+
+    double margin(const vector<double>& x) const
+    {
+        double sum = 0;
+        for(size_t j = 0; j < STREAM_DIM; ++j)
+        {
+            sum += m_weights[j] * x[j];
+        }
+        return sum;
+    }
+
+    void train(const Sample& sample)
+    {
+        if(sample.label * margin(sample.x) >= 1)
+        {
+            return;
+        }
+
+        m_timestep++;
+        const double firstBiasCorrection = 1 - pow(ADAM_BETA1, static_cast<double>(m_timestep));
+        const double secondBiasCorrection = 1 - pow(ADAM_BETA2, static_cast<double>(m_timestep));
+        for(size_t j = 0; j < STREAM_DIM; ++j)
+        {
+            const double gradient = -sample.label * sample.x[j];
+            m_firstMoments[j] = ADAM_BETA1 * m_firstMoments[j] + (1 - ADAM_BETA1) * gradient;
+            m_secondMoments[j] = ADAM_BETA2 * m_secondMoments[j] + (1 - ADAM_BETA2) * gradient * gradient;
+            m_weights[j] -= ADAM_ALPHA * (m_firstMoments[j] / firstBiasCorrection)
+                / (sqrt(m_secondMoments[j] / secondBiasCorrection) + ADAM_EPSILON);
+        }
+    }
+};
+
+/* The sparse models with their weights exposed. */
+class TestSparseAdagradRda : public SparseAdagradRda
+{
+public:
+    TestSparseAdagradRda() : SparseAdagradRda(STREAM_DIM, RDA_ETA, RDA_LAMBDA) {}
+    using SparseAdagradRda::weight;
+};
+
+class TestSparseAdam : public SparseAdam
+{
+public:
+    TestSparseAdam() : SparseAdam(STREAM_DIM) {}
+    using SparseAdam::weight;
+};
+
+/**
+ * Train the sparse model and its dense reference on the stream. Before every sample the predictions must be the same,
+ * and at every checkpoint the weights must be within the given tolerance, 0 for identical weights.
+ */
+template<class SparseModel, class DenseModel>
+static void testParity(const string& name, const vector<Sample>& stream, double tolerance)
+{
+    SparseModel sparseModel;
+    DenseModel denseModel;
+
+    size_t numMismatches = 0;
+    double maxDifference = 0;
+    for(size_t i = 0; i < stream.size(); ++i)
+    {
+        string input = stream[i].input;
+        const int denseLabel = denseModel.margin(stream[i].x) > 0 ? 1 : -1;
+        if(sparseModel.infer(&input, STREAM_DIM) != denseLabel)
+        {
+            numMismatches++;
+        }
+
+        sparseModel.train(&input, STREAM_DIM);
+        denseModel.train(stream[i]);
+
+        if((i + 1) % STREAM_CHECKPOINT == 0)
+        {
+            for(size_t j = 0; j < STREAM_DIM; ++j)
+            {
+                const double difference = fabs(sparseModel.weight(j) - denseModel.weight(j));
+                maxDifference = max(maxDifference, difference);
+                check(difference <= tolerance, name + " weight " + to_string(j + 1) + " after sample " + to_string(i + 1)
+                    + " is " + to_string(sparseModel.weight(j)) + " instead of " + to_string(denseModel.weight(j)));
+            }
+        }
+    }
+
+    check(numMismatches == 0, name + " predicts " + to_string(numMismatches) + " samples differently");
+    cout << name << ": largest weight difference " << maxDifference << endl;
+}
+
+int main()
+{
+    const vector<Sample> stream = generateStream();
+
+    testParity<TestSparseAdagradRda, DenseAdagradRda>("SPARSE_ADAGRAD_RDA", stream, 0);
+    testParity<TestSparseAdam, DenseAdam>("SPARSE_ADAM", stream, ADAM_TOLERANCE);
+
+    if(numFailures > 0)
+    {
+        cerr << "SparseOptimizerTest: " << numFailures << " failed checks." << endl;
+        return 1;
+    }
+
+    cout << "SparseOptimizerTest: passed." << endl;
+    return 0;
+}
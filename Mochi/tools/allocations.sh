@@ -0,0 +1,98 @@
+#!/bin/bash
+
+# Check that the server does not allocate heap memory on its hot path. The samples of a test data file are sent as
+# training commands to a server in training mode, then as inference commands to a server in inference mode. The server
+# must be built with make COUNT_ALLOCATIONS=1, it then logs an error with code 12 for every steady state command that
+# made heap allocations outside of the MochiMochi algorithms and of saving the models, the training and inference of
+# OrbitAI's own algorithms included. Exits with 1 if any such error was logged. The exempted allocations per command,
+# logged by the server when it exits, are reported.
+#
+# Usage: ./tools/allocations.sh <string:server_binary> [string:samples_filename] [int:port]
+#   - server_binary: path to the OrbitAI_Mochi binary built with make COUNT_ALLOCATIONS=1.
+#   - samples_filename: test data file with a label and the 6 photodiode values per line, test_data/camera_small.txt by default.
+#   - port: port of the server, 9999 by default.
+#
+# Run from the Mochi directory, see "make test", e.g.: ./tools/allocations.sh ./OrbitAI_Mochi_count
+
+if [ $# -lt 1 ] || [ $# -gt 3 ]; then
+    echo "Invalid number of parameters. Usage: ./tools/allocations.sh <string:server_binary> [string:samples_filename] [int:port]"
+    exit 1
+fi
+
+SERVER=$(realpath "$1")
+SAMPLES=$(realpath "${2:-test_data/camera_small.txt}")
+PORT=${3:-9999}
+PROPERTIES=$(realpath ../nmf/space-app/conf/orbit_ai_v2.properties)
+
+# The server writes its logs and models in its working directory.
+WORKDIR=$(mktemp -d)
+trap 'rm -rf "$WORKDIR"' EXIT
+cd "$WORKDIR" || exit 1
+
+# The flight properties with the 6 photodiode inputs, all the algorithms and the prequential metrics enabled.
+write_properties() {
+    sed -e "s/^esa.mo.nmf.apps.OrbitAI.inputs=.*/esa.mo.nmf.apps.OrbitAI.inputs=PD1,PD2,PD3,PD4,PD5,PD6/" \
+        -e "s/^esa.mo.nmf.apps.OrbitAI.mochi.mode=.*/esa.mo.nmf.apps.OrbitAI.mochi.mode=$1/" \
+        -e "s/^esa.mo.nmf.apps.OrbitAI.mochi.port=.*/esa.mo.nmf.apps.OrbitAI.mochi.port=$PORT/" \
+        -e "s/^\(esa.mo.nmf.apps.OrbitAI.mochi.[A-Z_]*\)=0$/\1=1/" \
+        -e "s/^esa.mo.nmf.apps.OrbitAI.mochi.metrics.prequential=.*/esa.mo.nmf.apps.OrbitAI.mochi.metrics.prequential=1/" \
+        "$PROPERTIES" > orbitai.properties
+}
+
+# Start the server in the given mode, send it every sample as a command and wait for it to exit.
+run_server() {
+    write_properties $1
+    "$SERVER" orbitai.properties > server.out 2>&1 &
+    SERVER_PID=$!
+
+    # Wait for the server to listen.
+    for i in $(seq 1 50); do
+        { exec 3<>/dev/tcp/localhost/$PORT; } 2> /dev/null && break
+        sleep 0.1
+    done
+
+    if ! { true >&3; } 2> /dev/null; then
+        echo "Could not connect to the server on port $PORT:"
+        cat server.out logs/orbitai.log 2> /dev/null
+        kill $SERVER_PID 2> /dev/null
+        exit 1
+    fi
+
+    # The server reads a command at a time, the first four characters being the length of the command.
+    awk '{ body = ($1 > 0 ? "+1" : "-1"); for (i = 2; i <= NF; i++) body = body " " (i - 1) ":" $i; printf "%04d %s\n", length(body) + 5, body }' \
+        "$SAMPLES" | while IFS= read -r CMD; do
+        printf "%s" "$CMD" >&3
+        sleep 0.005
+    done
+
+    printf "exit" >&3
+    exec 3>&-
+    wait $SERVER_PID
+}
+
+run_server 0
+run_server 2
+
+# Make sure that the commands were processed rather than rejected.
+NUM_SAMPLES=$(grep -c . "$SAMPLES")
+NUM_TRAINED=$(cat logs/training*.csv | grep -c .)
+NUM_INFERRED=$(cat logs/inference*.csv | grep -c .)
+if [ "$NUM_TRAINED" -lt "$NUM_SAMPLES" ] || [ "$NUM_INFERRED" -lt "$NUM_SAMPLES" ]; then
+    echo "FAILED: only $NUM_TRAINED training and $NUM_INFERRED inference commands of $NUM_SAMPLES were logged:"
+    cat logs/orbitai.log
+    exit 1
+fi
+
+if grep -q "Error Code 12" logs/orbitai.log; then
+    echo "FAILED: hot path heap allocations:"
+    grep "Error Code 12" logs/orbitai.log | head -n 10
+    exit 1
+fi
+
+# The server logs the allocations exempted from the check when it exits, once per run.
+grep "exempted from the hot path check" logs/orbitai.log | awk -v n="$NUM_SAMPLES" '
+    { split($0, words, "check: "); split(words[2], counts, " "); split(words[2], saves, "of which "); split(saves[2], save, " ") }
+    NR == 1 { printf "exempted per training command: %.1f allocations by the MochiMochi algorithms and saving the models, %.1f of them saving the in-tree models.\n", counts[1] / n, save[1] / n }
+    NR == 2 { printf "exempted per inference command: %.1f allocations by the MochiMochi algorithms.\n", counts[1] / n }'
+
+echo "allocations: passed, $NUM_SAMPLES training and $NUM_SAMPLES inference commands without hot path allocations."
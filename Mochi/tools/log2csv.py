@@ -0,0 +1,69 @@
+import gzip
+import sys
+import struct
+
+'''
+Converts a binary training or inference log written by the Mochi server with log.format=binary into the CSV layout
+of the training.csv and inference.csv logs, e.g. to calculate classification metrics with analyze.py.
+
+The header row has the timestamp and label columns, followed by the param names and, for an inference log, by the
+model names. Rotated log segments compressed with gzip are read as well.
+
+Usage: python3 log2csv.py <string:binary_log_file> <string:csv_output_file>
+- binary_log_file: binary log file to convert, e.g. logs/training.bin or logs/inference_20210515T152659.bin.gz.
+- csv_output_file: CSV file the log is written to.
+
+E.g.: python3 log2csv.py logs/inference.bin logs/inference.csv
+'''
+
+BINARY_LOG_MAGIC = b'OAILOG01'
+
+# Magic, header size, record size, number of params and number of models.
+HEADER_FIXED_FORMAT = '<8sIIII'
+
+
+def read_names(data, offset, count):
+    names = []
+    for _ in range(count):
+        length = struct.unpack_from('<H', data, offset)[0]
+        offset += 2
+        names.append(data[offset:offset + length].decode('latin-1'))
+        offset += length
+    return names, offset
+
+
+def convert(binary_log_filepath, csv_output_filepath):
+    opener = gzip.open if binary_log_filepath.endswith('.gz') else open
+    with opener(binary_log_filepath, 'rb') as f:
+        data = f.read()
+
+    magic, header_size, record_size, num_params, num_models = struct.unpack_from(HEADER_FIXED_FORMAT, data, 0)
+    if magic != BINARY_LOG_MAGIC:
+        raise ValueError('Not a binary log file: ' + binary_log_filepath)
+
+    param_names, offset = read_names(data, struct.calcsize(HEADER_FIXED_FORMAT), num_params)
+    model_names, offset = read_names(data, offset, num_models)
+
+    # Timestamp, label, padding, input values and inferences.
+    record_format = '<qi4x%dd%di' % (num_params, num_models)
+    num_records = (len(data) - header_size) // record_size
+
+    with open(csv_output_filepath, 'w') as csv:
+        csv.write(','.join(['timestamp', 'label'] + param_names + model_names) + '\n')
+
+        for i in range(num_records):
+            record = struct.unpack_from(record_format, data, header_size + i * record_size)
+            values = [str(record[0]), str(record[1])]
+            values += [repr(v) for v in record[2:2 + num_params]]
+            values += [str(v) for v in record[2 + num_params:]]
+            csv.write(','.join(values) + '\n')
+
+    print('Converted %d records of %s into %s' % (num_records, binary_log_filepath, csv_output_filepath))
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        print('Usage: python3 log2csv.py <binary_log_file> <csv_output_file>')
+        sys.exit(1)
+
+    convert(sys.argv[1], sys.argv[2])
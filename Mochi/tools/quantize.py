@@ -0,0 +1,148 @@
+import math
+import os
+import sys
+
+'''
+Parity report of the quantized linear models against the double models they are quantized from, as the Mochi server
+quantizes them in inference mode with esa.mo.nmf.apps.OrbitAI.mochi.inference.quantize set to 8 or 16.
+
+The weights of each saved linear model are quantized to int8 and int16 with a per-model scale and the inputs to int16
+over [-range, range], as in src/QuantizedModel.cpp. Every sample of the validation file is predicted with the double
+weights and with the integer scoring kernel, and the report lists per model the share of predictions that agree with
+the double model and the balanced accuracy of both. A model whose double predictions are all of one class is flagged as
+constant: its agreement only shows that the quantization did not flip the sign of its scores, not that it preserves its
+decision boundary.
+
+Usage: python3 quantize.py <string:models_dir> <string:validation_file> <float:range> [<string:columns>]
+- models_dir: directory of the saved models, e.g. models. Models that are not linear are skipped.
+- validation_file: samples with a label followed by the input values on each line, e.g. test_data/camera_validation_2021-05.txt.
+- range: largest input magnitude, the value of esa.mo.nmf.apps.OrbitAI.mochi.inference.quantize.range.
+- columns: comma separated 1-based positions of the input values of the models, e.g. 2,3,4,5,6 for models of a feature group. All the values by default.
+
+E.g.: python3 quantize.py ../models ../test_data/camera_validation_2021-05.txt 2
+'''
+
+# Position of the weight vector in the model archive, the means follow the covariances for AROW, NHERD and SCW.
+WEIGHT_VECTOR_INDEX = {
+    'ADAGRAD_RDA': 0,
+    'ADAM': 0,
+    'PA': 0,
+    'AROW': 1,
+    'NHERD': 1,
+    'SCW': 1
+}
+
+# Names of the models downlinked in 2021, see models_space.
+ALGORITHM_ALIASES = {
+    'RDA': 'ADAGRAD_RDA',
+    'PA1': 'PA',
+    'PA2': 'PA'
+}
+
+# Archive header: "22 serialization::archive 15", then the tracking level and version of the model.
+ARCHIVE_HEADER_NUM_TOKENS = 5
+
+INPUT_QUANTIZED_MAX = 32767
+
+
+def round_half_away(value):
+    '''Round as the C++ lround and round functions do.'''
+    return int(math.copysign(math.floor(abs(value) + 0.5), value))
+
+
+def algorithm_of(model_name):
+    '''The algorithm of a model named after it, possibly followed by the feature group, e.g. ADAM_1D or adam_1D.'''
+    model_name = model_name.upper()
+    for name in list(WEIGHT_VECTOR_INDEX) + list(ALGORITHM_ALIASES):
+        if model_name == name or model_name.startswith(name + '_'):
+            return ALGORITHM_ALIASES.get(name, name)
+    return None
+
+
+def read_weights(model_filepath, algorithm):
+    tokens = open(model_filepath).read().split()[ARCHIVE_HEADER_NUM_TOKENS:]
+
+    # Each vector is written as its size, the version of its items and its values.
+    offset = 0
+    for _ in range(WEIGHT_VECTOR_INDEX[algorithm] + 1):
+        size = int(tokens[offset])
+        weights = [float(t) for t in tokens[offset + 2:offset + 2 + size]]
+        offset += 2 + size
+
+    return weights
+
+
+def quantize_weights(weights, bits):
+    max_weight = max(abs(w) for w in weights)
+    max_quantized = (1 << (bits - 1)) - 1
+    scale = max_weight / max_quantized if max_weight > 0 else 1.0
+    return [round_half_away(w / scale) for w in weights], scale
+
+
+def quantize_inputs(x, input_scale):
+    return [max(-INPUT_QUANTIZED_MAX, min(INPUT_QUANTIZED_MAX, round_half_away(v / input_scale))) for v in x]
+
+
+def predict(weights, x):
+    return 1 if sum(w * v for w, v in zip(weights, x)) > 0 else -1
+
+
+def balanced_accuracy(labels, predictions):
+    tp = sum(1 for l, p in zip(labels, predictions) if l > 0 and p > 0)
+    fn = sum(1 for l, p in zip(labels, predictions) if l > 0 and p < 0)
+    tn = sum(1 for l, p in zip(labels, predictions) if l < 0 and p < 0)
+    fp = sum(1 for l, p in zip(labels, predictions) if l < 0 and p > 0)
+
+    # The rate of a class without samples is left out.
+    rates = [r for r in [tp / (tp + fn) if tp + fn > 0 else None, tn / (tn + fp) if tn + fp > 0 else None] if r is not None]
+    return sum(rates) / len(rates)
+
+
+def report(models_dirpath, validation_filepath, input_range, columns):
+    labels = []
+    samples = []
+    for line in open(validation_filepath):
+        values = line.split()
+        if not values:
+            continue
+        labels.append(1 if float(values[0]) > 0 else -1)
+        samples.append([float(v) for v in values[1:]])
+
+    if columns is not None:
+        samples = [[x[c - 1] for c in columns] for x in samples]
+
+    input_scale = input_range / INPUT_QUANTIZED_MAX
+    quantized_samples = [quantize_inputs(x, input_scale) for x in samples]
+
+    print('%d samples of %s, inputs quantized to int16 over [-%g, %g]' % (len(samples), validation_filepath, input_range, input_range))
+    print('%-24s %12s %12s %12s %12s %12s' % ('model', 'double_bacc', 'int16_bacc', 'int16_agree', 'int8_bacc', 'int8_agree'))
+
+    for model_name in sorted(os.listdir(models_dirpath)):
+        algorithm = algorithm_of(model_name)
+        if algorithm is None:
+            continue
+
+        weights = read_weights(os.path.join(models_dirpath, model_name), algorithm)
+        if len(weights) != len(samples[0]):
+            print('%-24s skipped, %d weights for %d input values' % (model_name, len(weights), len(samples[0])))
+            continue
+
+        double_predictions = [predict(weights, x) for x in samples]
+        row = [balanced_accuracy(labels, double_predictions)]
+
+        for bits in [16, 8]:
+            quantized_weights, _ = quantize_weights(weights, bits)
+            predictions = [predict(quantized_weights, xq) for xq in quantized_samples]
+            agreement = sum(1 for p, d in zip(predictions, double_predictions) if p == d) / len(samples)
+            row += [balanced_accuracy(labels, predictions), agreement]
+
+        constant = '  constant' if len(set(double_predictions)) == 1 else ''
+        print('%-24s %12.4f %12.4f %12.4f %12.4f %12.4f%s' % tuple([model_name] + row + [constant]))
+
+
+if __name__ == '__main__':
+    if len(sys.argv) not in [4, 5]:
+        print('Usage: python3 quantize.py <models_dir> <validation_file> <range> [<columns>]')
+        sys.exit(1)
+
+    report(sys.argv[1], sys.argv[2], float(sys.argv[3]), [int(c) for c in sys.argv[4].split(',')] if len(sys.argv) == 5 else None)
@@ -0,0 +1,273 @@
+import os
+import sys
+import struct
+
+'''
+Reconstructs the model files from the model snapshots exported by the Mochi server with the export command.
+
+A snapshot is either full or a delta of the previous snapshot, so the snapshots have to be reconstructed in order,
+starting from a full snapshot. The models of each snapshot are written to <output_dir>/<snapshot_number>/ and
+are read back from there as the base of the next delta snapshots. The reconstructed models are identical to the
+saved ones, except for the floating point values of snapshots exported with quantization which are the nearest floats.
+
+Usage: python3 reconstruct.py <string:output_dir> <string:snapshot_file> [<string:snapshot_file> ...]
+- output_dir: directory the reconstructed models are written to.
+- snapshot_file: snapshot files downlinked from the snapshots directory, in any order.
+
+E.g.: python3 reconstruct.py models_ground snapshots/snapshot_000001.bin snapshots/snapshot_000002.bin
+'''
+
+SNAPSHOT_MAGIC = b'OAISNAP1'
+
+# Token types.
+TOKEN_INTEGER = 0
+TOKEN_DOUBLE = 1
+TOKEN_FLOAT = 2
+TOKEN_TEXT = 3
+
+# Codes of the whitespace following a token.
+SEPARATOR_NONE = 0
+SEPARATOR_SPACE = 1
+SEPARATOR_NEWLINE = 2
+SEPARATOR_OTHER = 3
+
+SEPARATORS = ' \n\t\r'
+
+# Largest float, values above it are not quantized.
+FLT_MAX = 3.4028234663852886e+38
+
+MASK_32 = 0xFFFFFFFF
+MASK_64 = 0xFFFFFFFFFFFFFFFF
+
+
+# Decompress with the order-0 adaptive binary arithmetic coder the server compresses with.
+def decompress(data, length):
+    x1 = 0
+    x2 = MASK_32
+    x = 0
+    pos = 0
+
+    def next_byte():
+        nonlocal pos
+        byte = data[pos] if pos < len(data) else 0
+        pos += 1
+        return byte
+
+    for _ in range(4):
+        x = (x << 8) | next_byte()
+
+    probabilities = [1 << 15] * 256
+    out = bytearray()
+
+    for _ in range(length):
+        context = 1
+        for _ in range(8):
+            p = probabilities[context]
+            xmid = x1 + (((x2 - x1) * p) >> 16)
+            if x <= xmid:
+                bit = 1
+                x2 = xmid
+                probabilities[context] = p + ((65536 - p) >> 4)
+            else:
+                bit = 0
+                x1 = xmid + 1
+                probabilities[context] = p - (p >> 4)
+            context = (context << 1) | bit
+
+            while ((x1 ^ x2) & 0xFF000000) == 0:
+                x1 = (x1 << 8) & MASK_32
+                x2 = ((x2 << 8) & MASK_32) | 0xFF
+                x = ((x << 8) & MASK_32) | next_byte()
+
+        out.append(context & 0xFF)
+
+    return bytes(out)
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def byte(self):
+        value = self.data[self.pos]
+        self.pos += 1
+        return value
+
+    def varint(self):
+        value = 0
+        shift = 0
+        while True:
+            byte = self.byte()
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if byte < 0x80:
+                return value
+
+    def string(self):
+        length = self.varint()
+        value = self.data[self.pos:self.pos + length].decode('latin-1')
+        self.pos += length
+        return value
+
+    def big_endian(self, num_bytes):
+        value = int.from_bytes(self.data[self.pos:self.pos + num_bytes], 'big')
+        self.pos += num_bytes
+        return value
+
+
+# Parse an integer that is written back identically, as the server does.
+def parse_integer(text):
+    digits = text[1:] if text.startswith('-') else text
+    if not digits or not all('0' <= c <= '9' for c in digits) or (digits[0] == '0' and len(digits) > 1) or text == '-0':
+        return None
+    value = int(text)
+    if value < -(1 << 63) or value >= (1 << 63):
+        return None
+    return value
+
+
+# Parse a floating point value that is written back identically with 17 digits, as the server does.
+def parse_double(text):
+    if not any('0' <= c <= '9' for c in text):
+        return None
+    try:
+        value = float(text)
+    except ValueError:
+        return None
+    return value if '%.17e' % value == text else None
+
+
+def double_bits(value):
+    return struct.unpack('>Q', struct.pack('>d', value))[0]
+
+
+def float_bits(value):
+    return struct.unpack('>I', struct.pack('>f', value))[0]
+
+
+# Split a model archive into (type, text, separator) tokens as the server does, returning the whitespace before the first token.
+def tokenize(archive, quantize):
+    i = 0
+    while i < len(archive) and archive[i] in SEPARATORS:
+        i += 1
+    leading = archive[:i]
+
+    tokens = []
+    while i < len(archive):
+        token_start = i
+        while i < len(archive) and archive[i] not in SEPARATORS:
+            i += 1
+        text = archive[token_start:i]
+        separator_start = i
+        while i < len(archive) and archive[i] in SEPARATORS:
+            i += 1
+        separator = archive[separator_start:i]
+
+        if parse_integer(text) is not None:
+            token_type = TOKEN_INTEGER
+        elif parse_double(text) is not None:
+            # Values out of the range of floats are kept as doubles.
+            token_type = TOKEN_FLOAT if quantize and abs(parse_double(text)) <= FLT_MAX else TOKEN_DOUBLE
+        else:
+            token_type = TOKEN_TEXT
+        tokens.append((token_type, text, separator))
+
+    return leading, tokens
+
+
+# The value of a token, as the bits the server encodes for floating point values.
+def token_value(token_type, text):
+    if token_type == TOKEN_INTEGER:
+        return parse_integer(text)
+    value = parse_double(text)
+    return double_bits(value) if token_type == TOKEN_DOUBLE else float_bits(value)
+
+
+def read_value(reader, token_type, base):
+    if token_type == TOKEN_INTEGER:
+        zigzag = reader.varint()
+        value = (base + ((zigzag >> 1) ^ (-(zigzag & 1) & MASK_64))) & MASK_64
+        return str(value - (1 << 64) if value >= (1 << 63) else value)
+
+    if token_type == TOKEN_DOUBLE:
+        bits = reader.big_endian(8) ^ base
+        return '%.17e' % struct.unpack('>d', bits.to_bytes(8, 'big'))[0]
+
+    bits = reader.big_endian(4) ^ base
+    return '%.17e' % struct.unpack('>f', bits.to_bytes(4, 'big'))[0]
+
+
+def decode_model(reader, base_dir):
+    name = reader.string()
+
+    # A delta only has the values of the tokens, the rest of the archive is the base's.
+    if reader.byte() == 1:
+        quantize = reader.byte() == 1
+        with open(os.path.join(base_dir, name), encoding='latin-1', newline='') as f:
+            archive, base_tokens = tokenize(f.read(), quantize)
+
+        for token_type, text, separator in base_tokens:
+            if token_type != TOKEN_TEXT:
+                text = read_value(reader, token_type, token_value(token_type, text))
+            archive += text + separator
+
+        return name, archive
+
+    archive = reader.string()
+    for _ in range(reader.varint()):
+        token_type = reader.byte()
+        if token_type == TOKEN_TEXT:
+            archive += reader.string()
+        else:
+            archive += read_value(reader, token_type, 0)
+
+        separator = reader.byte()
+        if separator == SEPARATOR_SPACE:
+            archive += ' '
+        elif separator == SEPARATOR_NEWLINE:
+            archive += '\n'
+        elif separator == SEPARATOR_OTHER:
+            archive += reader.string()
+
+    return name, archive
+
+
+def reconstruct(snapshot_filepath, output_dir):
+    with open(snapshot_filepath, 'rb') as f:
+        data = f.read()
+
+    if data[:8] != SNAPSHOT_MAGIC:
+        raise ValueError('Not a model snapshot file: ' + snapshot_filepath)
+    number, base_number, length = struct.unpack('<III', data[8:20])
+
+    base_dir = os.path.join(output_dir, str(base_number))
+    if base_number > 0 and not os.path.isdir(base_dir):
+        raise ValueError('Snapshot %d is a delta of snapshot %d which has not been reconstructed.' % (number, base_number))
+
+    reader = Reader(decompress(data[20:], length))
+    snapshot_dir = os.path.join(output_dir, str(number))
+    os.makedirs(snapshot_dir, exist_ok=True)
+
+    for _ in range(reader.varint()):
+        name, archive = decode_model(reader, base_dir)
+        with open(os.path.join(snapshot_dir, name), 'w', encoding='latin-1', newline='') as f:
+            f.write(archive)
+
+    print('Reconstructed snapshot %d (%d bytes) into %s' % (number, len(data), snapshot_dir))
+    return number
+
+
+def snapshot_number(snapshot_filepath):
+    with open(snapshot_filepath, 'rb') as f:
+        return struct.unpack('<I', f.read(12)[8:12])[0]
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 3:
+        print('Usage: python3 reconstruct.py <output_dir> <snapshot_file> [<snapshot_file> ...]')
+        sys.exit(1)
+
+    # Deltas are reconstructed after the snapshots they are deltas of.
+    for snapshot_filepath in sorted(sys.argv[2:], key=snapshot_number):
+        reconstruct(snapshot_filepath, sys.argv[1])
@@ -0,0 +1,217 @@
+#ifndef COLUMN_DATA_H_
+#define COLUMN_DATA_H_
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <type_traits>
+
+#include "globals.h"
+#include "Data.h"
+
+namespace ranger
+{
+
+/**
+ * A block of consecutive rows parsed from a single input file.
+ * Each independent and dependent variable is stored as its own column vector so that rows can be appended while
+ * parsing without knowing the row count ahead of time.
+ */
+template<typename T>
+class ColumnChunk
+{
+public:
+  /* One vector per independent variable. */
+  std::vector<std::vector<T>> x;
+
+  /* One vector per dependent variable. */
+  std::vector<std::vector<T>> y;
+
+  /* Number of complete rows. */
+  size_t numRows;
+
+  /* Constructor. */
+  ColumnChunk(size_t numIndependentVariables, size_t numDependentVariables) :
+      x(numIndependentVariables), y(numDependentVariables), numRows(0)
+  {
+  }
+
+  /**
+   * Append a value to the given independent variable column.
+   * A full row is committed with commitRow() once every column received its value.
+   */
+  void appendX(size_t col, double value, bool& error)
+  {
+    x[col].push_back(convert(value, error));
+  }
+
+  /**
+   * Append a value to the given dependent variable column.
+   */
+  void appendY(size_t col, double value, bool& error)
+  {
+    y[col].push_back(convert(value, error));
+  }
+
+  /**
+   * Mark the values appended since the last call as a complete row.
+   */
+  void commitRow()
+  {
+    numRows++;
+  }
+
+  /**
+   * Cast the value to the storage type, flagging rounding errors like ranger's DataChar does.
+   */
+  static T convert(double value, bool& error)
+  {
+    T result = static_cast<T>(value);
+    if (std::is_integral<T>::value && static_cast<double>(result) != value)
+    {
+      error = true;
+    }
+    return result;
+  }
+};
+
+/**
+ * In-memory ranger Data matrix that is filled directly by the OrbitAI CSV loader.
+ * The matrix is the concatenation of the chunks parsed from each input file. Chunks are moved in, never copied,
+ * and rows are addressed through a row to chunk lookup. The value type follows ranger's memory mode (double, float, or char).
+ */
+template<typename T>
+class ColumnData : public Data
+{
+private:
+  /* Row blocks in input file order. */
+  std::vector<ColumnChunk<T>> m_chunks;
+
+  /* First row of each chunk. */
+  std::vector<size_t> m_chunkFirstRows;
+
+  /* Index of the chunk holding each row, only filled when there is more than one chunk. */
+  std::vector<uint32_t> m_rowChunks;
+
+  /* Number of dependent variables. */
+  size_t m_numDependentVariables;
+
+public:
+
+  /* Constructor. */
+  ColumnData(const std::vector<std::string>& variableNames, size_t numDependentVariables) :
+      m_numDependentVariables(numDependentVariables)
+  {
+    this->variable_names = variableNames;
+    this->num_cols = variableNames.size();
+    this->num_cols_no_snp = variableNames.size();
+    this->num_rows = 0;
+  }
+
+  ColumnData(const ColumnData&) = delete;
+  ColumnData& operator=(const ColumnData&) = delete;
+
+  virtual ~ColumnData() override = default;
+
+  double get_x(size_t row, size_t col) const override
+  {
+    /* Columns past the last variable are the permuted copies used by the corrected impurity importance. */
+    if (col >= this->num_cols)
+    {
+      row = this->permuted_sampleIDs[row];
+      col -= this->num_cols;
+    }
+
+    const ColumnChunk<T>& chunk = locate(&row);
+    return chunk.x[col][row];
+  }
+
+  double get_y(size_t row, size_t col) const override
+  {
+    const ColumnChunk<T>& chunk = locate(&row);
+    return chunk.y[col][row];
+  }
+
+  void reserveMemory(size_t y_cols) override
+  {
+    m_numDependentVariables = y_cols;
+    for (auto& chunk : m_chunks)
+    {
+      chunk.y.resize(y_cols);
+      for (auto& column : chunk.x)
+      {
+        column.resize(chunk.numRows);
+      }
+      for (auto& column : chunk.y)
+      {
+        column.resize(chunk.numRows);
+      }
+    }
+  }
+
+  void set_x(size_t col, size_t row, double value, bool& error) override
+  {
+    ColumnChunk<T>& chunk = const_cast<ColumnChunk<T>&>(locate(&row));
+    chunk.x[col][row] = ColumnChunk<T>::convert(value, error);
+  }
+
+  void set_y(size_t col, size_t row, double value, bool& error) override
+  {
+    ColumnChunk<T>& chunk = const_cast<ColumnChunk<T>&>(locate(&row));
+    chunk.y[col][row] = ColumnChunk<T>::convert(value, error);
+  }
+
+  /**
+   * Create an empty chunk with the column layout of this matrix.
+   */
+  ColumnChunk<T> createChunk() const
+  {
+    return ColumnChunk<T>(this->num_cols, m_numDependentVariables);
+  }
+
+  /**
+   * Append the rows of the given chunk to the matrix, taking ownership of its columns.
+   */
+  void addChunk(ColumnChunk<T>&& chunk)
+  {
+    if (chunk.numRows == 0)
+    {
+      return;
+    }
+
+    m_chunkFirstRows.push_back(this->num_rows);
+    m_chunks.push_back(std::move(chunk));
+    this->num_rows += m_chunks.back().numRows;
+
+    /* The lookup table is only needed once rows are spread over several chunks. */
+    if (m_chunks.size() == 2)
+    {
+      m_rowChunks.assign(m_chunks[0].numRows, 0);
+    }
+    if (m_chunks.size() >= 2)
+    {
+      m_rowChunks.resize(this->num_rows, static_cast<uint32_t>(m_chunks.size() - 1));
+    }
+  }
+
+private:
+
+  /**
+   * Find the chunk holding the given row and turn the row index into an index within that chunk.
+   */
+  const ColumnChunk<T>& locate(size_t* pRow) const
+  {
+    if (m_rowChunks.empty())
+    {
+      return m_chunks[0];
+    }
+
+    const uint32_t chunkIndex = m_rowChunks[*pRow];
+    *pRow -= m_chunkFirstRows[chunkIndex];
+    return m_chunks[chunkIndex];
+  }
+};
+
+} // namespace ranger
+
+#endif // COLUMN_DATA_H_
@@ -0,0 +1,593 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <glob.h>
+
+#include <csv2/reader.hpp>
+
+#include "utility.h"
+#include "ColumnData.hpp"
+#include "CsvDataLoader.hpp"
+
+/* Marker used in the raw telemetry CSV files for parameters that could not be fetched. */
+#define MISSING_VALUE_MARKER                                                "x"
+
+/* Name given to the unnamed first column of a shifted header. */
+#define SHIFTED_HEADER_FIRST_COLUMN                                         "TIMESTAMP"
+
+using namespace csv2;
+
+namespace ranger
+{
+
+namespace
+{
+
+typedef csv2::Reader<delimiter<','>,
+    quote_character<'"'>,
+    first_row_is_header<true>,
+    trim_policy::trim_whitespace> CsvReader;
+
+/* Reader of the files without a header row, whose column names are given. */
+typedef csv2::Reader<delimiter<','>,
+    quote_character<'"'>,
+    first_row_is_header<false>,
+    trim_policy::trim_whitespace> HeaderlessCsvReader;
+
+/**
+ * Where the values of a CSV column end up in the Data matrix.
+ * Built once from the header row so that no lookup is needed while traversing the data rows.
+ */
+struct ColumnTarget
+{
+  bool keep;
+  bool dependent;
+  size_t index;
+};
+
+/**
+ * Convert a cell to a number, throw if the cell is not entirely numeric.
+ * Boolean flags found in the raw telemetry files are read as 1 and 0.
+ */
+double parse_value(const std::string& cellValue, const std::string& columnName, size_t rowIndex)
+{
+  if (cellValue == "true")
+  {
+    return 1;
+  }
+  else if (cellValue == "false")
+  {
+    return 0;
+  }
+
+  const char* pBegin = cellValue.c_str();
+  char* pEnd = nullptr;
+  double value = std::strtod(pBegin, &pEnd);
+
+  if (pEnd == pBegin || *pEnd != '\0')
+  {
+    throw std::runtime_error("Could not read value '" + cellValue + "' of column '" + columnName
+        + "' in data row " + std::to_string(rowIndex + 1) + ".");
+  }
+
+  return value;
+}
+
+/**
+ * List the names of the independent variables in the order in which they appear in columnNames.
+ */
+std::vector<std::string> select_variable_names(const std::vector<std::string>& columnNames, const std::vector<std::string>& includeVars,
+    const std::vector<std::string>& dependentVarNames)
+{
+  std::vector<std::string> variableNames;
+
+  for (const auto& columnName : columnNames)
+  {
+    if ((includeVars.empty() || std::find(includeVars.begin(), includeVars.end(), columnName) != includeVars.end())
+        && std::find(dependentVarNames.begin(), dependentVarNames.end(), columnName) == dependentVarNames.end())
+    {
+      variableNames.push_back(columnName);
+    }
+  }
+
+  return variableNames;
+}
+
+/**
+ * Map every column name to its target in the Data matrix.
+ * Columns are matched by name so that input files listing the same columns in a different order can be combined.
+ */
+std::vector<ColumnTarget> build_projection(const std::vector<std::string>& columnNames, const std::vector<std::string>& includeVars,
+    const std::vector<std::string>& dependentVarNames, const std::vector<std::string>& variableNames)
+{
+  std::vector<ColumnTarget> projection(columnNames.size(), ColumnTarget { false, false, 0 });
+  std::vector<bool> dependentFound(dependentVarNames.size(), false);
+  size_t includedCounter = 0;
+  size_t independentCounter = 0;
+
+  for (size_t col = 0; col < columnNames.size(); ++col)
+  {
+    const std::string& columnName = columnNames[col];
+
+    /* Skip columns that are not marked to be kept (e.g. timestamp). */
+    if (!includeVars.empty() && std::find(includeVars.begin(), includeVars.end(), columnName) == includeVars.end())
+    {
+      continue;
+    }
+
+    auto depIt = std::find(dependentVarNames.begin(), dependentVarNames.end(), columnName);
+    auto varIt = std::find(variableNames.begin(), variableNames.end(), columnName);
+
+    if (depIt != dependentVarNames.end())
+    {
+      /* Dependent variables are stored in the order in which they were named. */
+      projection[col].dependent = true;
+      projection[col].index = depIt - dependentVarNames.begin();
+      dependentFound[projection[col].index] = true;
+    }
+    else if (varIt != variableNames.end())
+    {
+      projection[col].index = varIt - variableNames.begin();
+      independentCounter++;
+    }
+    else
+    {
+      throw std::runtime_error("Column '" + columnName + "' is not present in every input file.");
+    }
+
+    projection[col].keep = true;
+    includedCounter++;
+  }
+
+  if (!includeVars.empty() && includedCounter != includeVars.size())
+  {
+    throw std::runtime_error("Not all variables given with '--includevars' were found in the input data.");
+  }
+
+  if (independentCounter != variableNames.size())
+  {
+    throw std::runtime_error("Input files do not all have the same columns.");
+  }
+
+  for (size_t i = 0; i < dependentVarNames.size(); ++i)
+  {
+    if (!dependentFound[i])
+    {
+      throw std::runtime_error("Dependent variable " + dependentVarNames[i] + " not found in the input data.");
+    }
+  }
+
+  return projection;
+}
+
+/**
+ * Read the column names from the header row.
+ * The header of the telemetry files downlinked in 2021 (results/data) lacks the name of the first column, the
+ * timestamp, so that every name is shifted one column to the left and the last name is empty (issue #10). Such a
+ * header, whose only empty name is the last one, is shifted back and its first column is named TIMESTAMP.
+ */
+std::vector<std::string> read_header(const CsvReader& csv, bool* pShifted)
+{
+  std::vector<std::string> columnNames;
+  std::string columnName;
+  size_t numEmptyNames = 0;
+
+  for (const auto cell: csv.header())
+  {
+    columnName.clear();
+    cell.read_value(columnName);
+    columnNames.push_back(columnName);
+
+    if (columnName.empty())
+    {
+      numEmptyNames++;
+    }
+  }
+
+  *pShifted = columnNames.size() > 1 && numEmptyNames == 1 && columnNames.back().empty();
+  if (*pShifted)
+  {
+    columnNames.pop_back();
+    columnNames.insert(columnNames.begin(), SHIFTED_HEADER_FIRST_COLUMN);
+  }
+
+  return columnNames;
+}
+
+/**
+ * Open and memory map the given input file.
+ */
+template<typename Reader>
+void open_csv(Reader* pCsv, const std::string& inputFile)
+{
+  if (!pCsv->mmap(inputFile))
+  {
+    throw std::runtime_error("Could not open input file: " + inputFile + ".");
+  }
+}
+
+/**
+ * Outcome of parsing a single input file.
+ */
+struct FileReport
+{
+  size_t numRows;
+  size_t numSkippedRows;
+  bool roundingError;
+  bool shiftedHeader;
+};
+
+/**
+ * Traverse the rows of a memory mapped CSV file with the given column names and append the kept cells to the given chunk.
+ * Rows with a missing value marker in any kept column are skipped while parsing, or rejected unless skipMissing.
+ */
+template<typename T, typename Reader>
+void read_rows(const Reader& csv, const std::string& inputFile, const std::vector<std::string>& columnNames,
+    const std::vector<std::string>& includeVars, const std::vector<std::string>& dependentVarNames,
+    const std::vector<std::string>& variableNames, bool skipMissing, ColumnChunk<T>* pChunk, FileReport* pReport)
+{
+  /* Figure out once where each column goes instead of searching the kept columns for every cell. */
+  const std::vector<ColumnTarget> projection = build_projection(columnNames, includeVars, dependentVarNames, variableNames);
+
+  /* Number of cells expected to be kept for each row. */
+  const size_t numIndependent = variableNames.size();
+  const size_t numKept = numIndependent + dependentVarNames.size();
+
+  /* Values of the row being parsed, only appended to the chunk once the row is known to be complete. */
+  std::vector<double> rowValues(numKept);
+
+  /* Reused cell buffer so that reading a cell does not allocate once its capacity is large enough. */
+  std::string cellValue;
+
+  size_t rowIndex = 0;
+  size_t colIndex;
+  size_t keptCounter;
+  bool missing;
+
+  for (const auto row: csv)
+  {
+    colIndex = 0;
+    keptCounter = 0;
+    missing = false;
+
+    for (const auto cell: row)
+    {
+      /* Ignore trailing cells that are not in the header. */
+      if (colIndex >= projection.size())
+      {
+        break;
+      }
+
+      const ColumnTarget& target = projection[colIndex];
+
+      if (target.keep)
+      {
+        cellValue.clear();
+        cell.read_value(cellValue);
+
+        if (cellValue.empty() || cellValue == MISSING_VALUE_MARKER)
+        {
+          missing = true;
+        }
+        else
+        {
+          rowValues[target.dependent ? numIndependent + target.index : target.index] =
+              parse_value(cellValue, columnNames[colIndex], rowIndex);
+        }
+
+        keptCounter++;
+      }
+
+      colIndex++;
+    }
+
+    /* Skip empty lines, reject truncated rows. */
+    if (keptCounter == 0 && colIndex <= 1)
+    {
+      continue;
+    }
+    else if (keptCounter != numKept)
+    {
+      throw std::runtime_error("Data row " + std::to_string(rowIndex + 1) + " of " + inputFile
+          + " does not have a value for every included column.");
+    }
+
+    rowIndex++;
+
+    if (missing)
+    {
+      if (!skipMissing)
+      {
+        throw std::runtime_error("Data row " + std::to_string(rowIndex) + " of " + inputFile
+            + " has a missing value in an included column.");
+      }
+
+      pReport->numSkippedRows++;
+      continue;
+    }
+
+    for (size_t i = 0; i < numIndependent; ++i)
+    {
+      pChunk->appendX(i, rowValues[i], pReport->roundingError);
+    }
+    for (size_t i = numIndependent; i < numKept; ++i)
+    {
+      pChunk->appendY(i - numIndependent, rowValues[i], pReport->roundingError);
+    }
+    pChunk->commitRow();
+  }
+
+  pReport->numRows = pChunk->numRows;
+}
+
+/**
+ * Parse a single input file into the given chunk. The column names are read from the header row of the file, unless
+ * they are given, in which case the file has no header row.
+ */
+template<typename T>
+void read_file(const std::string& inputFile, const std::vector<std::string>& columnNames,
+    const std::vector<std::string>& includeVars, const std::vector<std::string>& dependentVarNames,
+    const std::vector<std::string>& variableNames, bool skipMissing, ColumnChunk<T>* pChunk, FileReport* pReport)
+{
+  pReport->numRows = 0;
+  pReport->numSkippedRows = 0;
+  pReport->roundingError = false;
+  pReport->shiftedHeader = false;
+
+  if (columnNames.empty())
+  {
+    CsvReader csv;
+    open_csv(&csv, inputFile);
+    read_rows<T>(csv, inputFile, read_header(csv, &pReport->shiftedHeader), includeVars, dependentVarNames,
+        variableNames, skipMissing, pChunk, pReport);
+  }
+  else
+  {
+    HeaderlessCsvReader csv;
+    open_csv(&csv, inputFile);
+    read_rows<T>(csv, inputFile, columnNames, includeVars, dependentVarNames, variableNames, skipMissing, pChunk,
+        pReport);
+  }
+}
+
+/**
+ * Parse the input files concurrently, one file per task, and concatenate the resulting chunks in file order.
+ */
+template<typename T>
+std::unique_ptr<Data> read_files(const std::vector<std::string>& inputFiles, const std::vector<std::string>& columnNames,
+    const std::vector<std::string>& includeVars, const std::vector<std::string>& dependentVarNames,
+    const std::vector<std::string>& variableNames, bool skipMissing, uint numThreads, std::ostream& verbose_out)
+{
+  std::unique_ptr<ColumnData<T>> data = make_unique<ColumnData<T>>(variableNames, dependentVarNames.size());
+
+  const size_t numFiles = inputFiles.size();
+  std::vector<ColumnChunk<T>> chunks(numFiles, data->createChunk());
+  std::vector<FileReport> reports(numFiles);
+  std::vector<std::exception_ptr> errors(numFiles);
+
+  /* Each worker grabs the next file that has not been parsed yet. */
+  std::atomic<size_t> nextFile(0);
+  auto worker = [&]()
+  {
+    size_t i;
+    while ((i = nextFile++) < numFiles)
+    {
+      try
+      {
+        read_file<T>(inputFiles[i], columnNames, includeVars, dependentVarNames, variableNames, skipMissing, &chunks[i],
+            &reports[i]);
+      }
+      catch (...)
+      {
+        errors[i] = std::current_exception();
+      }
+    }
+  };
+
+  /* Default to one thread per CPU, never more threads than files. */
+  if (numThreads == DEFAULT_NUM_THREADS)
+  {
+    numThreads = std::thread::hardware_concurrency();
+  }
+  numThreads = std::max<uint>(1, std::min<uint>(numThreads, numFiles));
+
+  std::vector<std::thread> threads;
+  for (uint t = 1; t < numThreads; ++t)
+  {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  bool roundingError = false;
+
+  for (size_t i = 0; i < numFiles; ++i)
+  {
+    if (errors[i])
+    {
+      std::rethrow_exception(errors[i]);
+    }
+
+    if (reports[i].shiftedHeader)
+    {
+      verbose_out << "The header of " << inputFiles[i] << " is shifted by one column, its names were moved one column "
+          << "to the right and its first column named " << SHIFTED_HEADER_FIRST_COLUMN << "." << std::endl;
+    }
+
+    verbose_out << "Loaded " << reports[i].numRows << " rows from " << inputFiles[i];
+    if (reports[i].numSkippedRows > 0)
+    {
+      verbose_out << ", skipped " << reports[i].numSkippedRows << " rows with missing values";
+    }
+    verbose_out << "." << std::endl;
+
+    roundingError = roundingError || reports[i].roundingError;
+
+    /* The chunk's columns are moved into the Data matrix, not copied. */
+    data->addChunk(std::move(chunks[i]));
+  }
+
+  if (roundingError)
+  {
+    verbose_out << "Warning: Rounding or Integer overflow occurred. Use FLOAT or DOUBLE precision to avoid this." << std::endl;
+  }
+
+  return data;
+}
+
+/**
+ * Create the single row given as command arguments.
+ */
+template<typename T>
+std::unique_ptr<Data> read_inline(const std::vector<std::string>& includeVars, const std::vector<std::string>& inputVars,
+    const std::vector<ColumnTarget>& projection, const std::vector<std::string>& variableNames,
+    size_t numDependentVariables, bool& roundingError)
+{
+  std::unique_ptr<ColumnData<T>> data = make_unique<ColumnData<T>>(variableNames, numDependentVariables);
+  ColumnChunk<T> chunk = data->createChunk();
+
+  for (size_t col = 0; col < inputVars.size(); ++col)
+  {
+    double value = parse_value(inputVars[col], includeVars[col], 0);
+
+    if (projection[col].dependent)
+    {
+      chunk.appendY(projection[col].index, value, roundingError);
+    }
+    else
+    {
+      chunk.appendX(projection[col].index, value, roundingError);
+    }
+  }
+
+  chunk.commitRow();
+  data->addChunk(std::move(chunk));
+
+  return data;
+}
+
+} // namespace
+
+std::vector<std::string> expand_input_files(const std::string& fileArgument)
+{
+  std::vector<std::string> inputFiles;
+  std::stringstream ss(fileArgument);
+  std::string pattern;
+
+  while (std::getline(ss, pattern, ','))
+  {
+    if (pattern.empty())
+    {
+      continue;
+    }
+
+    /* Plain file names are kept as is, a missing file is reported when it is opened. */
+    if (pattern.find_first_of("*?[") == std::string::npos)
+    {
+      inputFiles.push_back(pattern);
+      continue;
+    }
+
+    /* Glob matches are sorted so that rows are always loaded in the same order. */
+    glob_t globResult;
+    int status = glob(pattern.c_str(), 0, nullptr, &globResult);
+    if (status == 0)
+    {
+      for (size_t i = 0; i < globResult.gl_pathc; ++i)
+      {
+        inputFiles.push_back(globResult.gl_pathv[i]);
+      }
+    }
+    globfree(&globResult);
+
+    if (status != 0)
+    {
+      throw std::runtime_error("No input file matches the pattern: " + pattern + ".");
+    }
+  }
+
+  if (inputFiles.empty())
+  {
+    throw std::runtime_error("No input file given.");
+  }
+
+  return inputFiles;
+}
+
+std::unique_ptr<Data> load_csv_data(const std::vector<std::string>& inputFiles, const std::vector<std::string>& columnNames,
+    const std::vector<std::string>& includeVars, const std::vector<std::string>& dependentVarNames, MemoryMode memMode,
+    uint numThreads, std::ostream& verbose_out, bool skipMissing)
+{
+  for (const auto& inputFile : inputFiles)
+  {
+    verbose_out << "Loading input file: " << inputFile << "." << std::endl;
+  }
+
+  /* The given column names or else the header of the first file define the order of the independent variables. */
+  std::vector<std::string> variableNames;
+  if (columnNames.empty())
+  {
+    CsvReader csv;
+    open_csv(&csv, inputFiles.front());
+    bool shiftedHeader;
+    variableNames = select_variable_names(read_header(csv, &shiftedHeader), includeVars, dependentVarNames);
+  }
+  else
+  {
+    variableNames = select_variable_names(columnNames, includeVars, dependentVarNames);
+  }
+
+  std::unique_ptr<Data> data { };
+
+  switch (memMode)
+  {
+    case MEM_DOUBLE:
+      data = read_files<double>(inputFiles, columnNames, includeVars, dependentVarNames, variableNames, skipMissing,
+          numThreads, verbose_out);
+      break;
+    case MEM_FLOAT:
+      data = read_files<float>(inputFiles, columnNames, includeVars, dependentVarNames, variableNames, skipMissing,
+          numThreads, verbose_out);
+      break;
+    case MEM_CHAR:
+      data = read_files<char>(inputFiles, columnNames, includeVars, dependentVarNames, variableNames, skipMissing,
+          numThreads, verbose_out);
+      break;
+  }
+
+  return data;
+}
+
+std::unique_ptr<Data> load_inline_data(const std::vector<std::string>& includeVars, const std::vector<std::string>& inputVars,
+    const std::vector<std::string>& dependentVarNames, MemoryMode memMode)
+{
+  std::vector<std::string> variableNames = select_variable_names(includeVars, includeVars, dependentVarNames);
+  std::vector<ColumnTarget> projection = build_projection(includeVars, includeVars, dependentVarNames, variableNames);
+
+  std::unique_ptr<Data> data { };
+  bool roundingError = false;
+
+  switch (memMode)
+  {
+    case MEM_DOUBLE:
+      data = read_inline<double>(includeVars, inputVars, projection, variableNames, dependentVarNames.size(), roundingError);
+      break;
+    case MEM_FLOAT:
+      data = read_inline<float>(includeVars, inputVars, projection, variableNames, dependentVarNames.size(), roundingError);
+      break;
+    case MEM_CHAR:
+      data = read_inline<char>(includeVars, inputVars, projection, variableNames, dependentVarNames.size(), roundingError);
+      break;
+  }
+
+  return data;
+}
+
+} // namespace ranger
@@ -0,0 +1,46 @@
+#ifndef CSV_DATA_LOADER_H_
+#define CSV_DATA_LOADER_H_
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "globals.h"
+#include "Data.h"
+
+namespace ranger
+{
+
+/**
+ * Turn the '--file' argument into a list of input files.
+ * The argument is a comma separated list of file names and/or glob patterns, e.g. "results/data/data_2021-*.csv".
+ */
+std::vector<std::string> expand_input_files(const std::string& fileArgument);
+
+/**
+ * Parse the given CSV files straight into ranger's in-memory Data matrix.
+ * The columns are named by the header row of each file, unless columnNames gives the names of the columns by
+ * position, in which case the files have no header row (e.g. the training.csv logs of the Mochi server). A header
+ * shifted by one column, as in the telemetry files of results/data, is shifted back.
+ * Only the columns listed in includeVars are kept (all columns if the list is empty) and the columns named in
+ * dependentVarNames become the dependent variables. Each file is memory mapped and every kept cell is converted
+ * to a number exactly once, no intermediate CSV file is written.
+ * Files are parsed concurrently with up to numThreads threads (0 for one per CPU) and their rows concatenated in
+ * the given order. Rows with a missing value ("x" or empty cell) in a kept column are skipped, unless skipMissing is
+ * false, e.g. for predictions that must match the input rows one to one, in which case such a row is an error.
+ */
+std::unique_ptr<Data> load_csv_data(const std::vector<std::string>& inputFiles, const std::vector<std::string>& columnNames,
+    const std::vector<std::string>& includeVars, const std::vector<std::string>& dependentVarNames, MemoryMode memMode,
+    uint numThreads, std::ostream& verbose_out, bool skipMissing = true);
+
+/**
+ * Create a single row Data matrix from values given "in-line" as command arguments.
+ * The includeVars and inputVars vectors are expected to have the same size.
+ */
+std::unique_ptr<Data> load_inline_data(const std::vector<std::string>& includeVars, const std::vector<std::string>& inputVars,
+    const std::vector<std::string>& dependentVarNames, MemoryMode memMode);
+
+} // namespace ranger
+
+#endif // CSV_DATA_LOADER_H_
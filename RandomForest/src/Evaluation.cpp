@@ -0,0 +1,438 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "ForestClassification.h"
+
+#include "CsvDataLoader.hpp"
+#include "Evaluation.hpp"
+#include "FlatForest.hpp"
+#include "InMemoryForest.hpp"
+#include "RowSubsetData.hpp"
+
+namespace ranger
+{
+
+namespace
+{
+
+/**
+ * Seed like ranger does: from a random device when the seed is 0.
+ */
+std::mt19937_64 create_random_number_generator(uint seed)
+{
+  std::mt19937_64 random_number_generator;
+  if (seed == 0)
+  {
+    std::random_device random_device;
+    random_number_generator.seed(random_device());
+  }
+  else
+  {
+    random_number_generator.seed(seed);
+  }
+  return random_number_generator;
+}
+
+/**
+ * Sorted distinct values of the first dependent variable of the given matrices.
+ */
+std::vector<double> class_values(const std::vector<const Data*>& datas)
+{
+  std::vector<double> values;
+  for (const Data* pData : datas)
+  {
+    for (size_t row = 0; row < pData->getNumRows(); ++row)
+    {
+      values.push_back(pData->get_y(row, 0));
+    }
+  }
+  std::sort(values.begin(), values.end());
+  values.erase(std::unique(values.begin(), values.end()), values.end());
+  return values;
+}
+
+/**
+ * Train a classification forest on the training data and count its predictions of the test data.
+ */
+void train_and_evaluate(const ArgumentHandler& arg_handler, std::unique_ptr<Data> trainingData, const Data& testData,
+    uint numThreads, ConfusionMatrix* pConfusionMatrix)
+{
+  InMemoryForest<ForestClassification> forest;
+  forest.initDependentVariableNames(arg_handler);
+
+  /* Forests may be trained concurrently, their progress messages would interleave. */
+  forest.initInMemory(std::move(trainingData), arg_handler, nullptr, numThreads);
+  forest.run(false, false);
+
+  if (!forest.canFlatten(TREE_CLASSIFICATION))
+  {
+    throw std::runtime_error("Evaluation is not supported for forests with unordered variables.");
+  }
+
+  const FlatForest flatForest(forest.getChildNodeIDs(), forest.getSplitVarIDs(), forest.getSplitValues(),
+      forest.getNumIndependentVariables());
+
+  std::vector<double> predictions;
+  flatForest.predictAll(testData, TREE_CLASSIFICATION, create_random_number_generator(arg_handler.seed), numThreads,
+      predictions);
+
+  for (size_t row = 0; row < testData.getNumRows(); ++row)
+  {
+    pConfusionMatrix->add(testData.get_y(row, 0), predictions[row]);
+  }
+}
+
+/**
+ * Write the report to the verbose output and to <outprefix>.evaluation.
+ */
+void write_report(const ArgumentHandler& arg_handler, const std::string& report, std::ostream& verbose_out)
+{
+  verbose_out << report;
+
+  const std::string filename = arg_handler.outprefix + ".evaluation";
+  std::ofstream outfile(filename, std::ios::out);
+  if (!outfile.good())
+  {
+    throw std::runtime_error("Could not write to evaluation file: " + filename + ".");
+  }
+  outfile << report;
+
+  verbose_out << "Saved evaluation to file " << filename << "." << std::endl;
+}
+
+/**
+ * Check the arguments shared by the evaluation modes.
+ */
+void check_evaluation_arguments(const ArgumentHandler& arg_handler)
+{
+  if (arg_handler.treetype != TREE_CLASSIFICATION || arg_handler.probability)
+  {
+    throw std::runtime_error("Evaluation is only supported for classification forests (--treetype 1).");
+  }
+
+  if (arg_handler.file.empty() || !arg_handler.predict.empty())
+  {
+    throw std::runtime_error("Evaluation trains new forests on the --file data and cannot be combined with --predict.");
+  }
+
+  if (!arg_handler.caseweights.empty())
+  {
+    throw std::runtime_error("Evaluation does not support case weights.");
+  }
+}
+
+} // namespace
+
+/**
+ * Constructor.
+ */
+ConfusionMatrix::ConfusionMatrix(const std::vector<double>& classValues) :
+    m_classValues(classValues), m_counts(classValues.size() * classValues.size(), 0)
+{
+}
+
+size_t ConfusionMatrix::classIndex(double classValue) const
+{
+  auto it = std::lower_bound(m_classValues.begin(), m_classValues.end(), classValue);
+  if (it == m_classValues.end() || *it != classValue)
+  {
+    throw std::runtime_error("Unknown class value in evaluation.");
+  }
+  return it - m_classValues.begin();
+}
+
+/**
+ * Count a prediction.
+ */
+void ConfusionMatrix::add(double trueValue, double predictedValue)
+{
+  ++m_counts[classIndex(trueValue) * m_classValues.size() + classIndex(predictedValue)];
+}
+
+/**
+ * Add the counts of another matrix with the same classes.
+ */
+void ConfusionMatrix::add(const ConfusionMatrix& other)
+{
+  for (size_t i = 0; i < m_counts.size(); ++i)
+  {
+    m_counts[i] += other.m_counts[i];
+  }
+}
+
+size_t ConfusionMatrix::getNumSamples() const
+{
+  return std::accumulate(m_counts.begin(), m_counts.end(), size_t(0));
+}
+
+double ConfusionMatrix::recall(size_t classIndex) const
+{
+  const size_t numClasses = m_classValues.size();
+  size_t numTrue = 0;
+  for (size_t predicted = 0; predicted < numClasses; ++predicted)
+  {
+    numTrue += m_counts[classIndex * numClasses + predicted];
+  }
+  return numTrue == 0 ? 0 : (double) m_counts[classIndex * numClasses + classIndex] / numTrue;
+}
+
+double ConfusionMatrix::precision(size_t classIndex) const
+{
+  const size_t numClasses = m_classValues.size();
+  size_t numPredicted = 0;
+  for (size_t actual = 0; actual < numClasses; ++actual)
+  {
+    numPredicted += m_counts[actual * numClasses + classIndex];
+  }
+  return numPredicted == 0 ? 0 : (double) m_counts[classIndex * numClasses + classIndex] / numPredicted;
+}
+
+double ConfusionMatrix::f1(size_t classIndex) const
+{
+  const double p = precision(classIndex);
+  const double r = recall(classIndex);
+  return p + r == 0 ? 0 : 2 * p * r / (p + r);
+}
+
+/**
+ * Mean of the recalls of the classes that have samples.
+ */
+double ConfusionMatrix::balancedAccuracy() const
+{
+  const size_t numClasses = m_classValues.size();
+  double sum = 0;
+  size_t numPresent = 0;
+  for (size_t c = 0; c < numClasses; ++c)
+  {
+    if (std::accumulate(m_counts.begin() + c * numClasses, m_counts.begin() + (c + 1) * numClasses, size_t(0)) > 0)
+    {
+      sum += recall(c);
+      ++numPresent;
+    }
+  }
+  return numPresent == 0 ? 0 : sum / numPresent;
+}
+
+/**
+ * Mean of the F1 scores of the classes that have samples.
+ */
+double ConfusionMatrix::macroF1() const
+{
+  const size_t numClasses = m_classValues.size();
+  double sum = 0;
+  size_t numPresent = 0;
+  for (size_t c = 0; c < numClasses; ++c)
+  {
+    if (std::accumulate(m_counts.begin() + c * numClasses, m_counts.begin() + (c + 1) * numClasses, size_t(0)) > 0)
+    {
+      sum += f1(c);
+      ++numPresent;
+    }
+  }
+  return numPresent == 0 ? 0 : sum / numPresent;
+}
+
+/**
+ * Write the matrix and the per class recall, precision and F1 score.
+ */
+void ConfusionMatrix::write(std::ostream& out) const
+{
+  const size_t numClasses = m_classValues.size();
+  const int width = 10;
+
+  out << "  Confusion matrix (rows: true class, columns: predicted class):" << std::endl;
+  out << "  " << std::setw(width) << " ";
+  for (double classValue : m_classValues)
+  {
+    out << std::setw(width) << classValue;
+  }
+  out << std::setw(width + 2) << "recall" << std::setw(width) << "precision" << std::setw(width) << "F1" << std::endl;
+
+  for (size_t actual = 0; actual < numClasses; ++actual)
+  {
+    out << "  " << std::setw(width) << m_classValues[actual];
+    for (size_t predicted = 0; predicted < numClasses; ++predicted)
+    {
+      out << std::setw(width) << m_counts[actual * numClasses + predicted];
+    }
+    out << std::fixed << std::setprecision(4) << std::setw(width + 2) << recall(actual) << std::setw(width)
+        << precision(actual) << std::setw(width) << f1(actual) << std::defaultfloat << std::endl;
+  }
+}
+
+/**
+ * Stratified k-fold cross-validation of a classification forest on the '--file' data.
+ */
+void run_cross_validation(const ArgumentHandler& arg_handler, uint numFolds, const std::vector<std::string>& columnNames,
+    std::ostream& verbose_out)
+{
+  check_evaluation_arguments(arg_handler);
+
+  std::vector<std::string> dependentVarNames = { arg_handler.depvarname };
+  std::unique_ptr<Data> data = load_csv_data(expand_input_files(arg_handler.file), columnNames, arg_handler.includevars,
+      dependentVarNames, arg_handler.memmode, arg_handler.nthreads, verbose_out);
+
+  const size_t numSamples = data->getNumRows();
+  if (numFolds < 2 || numFolds > numSamples)
+  {
+    throw std::runtime_error("The number of folds must be between 2 and the number of samples.");
+  }
+
+  /* Stratified folds: shuffle, group the rows by class and deal them out to the folds. */
+  std::vector<size_t> rows(numSamples);
+  std::iota(rows.begin(), rows.end(), 0);
+  std::mt19937_64 random_number_generator = create_random_number_generator(arg_handler.seed);
+  std::shuffle(rows.begin(), rows.end(), random_number_generator);
+  std::stable_sort(rows.begin(), rows.end(), [&data](size_t a, size_t b)
+  {
+    return data->get_y(a, 0) < data->get_y(b, 0);
+  });
+
+  std::vector<size_t> folds(numSamples);
+  for (size_t i = 0; i < numSamples; ++i)
+  {
+    folds[rows[i]] = i % numFolds;
+  }
+
+  const std::vector<double> classValues = class_values({ data.get() });
+  std::vector<ConfusionMatrix> confusionMatrices(numFolds, ConfusionMatrix(classValues));
+
+  /* Train the folds concurrently and share the threads between them. */
+  uint numThreads = arg_handler.nthreads;
+  if (numThreads == DEFAULT_NUM_THREADS)
+  {
+    numThreads = std::thread::hardware_concurrency();
+  }
+  const uint numWorkers = std::max<uint>(1, std::min<uint>(numThreads, numFolds));
+  const uint numThreadsPerFold = std::max<uint>(1, numThreads / numWorkers);
+
+  verbose_out << "Training " << numFolds << " folds, " << numWorkers << " at a time with " << numThreadsPerFold
+      << " threads each .." << std::endl;
+
+  std::atomic<uint> nextFold(0);
+  std::vector<std::exception_ptr> errors(numFolds);
+
+  auto worker = [&]()
+  {
+    for (uint fold = nextFold++; fold < numFolds; fold = nextFold++)
+    {
+      try
+      {
+        std::vector<size_t> trainingRows;
+        std::vector<size_t> testRows;
+        for (size_t row = 0; row < numSamples; ++row)
+        {
+          (folds[row] == fold ? testRows : trainingRows).push_back(row);
+        }
+
+        std::unique_ptr<Data> trainingData(new RowSubsetData(*data, std::move(trainingRows)));
+        const RowSubsetData testData(*data, std::move(testRows));
+        train_and_evaluate(arg_handler, std::move(trainingData), testData, numThreadsPerFold, &confusionMatrices[fold]);
+      }
+      catch (...)
+      {
+        errors[fold] = std::current_exception();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (uint w = 0; w < numWorkers; ++w)
+  {
+    threads.emplace_back(worker);
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  for (const auto& error : errors)
+  {
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+  }
+
+  /* Report. */
+  std::ostringstream report;
+  report << "Stratified " << numFolds << "-fold cross-validation of " << numSamples << " samples, " << arg_handler.ntree
+      << " trees per fold." << std::endl << std::endl;
+
+  ConfusionMatrix total(classValues);
+  std::vector<double> balancedAccuracies;
+  for (uint fold = 0; fold < numFolds; ++fold)
+  {
+    const ConfusionMatrix& matrix = confusionMatrices[fold];
+    report << "Fold " << fold + 1 << " (" << matrix.getNumSamples() << " test samples): balanced accuracy "
+        << std::fixed << std::setprecision(4) << matrix.balancedAccuracy() << ", F1 (macro) " << matrix.macroF1()
+        << std::defaultfloat << std::endl;
+    matrix.write(report);
+    report << std::endl;
+
+    total.add(matrix);
+    balancedAccuracies.push_back(matrix.balancedAccuracy());
+  }
+
+  const double mean = std::accumulate(balancedAccuracies.begin(), balancedAccuracies.end(), 0.0) / numFolds;
+  double variance = 0;
+  for (double balancedAccuracy : balancedAccuracies)
+  {
+    variance += (balancedAccuracy - mean) * (balancedAccuracy - mean);
+  }
+
+  report << "All folds: balanced accuracy " << std::fixed << std::setprecision(4) << total.balancedAccuracy()
+      << " (mean over folds " << mean << ", standard deviation " << std::sqrt(variance / (numFolds - 1))
+      << "), F1 (macro) " << total.macroF1() << std::defaultfloat << std::endl;
+  total.write(report);
+
+  write_report(arg_handler, report.str(), verbose_out);
+}
+
+/**
+ * Holdout evaluation: train on the '--file' data and evaluate on the given test file.
+ */
+void run_holdout_evaluation(const ArgumentHandler& arg_handler, const std::string& testFile,
+    const std::vector<std::string>& columnNames, std::ostream& verbose_out)
+{
+  check_evaluation_arguments(arg_handler);
+
+  std::vector<std::string> dependentVarNames = { arg_handler.depvarname };
+  std::unique_ptr<Data> trainingData = load_csv_data(expand_input_files(arg_handler.file), columnNames, arg_handler.includevars,
+      dependentVarNames, arg_handler.memmode, arg_handler.nthreads, verbose_out);
+  std::unique_ptr<Data> testData = load_csv_data(expand_input_files(testFile), columnNames, arg_handler.includevars,
+      dependentVarNames, arg_handler.memmode, arg_handler.nthreads, verbose_out);
+
+  if (testData->getVariableNames() != trainingData->getVariableNames())
+  {
+    throw std::runtime_error("The independent variables of the test data do not match the ones of the training data.");
+  }
+
+  ConfusionMatrix matrix(class_values({ trainingData.get(), testData.get() }));
+  const size_t numTrainingSamples = trainingData->getNumRows();
+
+  verbose_out << "Training on " << numTrainingSamples << " samples .." << std::endl;
+  train_and_evaluate(arg_handler, std::move(trainingData), *testData, arg_handler.nthreads, &matrix);
+
+  std::ostringstream report;
+  report << "Holdout evaluation on " << testFile << ", " << arg_handler.ntree << " trees trained on "
+      << numTrainingSamples << " samples." << std::endl << std::endl;
+  report << "Test data (" << matrix.getNumSamples() << " samples): balanced accuracy " << std::fixed
+      << std::setprecision(4) << matrix.balancedAccuracy() << ", F1 (macro) " << matrix.macroF1()
+      << std::defaultfloat << std::endl;
+  matrix.write(report);
+
+  write_report(arg_handler, report.str(), verbose_out);
+}
+
+} // namespace ranger
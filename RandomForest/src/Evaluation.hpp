@@ -0,0 +1,86 @@
+#ifndef EVALUATION_H_
+#define EVALUATION_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "globals.h"
+#include "ArgumentHandler.h"
+
+namespace ranger
+{
+
+/**
+ * Confusion matrix of a classification, with rows for the true classes and columns for the predicted classes.
+ */
+class ConfusionMatrix
+{
+private:
+  /* Sorted class values. */
+  std::vector<double> m_classValues;
+
+  /* Counts, row-major. */
+  std::vector<size_t> m_counts;
+
+  size_t classIndex(double classValue) const;
+
+public:
+
+  /* Constructor. */
+  explicit ConfusionMatrix(const std::vector<double>& classValues);
+
+  /**
+   * Count a prediction.
+   */
+  void add(double trueValue, double predictedValue);
+
+  /**
+   * Add the counts of another matrix with the same classes.
+   */
+  void add(const ConfusionMatrix& other);
+
+  size_t getNumSamples() const;
+
+  /**
+   * Mean of the recalls of the classes that have samples.
+   */
+  double balancedAccuracy() const;
+
+  /**
+   * Recall, precision and F1 score of the given class, 0 when undefined.
+   */
+  double recall(size_t classIndex) const;
+  double precision(size_t classIndex) const;
+  double f1(size_t classIndex) const;
+
+  /**
+   * Mean of the F1 scores of the classes that have samples.
+   */
+  double macroF1() const;
+
+  /**
+   * Write the matrix and the per class recall, precision and F1 score.
+   */
+  void write(std::ostream& out) const;
+};
+
+/**
+ * Stratified k-fold cross-validation of a classification forest on the '--file' data.
+ * The data is loaded once and the folds only hold row indices. Folds are trained concurrently, sharing the
+ * '--nthreads' threads, and the balanced accuracy, F1 score and confusion matrix of every fold and of all folds
+ * together are written to verbose_out and to <outprefix>.evaluation.
+ */
+void run_cross_validation(const ArgumentHandler& arg_handler, uint numFolds, const std::vector<std::string>& columnNames,
+    std::ostream& verbose_out);
+
+/**
+ * Holdout evaluation: train a classification forest on the '--file' data and evaluate it on the given test file,
+ * reported like a cross-validation fold.
+ */
+void run_holdout_evaluation(const ArgumentHandler& arg_handler, const std::string& testFile,
+    const std::vector<std::string>& columnNames, std::ostream& verbose_out);
+
+} // namespace ranger
+
+#endif // EVALUATION_H_
@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#include "utility.h"
+
+#include "FlatForest.hpp"
+
+namespace ranger
+{
+
+/**
+ * Flatten the trees given in ranger's per tree layout.
+ */
+FlatForest::FlatForest(const std::vector<std::vector<std::vector<size_t>>>& childNodeIDs,
+    const std::vector<std::vector<size_t>>& splitVarIDs, const std::vector<std::vector<double>>& splitValues,
+    size_t numVariables) :
+    m_numVariables(numVariables)
+{
+  if (numVariables > MAX_NUM_VARIABLES)
+  {
+    throw std::runtime_error("Too many independent variables to flatten the forest.");
+  }
+
+  size_t numNodes = 0;
+  for (const auto& treeSplitValues : splitValues)
+  {
+    numNodes += treeSplitValues.size();
+  }
+
+  m_splitVarIDs.reserve(numNodes);
+  m_thresholds.reserve(numNodes);
+  m_leftChildIDs.reserve(numNodes);
+  m_values.reserve(numNodes);
+  m_rootIDs.reserve(splitValues.size());
+
+  /* Node IDs of the tree being flattened, in breadth-first order. */
+  std::queue<size_t> nodeQueue;
+
+  for (size_t tree = 0; tree < splitValues.size(); ++tree)
+  {
+    const std::vector<size_t>& leftChildren = childNodeIDs[tree][0];
+    const std::vector<size_t>& rightChildren = childNodeIDs[tree][1];
+
+    m_rootIDs.push_back(static_cast<uint32_t>(m_values.size()));
+
+    /* Flat index that the next pair of children will get. */
+    size_t nextFlatID = m_values.size() + 1;
+
+    nodeQueue.push(0);
+    while (!nodeQueue.empty())
+    {
+      size_t nodeID = nodeQueue.front();
+      nodeQueue.pop();
+
+      const bool terminal = leftChildren[nodeID] == 0 && rightChildren[nodeID] == 0;
+
+      m_values.push_back(splitValues[tree][nodeID]);
+
+      if (terminal)
+      {
+        m_splitVarIDs.push_back(0);
+        m_thresholds.push_back(0);
+        m_leftChildIDs.push_back(0);
+      }
+      else
+      {
+        m_splitVarIDs.push_back(static_cast<uint16_t>(splitVarIDs[tree][nodeID]));
+        m_thresholds.push_back(roundDown(splitValues[tree][nodeID]));
+        m_leftChildIDs.push_back(static_cast<uint32_t>(nextFlatID));
+
+        /* Children are queued together so that they end up next to each other. */
+        nodeQueue.push(leftChildren[nodeID]);
+        nodeQueue.push(rightChildren[nodeID]);
+        nextFlatID += 2;
+      }
+    }
+  }
+
+  m_pSplitVarIDs = m_splitVarIDs.data();
+  m_pThresholds = m_thresholds.data();
+  m_pLeftChildIDs = m_leftChildIDs.data();
+  m_pValues = m_values.data();
+  m_pRootIDs = m_rootIDs.data();
+  m_numTrees = m_rootIDs.size();
+  m_numNodes = m_values.size();
+}
+
+/**
+ * Use already flattened arrays without copying them.
+ */
+FlatForest::FlatForest(size_t numTrees, size_t numNodes, size_t numVariables, const uint32_t* pRootIDs,
+    const uint16_t* pSplitVarIDs, const float* pThresholds, const uint32_t* pLeftChildIDs, const double* pValues) :
+    m_pSplitVarIDs(pSplitVarIDs), m_pThresholds(pThresholds), m_pLeftChildIDs(pLeftChildIDs), m_pValues(pValues),
+    m_pRootIDs(pRootIDs), m_numTrees(numTrees), m_numNodes(numNodes), m_numVariables(numVariables)
+{
+}
+
+/**
+ * Predict the samples [firstSample, lastSample) of the given data with every tree.
+ */
+void FlatForest::predict(const Data& data, size_t firstSample, size_t lastSample, double* pTreePredictions) const
+{
+  const size_t numTrees = m_numTrees;
+
+  /* Row-major copies of the sample block, rounded down to floats and exact. */
+  std::vector<float> keys(FLAT_FOREST_BLOCK_SIZE * m_numVariables);
+  std::vector<double> values(FLAT_FOREST_BLOCK_SIZE * m_numVariables);
+
+  for (size_t blockStart = firstSample; blockStart < lastSample; blockStart += FLAT_FOREST_BLOCK_SIZE)
+  {
+    const size_t blockSize = std::min<size_t>(FLAT_FOREST_BLOCK_SIZE, lastSample - blockStart);
+
+    /* Gather the block once instead of going through the Data interface at every node. */
+    for (size_t s = 0; s < blockSize; ++s)
+    {
+      for (size_t var = 0; var < m_numVariables; ++var)
+      {
+        const double value = data.get_x(blockStart + s, var);
+        values[s * m_numVariables + var] = value;
+        keys[s * m_numVariables + var] = roundDown(value);
+      }
+    }
+
+    double* pBlockPredictions = pTreePredictions + (blockStart - firstSample) * numTrees;
+
+    /* Run the whole block through one tree before moving to the next so that the tree stays in cache. */
+    for (size_t tree = 0; tree < numTrees; ++tree)
+    {
+      const uint32_t rootID = m_pRootIDs[tree];
+
+      for (size_t s = 0; s < blockSize; ++s)
+      {
+        const float* pKeys = &keys[s * m_numVariables];
+        uint32_t nodeID = rootID;
+
+        while (m_pLeftChildIDs[nodeID] != 0)
+        {
+          const uint16_t varID = m_pSplitVarIDs[nodeID];
+          const float key = pKeys[varID];
+          const float threshold = m_pThresholds[nodeID];
+
+          /* Same float means the decision can only be made with the exact values. Ranger sends the values that are
+           * not <= the split value to the right, NaN included, so the comparisons are negated rather than flipped. */
+          bool right;
+          if (key != threshold)
+          {
+            right = !(key <= threshold);
+          }
+          else
+          {
+            right = !(values[s * m_numVariables + varID] <= m_pValues[nodeID]);
+          }
+
+          nodeID = m_pLeftChildIDs[nodeID] + (right ? 1 : 0);
+        }
+
+        pBlockPredictions[s * numTrees + tree] = m_pValues[nodeID];
+      }
+    }
+  }
+}
+
+/**
+ * Predict all samples of the given data and aggregate the trees like ranger does.
+ */
+void FlatForest::predictAll(const Data& data, TreeType treetype, const std::mt19937_64& random_number_generator,
+    uint numThreads, std::vector<double>& predictions) const
+{
+  const size_t numSamples = data.getNumRows();
+  predictions.assign(numSamples, 0);
+
+  /* Split the samples in ranges of whole blocks, one range per thread. */
+  const size_t numBlocks = (numSamples + FLAT_FOREST_BLOCK_SIZE - 1) / FLAT_FOREST_BLOCK_SIZE;
+  const size_t numRanges = std::max<size_t>(1, std::min<size_t>(numThreads, numBlocks));
+  const size_t blocksPerRange = (numBlocks + numRanges - 1) / numRanges;
+
+  auto worker = [&](size_t firstSample, size_t lastSample)
+  {
+    std::vector<double> treePredictions(FLAT_FOREST_BLOCK_SIZE * m_numTrees);
+
+    for (size_t blockStart = firstSample; blockStart < lastSample; blockStart += FLAT_FOREST_BLOCK_SIZE)
+    {
+      const size_t blockEnd = std::min<size_t>(blockStart + FLAT_FOREST_BLOCK_SIZE, lastSample);
+      predict(data, blockStart, blockEnd, treePredictions.data());
+
+      for (size_t sample = blockStart; sample < blockEnd; ++sample)
+      {
+        const double* pSamplePredictions = &treePredictions[(sample - blockStart) * m_numTrees];
+
+        if (treetype == TREE_CLASSIFICATION)
+        {
+          /* Count classes over trees and save class with maximum count, as in ForestClassification. */
+          std::unordered_map<double, size_t> class_count;
+          for (size_t tree = 0; tree < m_numTrees; ++tree)
+          {
+            ++class_count[pSamplePredictions[tree]];
+          }
+          predictions[sample] = mostFrequentValue(class_count, random_number_generator);
+        }
+        else
+        {
+          /* Average over trees, as in ForestRegression. */
+          double prediction_sum = 0;
+          for (size_t tree = 0; tree < m_numTrees; ++tree)
+          {
+            prediction_sum += pSamplePredictions[tree];
+          }
+          predictions[sample] = prediction_sum / m_numTrees;
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t range = 0; range < numRanges; ++range)
+  {
+    const size_t firstSample = std::min(range * blocksPerRange * FLAT_FOREST_BLOCK_SIZE, numSamples);
+    const size_t lastSample = std::min((range + 1) * blocksPerRange * FLAT_FOREST_BLOCK_SIZE, numSamples);
+    threads.emplace_back(worker, firstSample, lastSample);
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+}
+
+/**
+ * Round a value down to the closest float.
+ */
+float FlatForest::roundDown(double value)
+{
+  float result = static_cast<float>(value);
+  if (static_cast<double>(result) > value)
+  {
+    result = std::nextafter(result, -std::numeric_limits<float>::infinity());
+  }
+  return result;
+}
+
+} // namespace ranger
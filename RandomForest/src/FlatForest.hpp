@@ -0,0 +1,147 @@
+#ifndef FLAT_FOREST_H_
+#define FLAT_FOREST_H_
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "globals.h"
+#include "Data.h"
+
+/* Number of samples that go through all the trees before moving on to the next samples. */
+#define FLAT_FOREST_BLOCK_SIZE                                      64
+
+namespace ranger
+{
+
+/**
+ * Cache friendly copy of a trained forest used for prediction.
+ *
+ * The nodes of all trees are stored in contiguous structure-of-arrays in breadth-first order, with the two children
+ * of a node next to each other so that a single child index is needed. The hot arrays hold a 16 bit split variable
+ * index, a float threshold and the child index. The float threshold is the double threshold rounded down; comparing
+ * it with the sample value rounded down gives the exact same decision as ranger unless both round to the same float,
+ * in which case the double values from the cold arrays are compared. Predictions are therefore identical to ranger's.
+ *
+ * The arrays are either owned, when flattening ranger's trees, or borrowed from memory that outlives the forest,
+ * e.g. a memory mapped flat forest file.
+ *
+ * Only ordered split variables are supported.
+ */
+class FlatForest
+{
+private:
+  /* Per node: split variable index. */
+  const uint16_t* m_pSplitVarIDs;
+
+  /* Per node: split value rounded down to a float. */
+  const float* m_pThresholds;
+
+  /* Per node: index of the left child, the right child follows it. 0 for terminal nodes. */
+  const uint32_t* m_pLeftChildIDs;
+
+  /* Per node: exact split value, or the prediction for terminal nodes. */
+  const double* m_pValues;
+
+  /* Index of the root node of each tree. */
+  const uint32_t* m_pRootIDs;
+
+  size_t m_numTrees;
+  size_t m_numNodes;
+
+  /* Number of independent variables. */
+  size_t m_numVariables;
+
+  /* Storage of the arrays when they are owned. */
+  std::vector<uint16_t> m_splitVarIDs;
+  std::vector<float> m_thresholds;
+  std::vector<uint32_t> m_leftChildIDs;
+  std::vector<double> m_values;
+  std::vector<uint32_t> m_rootIDs;
+
+public:
+
+  /* Largest number of independent variables that can be addressed with the compact split variable index. */
+  static const size_t MAX_NUM_VARIABLES = std::numeric_limits<uint16_t>::max();
+
+  /**
+   * Flatten the trees given in ranger's per tree layout.
+   */
+  FlatForest(const std::vector<std::vector<std::vector<size_t>>>& childNodeIDs,
+      const std::vector<std::vector<size_t>>& splitVarIDs, const std::vector<std::vector<double>>& splitValues,
+      size_t numVariables);
+
+  /**
+   * Use already flattened arrays without copying them, they must outlive the forest.
+   */
+  FlatForest(size_t numTrees, size_t numNodes, size_t numVariables, const uint32_t* pRootIDs,
+      const uint16_t* pSplitVarIDs, const float* pThresholds, const uint32_t* pLeftChildIDs, const double* pValues);
+
+  /* The pointers may refer to the owned storage. */
+  FlatForest(const FlatForest&) = delete;
+  FlatForest& operator=(const FlatForest&) = delete;
+
+  size_t getNumTrees() const
+  {
+    return m_numTrees;
+  }
+
+  size_t getNumNodes() const
+  {
+    return m_numNodes;
+  }
+
+  size_t getNumVariables() const
+  {
+    return m_numVariables;
+  }
+
+  const uint32_t* getRootIDs() const
+  {
+    return m_pRootIDs;
+  }
+
+  const uint16_t* getSplitVarIDs() const
+  {
+    return m_pSplitVarIDs;
+  }
+
+  const float* getThresholds() const
+  {
+    return m_pThresholds;
+  }
+
+  const uint32_t* getLeftChildIDs() const
+  {
+    return m_pLeftChildIDs;
+  }
+
+  const double* getValues() const
+  {
+    return m_pValues;
+  }
+
+  /**
+   * Predict the samples [firstSample, lastSample) of the given data with every tree.
+   * The prediction of tree t for sample s is written to pTreePredictions[(s - firstSample) * numTrees + t].
+   */
+  void predict(const Data& data, size_t firstSample, size_t lastSample, double* pTreePredictions) const;
+
+  /**
+   * Predict all samples of the given data with numThreads threads and aggregate the trees like ranger does:
+   * majority vote for classification, with ties broken by mostFrequentValue() with a copy of the given random number
+   * generator, and average over the trees, in tree order, for regression.
+   */
+  void predictAll(const Data& data, TreeType treetype, const std::mt19937_64& random_number_generator,
+      uint numThreads, std::vector<double>& predictions) const;
+
+  /**
+   * Round a value down to the closest float.
+   */
+  static float roundDown(double value);
+};
+
+} // namespace ranger
+
+#endif // FLAT_FOREST_H_
@@ -0,0 +1,380 @@
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "FlatForestFile.hpp"
+
+namespace ranger
+{
+
+namespace
+{
+
+static_assert(sizeof(FlatForestFileHeader) == FLAT_FOREST_FILE_ALIGNMENT, "The header must fill one aligned block.");
+
+/**
+ * Round the offset up to the next multiple of FLAT_FOREST_FILE_ALIGNMENT.
+ */
+uint64_t align(uint64_t offset)
+{
+  return (offset + FLAT_FOREST_FILE_ALIGNMENT - 1) / FLAT_FOREST_FILE_ALIGNMENT * FLAT_FOREST_FILE_ALIGNMENT;
+}
+
+/**
+ * Join names with newlines.
+ */
+std::string join_names(const std::vector<std::string>& names)
+{
+  std::string result;
+  for (const auto& name : names)
+  {
+    result += name;
+    result += '\n';
+  }
+  return result;
+}
+
+/**
+ * Split newline separated names.
+ */
+std::vector<std::string> split_names(const char* pNames, size_t size)
+{
+  std::vector<std::string> names;
+  size_t start = 0;
+  for (size_t i = 0; i < size; ++i)
+  {
+    if (pNames[i] == '\n')
+    {
+      names.emplace_back(pNames + start, i - start);
+      start = i + 1;
+    }
+  }
+  return names;
+}
+
+/**
+ * Pending section: its index entry and its data.
+ */
+struct SectionData
+{
+  FlatForestFileSection section;
+  const void* pData;
+};
+
+/**
+ * Add a section of count elements of type T to the list and lay it out after the previous sections.
+ */
+template<typename T>
+void add_section(std::vector<SectionData>& sections, uint32_t id, const T* pData, size_t count, uint64_t* pOffset)
+{
+  SectionData sectionData;
+  sectionData.section.id = id;
+  sectionData.section.elementSize = sizeof(T);
+  sectionData.section.offset = *pOffset;
+  sectionData.section.count = count;
+  sectionData.pData = pData;
+  sections.push_back(sectionData);
+
+  *pOffset = align(*pOffset + count * sizeof(T));
+}
+
+/**
+ * FNV-1a hash of the header, with a zero checksum, and of the section index.
+ */
+uint64_t header_checksum(const FlatForestFileHeader& header, const FlatForestFileSection* pIndex, uint32_t numSections)
+{
+  FlatForestFileHeader zeroed = header;
+  zeroed.checksum = 0;
+
+  uint64_t hash = 14695981039346656037ULL;
+  const unsigned char* pBytes = reinterpret_cast<const unsigned char*>(&zeroed);
+  for (size_t i = 0; i < sizeof(zeroed); ++i)
+  {
+    hash = (hash ^ pBytes[i]) * 1099511628211ULL;
+  }
+
+  pBytes = reinterpret_cast<const unsigned char*>(pIndex);
+  for (size_t i = 0; i < numSections * sizeof(FlatForestFileSection); ++i)
+  {
+    hash = (hash ^ pBytes[i]) * 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+/**
+ * Find a section in the index and check that it fits in the file, after the index, with the expected element size.
+ */
+const void* find_section(const char* pMapping, size_t mappingSize, const FlatForestFileSection* pIndex,
+    uint32_t numSections, uint32_t id, uint32_t elementSize, uint64_t* pCount)
+{
+  const uint64_t sectionsOffset = align(FLAT_FOREST_FILE_ALIGNMENT + numSections * sizeof(FlatForestFileSection));
+
+  for (uint32_t i = 0; i < numSections; ++i)
+  {
+    const FlatForestFileSection& section = pIndex[i];
+    if (section.id != id)
+    {
+      continue;
+    }
+
+    if (section.elementSize != elementSize || section.offset % FLAT_FOREST_FILE_ALIGNMENT != 0
+        || section.offset < sectionsOffset || section.offset > mappingSize || section.count > (mappingSize - section.offset) / elementSize)
+    {
+      throw std::runtime_error("Corrupted flat forest file: invalid section.");
+    }
+
+    *pCount = section.count;
+    return pMapping + section.offset;
+  }
+
+  throw std::runtime_error("Corrupted flat forest file: missing section.");
+}
+
+/**
+ * Check that the trees only refer to nodes and variables of the forest. In the breadth-first layout the children of a
+ * node come after it, which also rules out cycles, so that every prediction ends on a terminal node.
+ */
+bool nodes_valid(uint64_t numTrees, uint64_t numNodes, uint64_t numVariables, const uint32_t* pRootIDs,
+    const uint16_t* pSplitVarIDs, const uint32_t* pLeftChildIDs)
+{
+  for (uint64_t tree = 0; tree < numTrees; ++tree)
+  {
+    if (pRootIDs[tree] >= numNodes)
+    {
+      return false;
+    }
+  }
+
+  for (uint64_t node = 0; node < numNodes; ++node)
+  {
+    /* Terminal node. */
+    if (pLeftChildIDs[node] == 0)
+    {
+      continue;
+    }
+
+    /* The right child follows the left child. */
+    if (pLeftChildIDs[node] <= node || pLeftChildIDs[node] >= numNodes - 1 || pSplitVarIDs[node] >= numVariables)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+} // namespace
+
+/**
+ * Write the flattened forest to a versioned binary file.
+ */
+void save_flat_forest(const std::string& filename, const FlatForest& forest, TreeType treetype,
+    const std::vector<std::string>& dependentVariableNames, const std::vector<std::string>& variableNames)
+{
+  const std::string dependentNames = join_names(dependentVariableNames);
+  const std::string names = join_names(variableNames);
+
+  /* Lay the sections out after the header and the index. */
+  const uint32_t numSections = 7;
+  uint64_t offset = align(FLAT_FOREST_FILE_ALIGNMENT + numSections * sizeof(FlatForestFileSection));
+
+  std::vector<SectionData> sections;
+  add_section(sections, SECTION_ROOT_IDS, forest.getRootIDs(), forest.getNumTrees(), &offset);
+  add_section(sections, SECTION_SPLIT_VAR_IDS, forest.getSplitVarIDs(), forest.getNumNodes(), &offset);
+  add_section(sections, SECTION_THRESHOLDS, forest.getThresholds(), forest.getNumNodes(), &offset);
+  add_section(sections, SECTION_LEFT_CHILD_IDS, forest.getLeftChildIDs(), forest.getNumNodes(), &offset);
+  add_section(sections, SECTION_VALUES, forest.getValues(), forest.getNumNodes(), &offset);
+  add_section(sections, SECTION_DEPENDENT_VARIABLE_NAMES, dependentNames.data(), dependentNames.size(), &offset);
+  add_section(sections, SECTION_VARIABLE_NAMES, names.data(), names.size(), &offset);
+
+  FlatForestFileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, FLAT_FOREST_FILE_MAGIC, sizeof(header.magic));
+  header.version = FLAT_FOREST_FILE_VERSION;
+  header.byteOrderMark = FLAT_FOREST_FILE_BYTE_ORDER_MARK;
+  header.treeType = treetype;
+  header.numSections = numSections;
+  header.numTrees = forest.getNumTrees();
+  header.numNodes = forest.getNumNodes();
+  header.numVariables = forest.getNumVariables();
+
+  std::vector<FlatForestFileSection> index;
+  for (const auto& sectionData : sections)
+  {
+    index.push_back(sectionData.section);
+  }
+  header.checksum = header_checksum(header, index.data(), numSections);
+
+  std::ofstream outfile(filename, std::ios::binary);
+  if (!outfile.good())
+  {
+    throw std::runtime_error("Could not write to flat forest file: " + filename + ".");
+  }
+
+  /* Zero padding up to each aligned offset. */
+  const char padding[FLAT_FOREST_FILE_ALIGNMENT] = { };
+
+  outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  for (const auto& sectionData : sections)
+  {
+    outfile.write(reinterpret_cast<const char*>(&sectionData.section), sizeof(sectionData.section));
+  }
+
+  for (const auto& sectionData : sections)
+  {
+    outfile.write(padding, sectionData.section.offset - outfile.tellp());
+    outfile.write(static_cast<const char*>(sectionData.pData), sectionData.section.count * sectionData.section.elementSize);
+  }
+  outfile.write(padding, offset - outfile.tellp());
+
+  if (!outfile.good())
+  {
+    throw std::runtime_error("Could not write to flat forest file: " + filename + ".");
+  }
+}
+
+/**
+ * Check whether the given file is a flat forest file rather than a ranger forest file.
+ */
+bool is_flat_forest_file(const std::string& filename)
+{
+  std::ifstream infile(filename, std::ios::binary);
+  char magic[sizeof(FlatForestFileHeader::magic)];
+  infile.read(magic, sizeof(magic));
+  return infile.good() && std::memcmp(magic, FLAT_FOREST_FILE_MAGIC, sizeof(magic)) == 0;
+}
+
+/**
+ * Map the given file and validate its header and index, and its nodes with verifyNodes.
+ */
+MappedFlatForest::MappedFlatForest(const std::string& filename, bool verifyNodes) :
+    m_pMapping(MAP_FAILED), m_mappingSize(0), m_treeType(TREE_CLASSIFICATION)
+{
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    throw std::runtime_error("Could not open flat forest file: " + filename + ".");
+  }
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 || fileStat.st_size < FLAT_FOREST_FILE_ALIGNMENT)
+  {
+    close(fd);
+    throw std::runtime_error("Invalid flat forest file: " + filename + ".");
+  }
+
+  m_mappingSize = fileStat.st_size;
+  m_pMapping = mmap(nullptr, m_mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (m_pMapping == MAP_FAILED)
+  {
+    throw std::runtime_error("Could not map flat forest file: " + filename + ".");
+  }
+
+  try
+  {
+    const char* pMapping = static_cast<const char*>(m_pMapping);
+    const FlatForestFileHeader* pHeader = reinterpret_cast<const FlatForestFileHeader*>(pMapping);
+
+    if (std::memcmp(pHeader->magic, FLAT_FOREST_FILE_MAGIC, sizeof(pHeader->magic)) != 0)
+    {
+      throw std::runtime_error("Not a flat forest file: " + filename + ".");
+    }
+    if (pHeader->byteOrderMark != FLAT_FOREST_FILE_BYTE_ORDER_MARK)
+    {
+      throw std::runtime_error("Flat forest file written with another byte order: " + filename + ".");
+    }
+    if (pHeader->version != FLAT_FOREST_FILE_VERSION)
+    {
+      throw std::runtime_error("Unsupported flat forest file version: " + filename + ".");
+    }
+    if (pHeader->numSections > (m_mappingSize - FLAT_FOREST_FILE_ALIGNMENT) / sizeof(FlatForestFileSection))
+    {
+      throw std::runtime_error("Corrupted flat forest file: " + filename + ".");
+    }
+
+    const FlatForestFileSection* pIndex = reinterpret_cast<const FlatForestFileSection*>(pMapping + FLAT_FOREST_FILE_ALIGNMENT);
+    if (pHeader->checksum != header_checksum(*pHeader, pIndex, pHeader->numSections))
+    {
+      throw std::runtime_error("Corrupted flat forest file, checksum mismatch: " + filename + ".");
+    }
+
+    if (pHeader->treeType != TREE_CLASSIFICATION && pHeader->treeType != TREE_REGRESSION)
+    {
+      throw std::runtime_error("Unsupported tree type in flat forest file: " + filename + ".");
+    }
+    m_treeType = static_cast<TreeType>(pHeader->treeType);
+
+    uint64_t count = 0;
+
+    const uint32_t* pRootIDs = static_cast<const uint32_t*>(find_section(pMapping, m_mappingSize, pIndex,
+        pHeader->numSections, SECTION_ROOT_IDS, sizeof(uint32_t), &count));
+    const uint64_t numTrees = count;
+
+    const uint16_t* pSplitVarIDs = static_cast<const uint16_t*>(find_section(pMapping, m_mappingSize, pIndex,
+        pHeader->numSections, SECTION_SPLIT_VAR_IDS, sizeof(uint16_t), &count));
+    const uint64_t numNodes = count;
+
+    const float* pThresholds = static_cast<const float*>(find_section(pMapping, m_mappingSize, pIndex,
+        pHeader->numSections, SECTION_THRESHOLDS, sizeof(float), &count));
+    const bool thresholdsValid = count == numNodes;
+
+    const uint32_t* pLeftChildIDs = static_cast<const uint32_t*>(find_section(pMapping, m_mappingSize, pIndex,
+        pHeader->numSections, SECTION_LEFT_CHILD_IDS, sizeof(uint32_t), &count));
+    const bool leftChildIDsValid = count == numNodes;
+
+    const double* pValues = static_cast<const double*>(find_section(pMapping, m_mappingSize, pIndex,
+        pHeader->numSections, SECTION_VALUES, sizeof(double), &count));
+    const bool valuesValid = count == numNodes;
+
+    if (numTrees != pHeader->numTrees || numNodes != pHeader->numNodes || !thresholdsValid || !leftChildIDsValid
+        || !valuesValid || pHeader->numVariables > FlatForest::MAX_NUM_VARIABLES)
+    {
+      throw std::runtime_error("Corrupted flat forest file: " + filename + ".");
+    }
+
+    const char* pNames = static_cast<const char*>(find_section(pMapping, m_mappingSize, pIndex,
+        pHeader->numSections, SECTION_DEPENDENT_VARIABLE_NAMES, sizeof(char), &count));
+    m_dependentVariableNames = split_names(pNames, count);
+
+    pNames = static_cast<const char*>(find_section(pMapping, m_mappingSize, pIndex, pHeader->numSections,
+        SECTION_VARIABLE_NAMES, sizeof(char), &count));
+    m_variableNames = split_names(pNames, count);
+
+    /**
+     * The forest is used without copying, so nothing it refers to may lie outside of its arrays. Checking every node
+     * reads the whole node arrays, which makes the load time depend on the size of the forest: it is only done on
+     * request, the checksum and the section bounds are checked on every load.
+     */
+    if (m_variableNames.size() != pHeader->numVariables
+        || (verifyNodes && !nodes_valid(numTrees, numNodes, pHeader->numVariables, pRootIDs, pSplitVarIDs, pLeftChildIDs)))
+    {
+      throw std::runtime_error("Corrupted flat forest file: " + filename + ".");
+    }
+
+    m_forest.reset(new FlatForest(numTrees, numNodes, pHeader->numVariables, pRootIDs, pSplitVarIDs, pThresholds,
+        pLeftChildIDs, pValues));
+  }
+  catch (...)
+  {
+    munmap(m_pMapping, m_mappingSize);
+    throw;
+  }
+}
+
+/**
+ * Unmap the file.
+ */
+MappedFlatForest::~MappedFlatForest()
+{
+  m_forest.reset();
+  munmap(m_pMapping, m_mappingSize);
+}
+
+} // namespace ranger
@@ -0,0 +1,138 @@
+#ifndef FLAT_FOREST_FILE_H_
+#define FLAT_FOREST_FILE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "globals.h"
+
+#include "FlatForest.hpp"
+
+/* File format identification. */
+#define FLAT_FOREST_FILE_MAGIC                              "ORBITAIF"
+#define FLAT_FOREST_FILE_VERSION                                     2
+
+/* Written in native byte order, read back to detect files written on a machine with another byte order. */
+#define FLAT_FOREST_FILE_BYTE_ORDER_MARK                    0x01020304
+
+/* Alignment of the header, the index and every section, a cache line. */
+#define FLAT_FOREST_FILE_ALIGNMENT                                  64
+
+/* File name extension, next to ranger's ".forest". */
+#define FLAT_FOREST_FILE_EXTENSION                        ".flatforest"
+
+namespace ranger
+{
+
+/**
+ * Header at the start of a flat forest file, followed by the section index at offset FLAT_FOREST_FILE_ALIGNMENT.
+ * The checksum covers the header, with a zero checksum, and the section index.
+ */
+struct FlatForestFileHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrderMark;
+  uint32_t treeType;
+  uint32_t numSections;
+  uint64_t numTrees;
+  uint64_t numNodes;
+  uint64_t numVariables;
+  uint64_t checksum;
+  uint8_t reserved[8];
+};
+
+/**
+ * Entry of the section index. Sections are arrays of count elements of elementSize bytes starting at offset,
+ * which is a multiple of FLAT_FOREST_FILE_ALIGNMENT.
+ */
+struct FlatForestFileSection
+{
+  uint32_t id;
+  uint32_t elementSize;
+  uint64_t offset;
+  uint64_t count;
+};
+
+/* Section IDs. The names sections hold newline separated characters. */
+enum FlatForestFileSectionID
+{
+  SECTION_ROOT_IDS = 1,
+  SECTION_SPLIT_VAR_IDS = 2,
+  SECTION_THRESHOLDS = 3,
+  SECTION_LEFT_CHILD_IDS = 4,
+  SECTION_VALUES = 5,
+  SECTION_DEPENDENT_VARIABLE_NAMES = 6,
+  SECTION_VARIABLE_NAMES = 7
+};
+
+/**
+ * Write the flattened forest to a versioned binary file that can be memory mapped and used without deserialization.
+ * The variable names are those of the training data, in order, they are checked against the prediction data.
+ */
+void save_flat_forest(const std::string& filename, const FlatForest& forest, TreeType treetype,
+    const std::vector<std::string>& dependentVariableNames, const std::vector<std::string>& variableNames);
+
+/**
+ * Check whether the given file is a flat forest file rather than a ranger forest file.
+ */
+bool is_flat_forest_file(const std::string& filename);
+
+/**
+ * A flat forest file mapped in memory, read-only and shared, so that load time does not depend on the size of the
+ * forest and processes predicting with the same file share one copy of it in the page cache.
+ */
+class MappedFlatForest
+{
+private:
+  /* Mapped file. */
+  void* m_pMapping;
+  size_t m_mappingSize;
+
+  TreeType m_treeType;
+  std::vector<std::string> m_dependentVariableNames;
+  std::vector<std::string> m_variableNames;
+
+  /* Forest whose arrays point into the mapping. */
+  std::unique_ptr<FlatForest> m_forest;
+
+public:
+
+  /**
+   * Map the given file and validate its header and index, which does not depend on the size of the forest.
+   * With verifyNodes, every node is also checked to only refer to nodes and variables of the forest.
+   */
+  explicit MappedFlatForest(const std::string& filename, bool verifyNodes = false);
+
+  MappedFlatForest(const MappedFlatForest&) = delete;
+  MappedFlatForest& operator=(const MappedFlatForest&) = delete;
+
+  /* Unmap the file. */
+  ~MappedFlatForest();
+
+  const FlatForest& getForest() const
+  {
+    return *m_forest;
+  }
+
+  TreeType getTreeType() const
+  {
+    return m_treeType;
+  }
+
+  const std::vector<std::string>& getDependentVariableNames() const
+  {
+    return m_dependentVariableNames;
+  }
+
+  const std::vector<std::string>& getVariableNames() const
+  {
+    return m_variableNames;
+  }
+};
+
+} // namespace ranger
+
+#endif // FLAT_FOREST_FILE_H_
@@ -0,0 +1,259 @@
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+
+#include "ForestCodeGenerator.hpp"
+
+/* Significant digits needed for double literals to be read back exactly. */
+#define DOUBLE_LITERAL_PRECISION                                    17
+
+namespace ranger
+{
+
+namespace
+{
+
+/**
+ * Write a double literal that reads back as exactly the given double.
+ */
+void write_double_literal(std::ostream& out, double value)
+{
+  out << std::setprecision(DOUBLE_LITERAL_PRECISION) << value;
+}
+
+/**
+ * Write the given node and, recursively, its children as nested if/else statements.
+ */
+void write_node(std::ostream& out, size_t nodeID, size_t depth, const std::vector<std::vector<size_t>>& childNodeIDs,
+    const std::vector<size_t>& splitVarIDs, const std::vector<double>& splitValues)
+{
+  const std::string indent((depth + 1) * 2, ' ');
+
+  const size_t leftChildID = childNodeIDs[0][nodeID];
+  const size_t rightChildID = childNodeIDs[1][nodeID];
+
+  /* Terminal node: the split value is the prediction. */
+  if (leftChildID == 0 && rightChildID == 0)
+  {
+    out << indent << "return ";
+    write_double_literal(out, splitValues[nodeID]);
+    out << ";\n";
+    return;
+  }
+
+  /* Same decision as ranger's "value <= split value goes left", NaN goes right. */
+  out << indent << "if (x[" << splitVarIDs[nodeID] << "] <= ";
+  write_double_literal(out, splitValues[nodeID]);
+  out << ")\n" << indent << "{\n";
+  write_node(out, leftChildID, depth + 1, childNodeIDs, splitVarIDs, splitValues);
+  out << indent << "}\n" << indent << "else\n" << indent << "{\n";
+  write_node(out, rightChildID, depth + 1, childNodeIDs, splitVarIDs, splitValues);
+  out << indent << "}\n";
+}
+
+/**
+ * Write the aggregation of the tree predictions.
+ */
+void write_predict(std::ostream& out, TreeType treetype, size_t numTrees)
+{
+  out << "/**\n * Predict a sample, x holds the values of the variables listed in VARIABLE_NAMES.\n */\n";
+  out << "double predict(const double* x)\n{\n";
+
+  if (treetype == TREE_REGRESSION)
+  {
+    /* Sum in tree order, as ranger does, for identical rounding. */
+    out << "  double sum = 0;\n";
+    for (size_t tree = 0; tree < numTrees; ++tree)
+    {
+      out << "  sum += tree_" << tree << "(x);\n";
+    }
+    out << "  return sum / NUM_TREES;\n";
+  }
+  else
+  {
+    out << "  const double votes[NUM_TREES] = {\n";
+    for (size_t tree = 0; tree < numTrees; ++tree)
+    {
+      out << "    tree_" << tree << "(x)" << (tree + 1 < numTrees ? ",\n" : "\n");
+    }
+    out << "  };\n\n";
+    out << "  /* Majority vote, ties go to the smallest class. */\n";
+    out << "  double prediction = votes[0];\n";
+    out << "  unsigned maxCount = 0;\n";
+    out << "  for (unsigned i = 0; i < NUM_TREES; ++i)\n  {\n";
+    out << "    unsigned count = 0;\n";
+    out << "    for (unsigned j = 0; j < NUM_TREES; ++j)\n    {\n";
+    out << "      count += votes[j] == votes[i] ? 1 : 0;\n";
+    out << "    }\n";
+    out << "    if (count > maxCount || (count == maxCount && votes[i] < prediction))\n    {\n";
+    out << "      prediction = votes[i];\n";
+    out << "      maxCount = count;\n";
+    out << "    }\n";
+    out << "  }\n";
+    out << "  return prediction;\n";
+  }
+
+  out << "}\n";
+}
+
+/**
+ * Write the optional main function used to check the generated forest against ranger.
+ */
+void write_main(std::ostream& out)
+{
+  out << "#ifdef ORBITAI_FOREST_MAIN\n\n";
+  out << "#include <cstdio>\n#include <cstdlib>\n#include <cstring>\n\n";
+  out << "/* Longest line of the CSV file, newline included. */\n";
+  out << "#define MAX_LINE_LENGTH 65536\n\n";
+  out << "/**\n"
+      << " * Read a line of the CSV file from stdin, without its newline. Returns false at the end of the file and exits\n"
+      << " * if the line is too long.\n"
+      << " */\n";
+  out << "static bool read_line(char* line)\n{\n";
+  out << "  if (std::fgets(line, MAX_LINE_LENGTH, stdin) == NULL)\n  {\n    return false;\n  }\n\n";
+  out << "  const size_t length = std::strlen(line);\n";
+  out << "  if (length + 1 == MAX_LINE_LENGTH && line[length - 1] != '\\n')\n  {\n";
+  out << "    std::fprintf(stderr, \"Line longer than %d characters.\\n\", MAX_LINE_LENGTH - 1);\n";
+  out << "    std::exit(1);\n  }\n\n";
+  out << "  line[std::strcspn(line, \"\\r\\n\")] = '\\0';\n";
+  out << "  return true;\n}\n\n";
+  out << "/**\n"
+      << " * Predict the rows of the CSV file read from stdin and print them like ranger's prediction file.\n"
+      << " * The first row is the header, every variable must have a column, matched by name, and other columns are\n"
+      << " * ignored. Values are parsed as doubles, as ranger does. Rows with a missing value (\"x\" or empty cell) in a\n"
+      << " * variable column are skipped, rows without a cell for every variable column are rejected.\n"
+      << " */\n";
+  out << "int main()\n{\n";
+  out << "  static char line[MAX_LINE_LENGTH];\n";
+  out << "  int variableColumns[orbitai_forest::NUM_VARIABLES];\n\n";
+  out << "  if (!read_line(line))\n  {\n";
+  out << "    std::fprintf(stderr, \"Missing header row.\\n\");\n";
+  out << "    return 1;\n  }\n\n";
+  out << "  /* Map the variables to the header columns. */\n";
+  out << "  for (unsigned var = 0; var < orbitai_forest::NUM_VARIABLES; ++var)\n  {\n";
+  out << "    variableColumns[var] = -1;\n  }\n";
+  out << "  int numColumns = 0;\n";
+  out << "  for (char* cell = line; cell != NULL; ++numColumns)\n  {\n";
+  out << "    char* next = std::strchr(cell, ',');\n";
+  out << "    if (next != NULL)\n    {\n      *next++ = '\\0';\n    }\n";
+  out << "    for (unsigned var = 0; var < orbitai_forest::NUM_VARIABLES; ++var)\n    {\n";
+  out << "      if (variableColumns[var] < 0 && std::strcmp(cell, orbitai_forest::VARIABLE_NAMES[var]) == 0)\n      {\n";
+  out << "        variableColumns[var] = numColumns;\n";
+  out << "      }\n    }\n";
+  out << "    cell = next;\n  }\n\n";
+  out << "  /* Index of the last column to read. */\n";
+  out << "  int lastColumn = -1;\n";
+  out << "  for (unsigned var = 0; var < orbitai_forest::NUM_VARIABLES; ++var)\n  {\n";
+  out << "    if (variableColumns[var] < 0)\n    {\n";
+  out << "      std::fprintf(stderr, \"Variable %s not found in the header row.\\n\", orbitai_forest::VARIABLE_NAMES[var]);\n";
+  out << "      return 1;\n    }\n";
+  out << "    lastColumn = variableColumns[var] > lastColumn ? variableColumns[var] : lastColumn;\n";
+  out << "  }\n\n";
+  out << "  std::printf(\"Predictions: \\n\");\n\n";
+  out << "  double x[orbitai_forest::NUM_VARIABLES];\n";
+  out << "  for (unsigned long row = 1; read_line(line); ++row)\n  {\n";
+  out << "    /* Skip empty lines. */\n";
+  out << "    if (line[0] == '\\0')\n    {\n      continue;\n    }\n\n";
+  out << "    bool missing = false;\n";
+  out << "    char* cell = line;\n";
+  out << "    int col = 0;\n";
+  out << "    for (; col <= lastColumn && cell != NULL; ++col)\n    {\n";
+  out << "      char* next = std::strchr(cell, ',');\n";
+  out << "      if (next != NULL)\n      {\n        *next++ = '\\0';\n      }\n";
+  out << "      for (unsigned var = 0; var < orbitai_forest::NUM_VARIABLES; ++var)\n      {\n";
+  out << "        if (variableColumns[var] != col)\n        {\n          continue;\n        }\n";
+  out << "        char* end = NULL;\n";
+  out << "        if (std::strcmp(cell, \"true\") == 0)\n        {\n          x[var] = 1;\n        }\n";
+  out << "        else if (std::strcmp(cell, \"false\") == 0)\n        {\n          x[var] = 0;\n        }\n";
+  out << "        else\n        {\n";
+  out << "          x[var] = std::strtod(cell, &end);\n";
+  out << "          missing = missing || end == cell;\n";
+  out << "        }\n";
+  out << "      }\n";
+  out << "      cell = next;\n";
+  out << "    }\n\n";
+  out << "    if (col <= lastColumn)\n    {\n";
+  out << "      std::fprintf(stderr, \"Data row %lu does not have a value for every variable column.\\n\", row);\n";
+  out << "      return 1;\n    }\n\n";
+  out << "    if (!missing)\n    {\n";
+  out << "      std::printf(\"%g\\n\", orbitai_forest::predict(x));\n";
+  out << "    }\n";
+  out << "  }\n\n";
+  out << "  return 0;\n}\n\n";
+  out << "#endif // ORBITAI_FOREST_MAIN\n";
+}
+
+} // namespace
+
+/**
+ * Write a trained forest as a standalone C++ source file.
+ */
+void write_forest_code(const std::string& filename, TreeType treetype, const std::string& forestName,
+    const std::vector<std::string>& variableNames, const std::vector<bool>& isOrderedVariable,
+    const std::vector<std::vector<std::vector<size_t>>>& childNodeIDs,
+    const std::vector<std::vector<size_t>>& splitVarIDs, const std::vector<std::vector<double>>& splitValues)
+{
+  if (treetype != TREE_CLASSIFICATION && treetype != TREE_REGRESSION)
+  {
+    throw std::runtime_error("Code generation is only supported for classification and regression forests.");
+  }
+
+  for (bool ordered : isOrderedVariable)
+  {
+    if (!ordered)
+    {
+      throw std::runtime_error("Code generation is not supported for forests with unordered variables.");
+    }
+  }
+
+  if (splitValues.empty())
+  {
+    throw std::runtime_error("Code generation is not supported for forests without trees.");
+  }
+
+  std::ofstream out(filename);
+  if (!out.good())
+  {
+    throw std::runtime_error("Could not write to code file: " + filename + ".");
+  }
+
+  const size_t numTrees = splitValues.size();
+
+  out << "/*\n";
+  out << " * Generated by OrbitAI_ranger --codegen from " << forestName << ", do not edit.\n";
+  out << " * " << (treetype == TREE_REGRESSION ? "Regression" : "Classification") << " forest with " << numTrees
+      << " trees. Entry point: double orbitai_forest::predict(const double* x).\n";
+  out << " */\n\n";
+
+  out << "namespace orbitai_forest\n{\n\n";
+  out << "const unsigned NUM_TREES = " << numTrees << ";\n";
+  out << "const unsigned NUM_VARIABLES = " << variableNames.size() << ";\n\n";
+  out << "/* Variables expected in x, in order. */\n";
+  out << "const char* const VARIABLE_NAMES[NUM_VARIABLES] = {\n";
+  for (size_t var = 0; var < variableNames.size(); ++var)
+  {
+    out << "  \"" << variableNames[var] << "\"" << (var + 1 < variableNames.size() ? ",\n" : "\n");
+  }
+  out << "};\n\n";
+
+  for (size_t tree = 0; tree < numTrees; ++tree)
+  {
+    out << "static double tree_" << tree << "(const double* x)\n{\n";
+    write_node(out, 0, 0, childNodeIDs[tree], splitVarIDs[tree], splitValues[tree]);
+    out << "}\n\n";
+  }
+
+  write_predict(out, treetype, numTrees);
+
+  out << "\n} // namespace orbitai_forest\n\n";
+
+  write_main(out);
+
+  if (!out.good())
+  {
+    throw std::runtime_error("Could not write to code file: " + filename + ".");
+  }
+}
+
+} // namespace ranger
@@ -0,0 +1,34 @@
+#ifndef FOREST_CODE_GENERATOR_H_
+#define FOREST_CODE_GENERATOR_H_
+
+#include <string>
+#include <vector>
+
+#include "globals.h"
+
+namespace ranger
+{
+
+/**
+ * Write a trained forest as a standalone C++ source file without any dependency, not even on the standard library.
+ *
+ * Every tree becomes a function of nested if/else statements and the file exposes
+ *     double orbitai_forest::predict(const double* x)
+ * where x holds the independent variables in the order listed in the generated file. Thresholds are written as exact
+ * double literals of the split values and compared like ranger does, so the decisions are ranger's. Regression forests
+ * average the trees like ranger does; classification forests take the majority vote, ties go to the smallest class
+ * (ranger breaks ties at random).
+ *
+ * The generated file also contains a main function, compiled only with -DORBITAI_FOREST_MAIN, that predicts the rows
+ * of a CSV file read from stdin and prints them like ranger's prediction file.
+ *
+ * Only classification and regression forests with ordered variables and at least one tree are supported.
+ */
+void write_forest_code(const std::string& filename, TreeType treetype, const std::string& forestName,
+    const std::vector<std::string>& variableNames, const std::vector<bool>& isOrderedVariable,
+    const std::vector<std::vector<std::vector<size_t>>>& childNodeIDs,
+    const std::vector<std::vector<size_t>>& splitVarIDs, const std::vector<std::vector<double>>& splitValues);
+
+} // namespace ranger
+
+#endif // FOREST_CODE_GENERATOR_H_
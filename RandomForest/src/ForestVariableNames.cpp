@@ -0,0 +1,91 @@
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "ForestVariableNames.hpp"
+
+namespace ranger
+{
+
+/**
+ * Append the names of the independent variables to a ranger forest file.
+ */
+void append_forest_variable_names(const std::string& forestFile, const std::vector<std::string>& variableNames)
+{
+  std::string names;
+  for (const auto& name : variableNames)
+  {
+    names += name;
+    names += '\n';
+  }
+  const uint64_t size = names.size();
+
+  std::ofstream outfile(forestFile, std::ios::binary | std::ios::app);
+  outfile.write(names.data(), names.size());
+  outfile.write(reinterpret_cast<const char*>(&size), sizeof(size));
+  outfile.write(FOREST_VARIABLE_NAMES_MAGIC, std::strlen(FOREST_VARIABLE_NAMES_MAGIC));
+
+  if (!outfile.good())
+  {
+    throw std::runtime_error("Could not write to forest file: " + forestFile + ".");
+  }
+}
+
+/**
+ * Read the names of the independent variables appended to a ranger forest file.
+ */
+bool read_forest_variable_names(const std::string& forestFile, std::vector<std::string>* pVariableNames)
+{
+  std::ifstream infile(forestFile, std::ios::binary);
+  if (!infile.good())
+  {
+    throw std::runtime_error("Could not read from forest file: " + forestFile + ".");
+  }
+
+  const size_t magicSize = std::strlen(FOREST_VARIABLE_NAMES_MAGIC);
+  infile.seekg(0, std::ios::end);
+  const int64_t fileSize = infile.tellg();
+  if (fileSize < static_cast<int64_t>(sizeof(uint64_t) + magicSize))
+  {
+    return false;
+  }
+
+  uint64_t size;
+  std::string magic(magicSize, '\0');
+  infile.seekg(fileSize - sizeof(uint64_t) - magicSize);
+  infile.read(reinterpret_cast<char*>(&size), sizeof(size));
+  infile.read(&magic[0], magicSize);
+  if (!infile.good() || magic != FOREST_VARIABLE_NAMES_MAGIC)
+  {
+    return false;
+  }
+
+  if (size > static_cast<uint64_t>(fileSize) - sizeof(uint64_t) - magicSize)
+  {
+    throw std::runtime_error("Corrupted forest file: invalid variable names in " + forestFile + ".");
+  }
+
+  std::string names(size, '\0');
+  infile.seekg(fileSize - sizeof(uint64_t) - magicSize - size);
+  infile.read(&names[0], size);
+  if (!infile.good())
+  {
+    throw std::runtime_error("Could not read from forest file: " + forestFile + ".");
+  }
+
+  pVariableNames->clear();
+  size_t start = 0;
+  for (size_t i = 0; i < names.size(); ++i)
+  {
+    if (names[i] == '\n')
+    {
+      pVariableNames->emplace_back(names, start, i - start);
+      start = i + 1;
+    }
+  }
+
+  return true;
+}
+
+} // namespace ranger
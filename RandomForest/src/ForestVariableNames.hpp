@@ -0,0 +1,29 @@
+#ifndef FOREST_VARIABLE_NAMES_H_
+#define FOREST_VARIABLE_NAMES_H_
+
+#include <string>
+#include <vector>
+
+/* Identifies the variable names appended to a ranger forest file. */
+#define FOREST_VARIABLE_NAMES_MAGIC                         "ORBITAIV"
+
+namespace ranger
+{
+
+/**
+ * Append the names of the independent variables to a ranger forest file, which does not hold them, so that trees
+ * are not combined with or applied to data whose variables they do not split on. The names are written newline
+ * separated after ranger's content, followed by their size in bytes and FOREST_VARIABLE_NAMES_MAGIC so that they are
+ * found from the end of the file. Ranger stops reading after the last tree and ignores them.
+ */
+void append_forest_variable_names(const std::string& forestFile, const std::vector<std::string>& variableNames);
+
+/**
+ * Read the names of the independent variables appended to a ranger forest file.
+ * Returns false for forest files without them, e.g. saved by ranger itself.
+ */
+bool read_forest_variable_names(const std::string& forestFile, std::vector<std::string>* pVariableNames);
+
+} // namespace ranger
+
+#endif // FOREST_VARIABLE_NAMES_H_
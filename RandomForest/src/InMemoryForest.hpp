@@ -0,0 +1,401 @@
+#ifndef IN_MEMORY_FOREST_H_
+#define IN_MEMORY_FOREST_H_
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "globals.h"
+#include "ArgumentHandler.h"
+#include "Forest.h"
+#include "ForestClassification.h"
+#include "ForestRegression.h"
+#include "utility.h"
+
+#include "QuantizedData.hpp"
+#include "FlatForest.hpp"
+#include "FlatForestFile.hpp"
+#include "ForestCodeGenerator.hpp"
+#include "ForestVariableNames.hpp"
+
+namespace ranger
+{
+
+/**
+ * Replace the trees of a classification forest, merging the class values of the old and new trees.
+ */
+inline void load_trees(ForestClassification* pForest, std::vector<std::vector<std::vector<size_t>>>& childNodeIDs,
+    std::vector<std::vector<size_t>>& splitVarIDs, std::vector<std::vector<double>>& splitValues,
+    std::vector<double>& classValues, std::vector<bool>& isOrderedVariable)
+{
+  pForest->loadForest(splitValues.size(), childNodeIDs, splitVarIDs, splitValues, classValues, isOrderedVariable);
+}
+
+/**
+ * Replace the trees of a regression forest.
+ */
+inline void load_trees(ForestRegression* pForest, std::vector<std::vector<std::vector<size_t>>>& childNodeIDs,
+    std::vector<std::vector<size_t>>& splitVarIDs, std::vector<std::vector<double>>& splitValues,
+    std::vector<double>& /* classValues */, std::vector<bool>& isOrderedVariable)
+{
+  pForest->loadForest(splitValues.size(), childNodeIDs, splitVarIDs, splitValues, isOrderedVariable);
+}
+
+/**
+ * Probability and survival trees hold per class or per time point estimates that cannot simply be concatenated.
+ */
+inline void load_trees(Forest* /* pForest */, std::vector<std::vector<std::vector<size_t>>>& /* childNodeIDs */,
+    std::vector<std::vector<size_t>>& /* splitVarIDs */, std::vector<std::vector<double>>& /* splitValues */,
+    std::vector<double>& /* classValues */, std::vector<bool>& /* isOrderedVariable */)
+{
+  throw std::runtime_error("Replacing trees is only supported for classification and regression forests.");
+}
+
+/**
+ * Class values of a classification forest, none for other forests.
+ */
+inline std::vector<double> get_class_values(const ForestClassification* pForest)
+{
+  return pForest->getClassValues();
+}
+
+inline std::vector<double> get_class_values(const Forest* /* pForest */)
+{
+  return std::vector<double>();
+}
+
+/**
+ * A ranger forest that is initialized with a Data matrix that has already been loaded in memory.
+ * This is the equivalent of Forest::initCpp() minus the loading of the input file, which lets OrbitAI
+ * parse its own CSV files instead of writing an intermediate file for ranger to parse again.
+ */
+template<typename ForestType>
+class InMemoryForest : public ForestType
+{
+public:
+
+  /**
+   * Set the dependent variable names from the command arguments or, when predicting, from the forest file.
+   * The names are needed before loading the data in order to split the dependent from the independent variables.
+   */
+  const std::vector<std::string>& initDependentVariableNames(const ArgumentHandler& arg_handler)
+  {
+    if (!arg_handler.predict.empty())
+    {
+      this->loadDependentVariableNamesFromFile(arg_handler.predict);
+    }
+    else if (arg_handler.statusvarname.empty())
+    {
+      this->dependent_variable_names = { arg_handler.depvarname };
+    }
+    else
+    {
+      this->dependent_variable_names = { arg_handler.depvarname, arg_handler.statusvarname };
+    }
+
+    return this->dependent_variable_names;
+  }
+
+  /**
+   * Initialize the forest with the given data, the remaining parameters are taken from the command arguments
+   * except for the number of threads, which lets several forests share the CPUs.
+   */
+  void initInMemory(std::unique_ptr<Data> input_data, const ArgumentHandler& arg_handler, std::ostream* verbose_out,
+      uint num_threads)
+  {
+    this->verbose_out = verbose_out;
+    this->memory_mode = arg_handler.memmode;
+
+    /* Set prediction mode. */
+    bool prediction_mode = !arg_handler.predict.empty();
+
+    /* Sample fraction default and convert to vector. */
+    double sample_fraction = arg_handler.fraction;
+    if (sample_fraction == 0)
+    {
+      sample_fraction = arg_handler.replace ? DEFAULT_SAMPLE_FRACTION_REPLACE : DEFAULT_SAMPLE_FRACTION_NOREPLACE;
+    }
+    std::vector<double> sample_fraction_vector = { sample_fraction };
+
+    this->init(std::move(input_data), arg_handler.mtry, arg_handler.outprefix, arg_handler.ntree, arg_handler.seed,
+        num_threads, arg_handler.impmeasure, arg_handler.targetpartitionsize, prediction_mode,
+        arg_handler.replace, arg_handler.catvars, arg_handler.savemem, arg_handler.splitrule, arg_handler.predall,
+        sample_fraction_vector, arg_handler.alpha, arg_handler.minprop, arg_handler.holdout,
+        arg_handler.predictiontype, arg_handler.randomsplits, false, arg_handler.maxdepth, arg_handler.regcoef,
+        arg_handler.usedepth);
+
+    if (prediction_mode)
+    {
+      this->loadFromFile(arg_handler.predict);
+      checkVariables(arg_handler.predict);
+    }
+
+    /* Set variables to be always considered for splitting. */
+    if (!arg_handler.alwayssplitvars.empty())
+    {
+      this->setAlwaysSplitVariables(arg_handler.alwayssplitvars);
+    }
+
+    /* Load split select weights from file. */
+    if (!arg_handler.splitweights.empty())
+    {
+      std::vector<std::vector<double>> split_select_weights;
+      split_select_weights.resize(1);
+      loadDoubleVectorFromFile(split_select_weights[0], arg_handler.splitweights);
+      if (split_select_weights[0].size() != this->num_independent_variables)
+      {
+        throw std::runtime_error("Number of split select weights is not equal to number of independent variables.");
+      }
+      this->setSplitWeightVector(split_select_weights);
+    }
+
+    /* Load case weights from file. */
+    if (!arg_handler.caseweights.empty())
+    {
+      loadDoubleVectorFromFile(this->case_weights, arg_handler.caseweights);
+      if (this->case_weights.size() != this->num_samples)
+      {
+        throw std::runtime_error("Number of case weights is not equal to number of samples.");
+      }
+    }
+
+    /* Sample from non-zero weights in holdout mode. */
+    if (arg_handler.holdout && !this->case_weights.empty())
+    {
+      size_t nonzero_weights = 0;
+      for (auto& weight : this->case_weights)
+      {
+        if (weight > 0)
+        {
+          ++nonzero_weights;
+        }
+      }
+      this->sample_fraction[0] = this->sample_fraction[0] * ((double) nonzero_weights / (double) this->num_samples);
+    }
+
+    /* Check if all catvars are coded in integers starting at 1. */
+    if (!arg_handler.catvars.empty())
+    {
+      std::string error_message = checkUnorderedVariables(*this->data, arg_handler.catvars);
+      if (!error_message.empty())
+      {
+        throw std::runtime_error(error_message);
+      }
+    }
+  }
+
+  /**
+   * Save the forest to <outprefix>.forest like ranger does, followed by the names of its independent variables.
+   */
+  void saveToFile()
+  {
+    ForestType::saveToFile();
+    append_forest_variable_names(this->output_prefix + ".forest", this->data->getVariableNames());
+  }
+
+  /**
+   * Check that the trees loaded from the given forest file split on the independent variables of the data: by name
+   * when the names were saved with the forest, otherwise only their number can be checked.
+   */
+  void checkVariables(const std::string& forestFile) const
+  {
+    std::vector<std::string> forestVariableNames;
+    if (read_forest_variable_names(forestFile, &forestVariableNames))
+    {
+      if (forestVariableNames != this->data->getVariableNames())
+      {
+        throw std::runtime_error("The independent variables of the input data do not match the ones of the forest in "
+            + forestFile + ".");
+      }
+    }
+    else if (this->getIsOrderedVariable().size() != this->num_independent_variables)
+    {
+      throw std::runtime_error("The number of independent variables of the input data does not match the one of the forest in "
+          + forestFile + ".");
+    }
+  }
+
+  /**
+   * Replace the oldest trees of the given forest file with the trees that were just grown, i.e. keep a sliding
+   * window of trees. The forest keeps its size, unless it had fewer trees than were grown. Trees are in age order
+   * in the forest file, the oldest first, so that the next update again replaces the oldest trees.
+   */
+  void replaceOldestTrees(const std::string& forestFile)
+  {
+    /* Keep the grown trees aside, loading the old forest replaces them. */
+    std::vector<std::vector<std::vector<size_t>>> newChildNodeIDs = this->getChildNodeIDs();
+    std::vector<std::vector<size_t>> newSplitVarIDs = this->getSplitVarIDs();
+    std::vector<std::vector<double>> newSplitValues = this->getSplitValues();
+    std::vector<double> classValues = get_class_values(this);
+    const std::vector<std::string> dependentVariableNames = this->dependent_variable_names;
+
+    this->loadFromFile(forestFile);
+
+    /* Trees address their split variables by index, trees grown on other variables cannot be mixed. */
+    checkVariables(forestFile);
+    if (this->dependent_variable_names != dependentVariableNames)
+    {
+      throw std::runtime_error("The dependent variables of the input data do not match the ones of the forest in "
+          + forestFile + ".");
+    }
+
+    std::vector<std::vector<std::vector<size_t>>> childNodeIDs = this->getChildNodeIDs();
+    std::vector<std::vector<size_t>> splitVarIDs = this->getSplitVarIDs();
+    std::vector<std::vector<double>> splitValues = this->getSplitValues();
+    std::vector<bool> isOrderedVariable = this->getIsOrderedVariable();
+
+    /* Class values of the old trees first, then the ones only seen by the new trees. */
+    std::vector<double> mergedClassValues = get_class_values(this);
+    for (double classValue : classValues)
+    {
+      if (std::find(mergedClassValues.begin(), mergedClassValues.end(), classValue) == mergedClassValues.end())
+      {
+        mergedClassValues.push_back(classValue);
+      }
+    }
+
+    /* Evict the oldest trees. */
+    const size_t numOldTrees = splitValues.size();
+    const size_t numEvicted = std::min(newSplitValues.size(), numOldTrees);
+    childNodeIDs.erase(childNodeIDs.begin(), childNodeIDs.begin() + numEvicted);
+    splitVarIDs.erase(splitVarIDs.begin(), splitVarIDs.begin() + numEvicted);
+    splitValues.erase(splitValues.begin(), splitValues.begin() + numEvicted);
+
+    /* Append the new trees. */
+    std::move(newChildNodeIDs.begin(), newChildNodeIDs.end(), std::back_inserter(childNodeIDs));
+    std::move(newSplitVarIDs.begin(), newSplitVarIDs.end(), std::back_inserter(splitVarIDs));
+    std::move(newSplitValues.begin(), newSplitValues.end(), std::back_inserter(splitValues));
+
+    load_trees(this, childNodeIDs, splitVarIDs, splitValues, mergedClassValues, isOrderedVariable);
+
+    if (this->verbose_out)
+    {
+      *this->verbose_out << "Replaced " << numEvicted << " of the " << numOldTrees << " trees of " << forestFile
+          << ", the forest now has " << splitValues.size() << " trees." << std::endl;
+    }
+  }
+
+  /**
+   * Map the split values of trees grown on quantized data from bin indices back to raw values, so that the trees
+   * predict raw data and are saved like trees grown on raw data. Leaves keep their values.
+   */
+  void unquantizeSplitValues(const QuantizedData& quantizedData)
+  {
+    std::vector<std::vector<std::vector<size_t>>> childNodeIDs = this->getChildNodeIDs();
+    std::vector<std::vector<size_t>> splitVarIDs = this->getSplitVarIDs();
+    std::vector<std::vector<double>> splitValues = this->getSplitValues();
+    std::vector<double> classValues = get_class_values(this);
+    std::vector<bool> isOrderedVariable = this->getIsOrderedVariable();
+
+    for (size_t tree = 0; tree < splitValues.size(); ++tree)
+    {
+      for (size_t node = 0; node < splitValues[tree].size(); ++node)
+      {
+        if (childNodeIDs[tree][0][node] != 0 || childNodeIDs[tree][1][node] != 0)
+        {
+          splitValues[tree][node] = quantizedData.getThreshold(splitVarIDs[tree][node], splitValues[tree][node]);
+        }
+      }
+    }
+
+    load_trees(this, childNodeIDs, splitVarIDs, splitValues, classValues, isOrderedVariable);
+  }
+
+  /**
+   * Check whether the trees can be flattened: only classification and regression trees with ordered variables.
+   */
+  bool canFlatten(TreeType treetype) const
+  {
+    if (treetype != TREE_CLASSIFICATION && treetype != TREE_REGRESSION)
+    {
+      return false;
+    }
+
+    if (this->num_independent_variables > FlatForest::MAX_NUM_VARIABLES)
+    {
+      return false;
+    }
+
+    for (bool ordered : this->getIsOrderedVariable())
+    {
+      if (!ordered)
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Predict with a flattened copy of the trees instead of running ranger's prediction.
+   * The predictions are aggregated exactly like ranger does, including its tie breaking, and written to the same
+   * predictions member so that writeOutput() is unchanged. Returns false, without predicting, for forests that
+   * cannot be flattened and for predictions other than responses.
+   */
+  bool predictFlat(TreeType treetype)
+  {
+    if (!this->prediction_mode || this->predict_all || this->prediction_type != RESPONSE || !canFlatten(treetype))
+    {
+      return false;
+    }
+
+    if (this->verbose_out)
+    {
+      *this->verbose_out << "Predicting with flattened forest .." << std::endl;
+    }
+
+    const FlatForest flatForest(this->getChildNodeIDs(), this->getSplitVarIDs(), this->getSplitValues(),
+        this->num_independent_variables);
+
+    this->predictions = std::vector<std::vector<std::vector<double>>>(1, std::vector<std::vector<double>>(1));
+    flatForest.predictAll(*this->data, treetype, this->random_number_generator, this->num_threads,
+        this->predictions[0][0]);
+
+    return true;
+  }
+
+  /**
+   * Save the grown or loaded trees as a memory mappable flat forest file, next to ranger's forest file.
+   */
+  void saveFlat(TreeType treetype)
+  {
+    if (!canFlatten(treetype))
+    {
+      throw std::runtime_error("Only classification and regression forests with ordered variables can be saved as flat forests.");
+    }
+
+    const FlatForest flatForest(this->getChildNodeIDs(), this->getSplitVarIDs(), this->getSplitValues(),
+        this->num_independent_variables);
+
+    const std::string filename = this->output_prefix + FLAT_FOREST_FILE_EXTENSION;
+    save_flat_forest(filename, flatForest, treetype, this->dependent_variable_names, this->data->getVariableNames());
+
+    if (this->verbose_out)
+    {
+      *this->verbose_out << "Saved flat forest to file " << filename << "." << std::endl;
+    }
+  }
+
+  /**
+   * Write the grown or loaded trees as a standalone C++ source file, see write_forest_code().
+   */
+  void writeCode(const std::string& filename, TreeType treetype, const std::string& forestName)
+  {
+    write_forest_code(filename, treetype, forestName, this->data->getVariableNames(), this->getIsOrderedVariable(),
+        this->getChildNodeIDs(), this->getSplitVarIDs(), this->getSplitValues());
+
+    if (this->verbose_out)
+    {
+      *this->verbose_out << "Saved forest code to file " << filename << "." << std::endl;
+    }
+  }
+};
+
+} // namespace ranger
+
+#endif // IN_MEMORY_FOREST_H_
@@ -0,0 +1,147 @@
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "OrbitAIArguments.hpp"
+
+/**
+ * Constructor.
+ */
+OrbitAIArguments::OrbitAIArguments() :
+    noflatten(false), saveflat(false), verifyflat(false), quantize(0), cv(0)
+{
+}
+
+/**
+ * Return the value of the option at *pIndex and move the index to it.
+ */
+const char* OrbitAIArguments::value(int argc, char** argv, int* pIndex)
+{
+  if (*pIndex + 1 >= argc || argv[*pIndex + 1][0] == '-')
+  {
+    throw std::runtime_error(std::string("Missing argument for option ") + argv[*pIndex] + ".");
+  }
+  return argv[++(*pIndex)];
+}
+
+/**
+ * Remove the OrbitAI options from argv and return the number of remaining arguments.
+ */
+int OrbitAIArguments::extract(int argc, char** argv)
+{
+  /* Index at which the next argument kept for ranger is written. */
+  int keptArgc = 1;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::strcmp(argv[i], "--noflatten") == 0)
+    {
+      noflatten = true;
+    }
+    else if (std::strcmp(argv[i], "--saveflat") == 0)
+    {
+      saveflat = true;
+    }
+    else if (std::strcmp(argv[i], "--verifyflat") == 0)
+    {
+      verifyflat = true;
+    }
+    else if (std::strcmp(argv[i], "--codegen") == 0)
+    {
+      codegen = value(argc, argv, &i);
+    }
+    else if (std::strcmp(argv[i], "--update") == 0)
+    {
+      update = value(argc, argv, &i);
+    }
+    else if (std::strcmp(argv[i], "--quantize") == 0)
+    {
+      const char* pBins = value(argc, argv, &i);
+      int numBins = 0;
+      try
+      {
+        numBins = std::stoi(pBins);
+      }
+      catch (...)
+      {
+        numBins = 0;
+      }
+      if (numBins < 2 || numBins > 255)
+      {
+        throw std::runtime_error(std::string("Illegal argument for option --quantize: ") + pBins + ". Please give 2 to 255 bins.");
+      }
+      quantize = numBins;
+    }
+    else if (std::strcmp(argv[i], "--cv") == 0)
+    {
+      const char* pFolds = value(argc, argv, &i);
+      int folds = 0;
+      try
+      {
+        folds = std::stoi(pFolds);
+      }
+      catch (...)
+      {
+        folds = 0;
+      }
+      if (folds < 2)
+      {
+        throw std::runtime_error(std::string("Illegal argument for option --cv: ") + pFolds + ". Please give at least 2 folds.");
+      }
+      cv = folds;
+    }
+    else if (std::strcmp(argv[i], "--evaluate") == 0)
+    {
+      evaluate = value(argc, argv, &i);
+    }
+    else if (std::strcmp(argv[i], "--colnames") == 0)
+    {
+      std::stringstream ss(value(argc, argv, &i));
+      std::string colname;
+      while (std::getline(ss, colname, ','))
+      {
+        colnames.push_back(colname);
+      }
+    }
+    else
+    {
+      argv[keptArgc++] = argv[i];
+    }
+  }
+
+  argv[keptArgc] = nullptr;
+  return keptArgc;
+}
+
+/**
+ * Print the OrbitAI options, shown after ranger's own help.
+ */
+void OrbitAIArguments::displayHelp()
+{
+  std::cout << "OrbitAI options:" << std::endl;
+  std::cout << "    " << "--noflatten                Predict with ranger's own trees instead of the flattened forest." << std::endl;
+  std::cout << "    " << "--saveflat                  Also save the grown, updated or loaded forest as a memory mappable" << std::endl;
+  std::cout << "    " << "                           flat forest file <outprefix>.flatforest. Flat forest files can be" << std::endl;
+  std::cout << "    " << "                           given to --predict, they are used without loading ranger's trees." << std::endl;
+  std::cout << "    " << "--verifyflat               Check every node of the flat forest file given to --predict before" << std::endl;
+  std::cout << "    " << "                           predicting. Loading then takes time in proportion to the forest size." << std::endl;
+  std::cout << "    " << "--codegen FILE             Write the grown or loaded forest as standalone C++ code to FILE." << std::endl;
+  std::cout << "    " << "                           Only for classification and regression forests with ordered variables." << std::endl;
+  std::cout << "    " << "--update FILE              Replace the oldest trees of the forest in FILE with --ntree trees grown" << std::endl;
+  std::cout << "    " << "                           on the input data and save the result. Only for classification and" << std::endl;
+  std::cout << "    " << "                           regression forests." << std::endl;
+  std::cout << "    " << "--quantize N               Grow the trees on the input data quantized into at most N (2-255)" << std::endl;
+  std::cout << "    " << "                           quantile bins per variable, with split values mapped back to raw" << std::endl;
+  std::cout << "    " << "                           values. Only for classification and regression forests." << std::endl;
+  std::cout << "    " << "--cv K                     Stratified K-fold cross-validation of a classification forest on the" << std::endl;
+  std::cout << "    " << "                           input data. Folds are trained concurrently on one copy of the data." << std::endl;
+  std::cout << "    " << "                           Balanced accuracy, F1 score and confusion matrix are written per fold" << std::endl;
+  std::cout << "    " << "                           and for all folds to <outprefix>.evaluation." << std::endl;
+  std::cout << "    " << "--evaluate FILE            Train a classification forest on the input data and evaluate it on" << std::endl;
+  std::cout << "    " << "                           the test data in FILE, reported like --cv." << std::endl;
+  std::cout << "    " << "--colnames NAMES           Comma separated names of the columns of the input files, by position," << std::endl;
+  std::cout << "    " << "                           for input files without a header row, e.g. the training.csv logs of" << std::endl;
+  std::cout << "    " << "                           the Mochi server. Trailing columns without a name are ignored." << std::endl;
+  std::cout << std::endl;
+}
@@ -0,0 +1,63 @@
+#ifndef ORBITAI_ARGUMENTS_H_
+#define ORBITAI_ARGUMENTS_H_
+
+#include <string>
+#include <vector>
+
+/**
+ * Command line options that are specific to OrbitAI_ranger.
+ * They are taken out of argv before the remaining arguments are handed to ranger's ArgumentHandler.
+ */
+class OrbitAIArguments
+{
+public:
+
+  /* Predict with ranger's own trees instead of the flattened forest. */
+  bool noflatten;
+
+  /* Also save the forest as a memory mappable flat forest file. */
+  bool saveflat;
+
+  /* Check every node of a mapped flat forest file before predicting. */
+  bool verifyflat;
+
+  /* Write the forest as a standalone C++ source file with this name. */
+  std::string codegen;
+
+  /* Replace the oldest trees of this forest file with the newly grown trees. */
+  std::string update;
+
+  /* Number of bins per variable when growing trees on quantized data, 0 to grow them on the raw data. */
+  unsigned int quantize;
+
+  /* Number of folds of a cross-validation, 0 for none. */
+  unsigned int cv;
+
+  /* Evaluate a forest trained on the input data on this test file. */
+  std::string evaluate;
+
+  /* Names of the columns of the input files by position, for files without a header row. Empty to read the header. */
+  std::vector<std::string> colnames;
+
+  /* Constructor. */
+  OrbitAIArguments();
+
+  /**
+   * Remove the OrbitAI options from argv and return the number of remaining arguments.
+   */
+  int extract(int argc, char** argv);
+
+  /**
+   * Print the OrbitAI options, shown after ranger's own help.
+   */
+  static void displayHelp();
+
+private:
+
+  /**
+   * Return the value of the option at *pIndex and move the index to it.
+   */
+  static const char* value(int argc, char** argv, int* pIndex);
+};
+
+#endif // ORBITAI_ARGUMENTS_H_
@@ -1,6 +1,7 @@
 /*-------------------------------------------------------------------------------
  This file is is a copy of the ranger/cpp_version/src/main.cpp source file with
- some csv reading/writing logic added to it for data cleansing prior to training.
+ some csv reading logic added to it for data cleansing prior to training. The
+ selected columns are parsed straight into ranger's in-memory Data matrix.
  #-------------------------------------------------------------------------------*/
 
 #include <iostream>
@@ -8,8 +9,9 @@
 #include <stdexcept>
 #include <string>
 #include <memory>
-
-#include <csv2/reader.hpp>
+#include <random>
+#include <thread>
+#include <vector>
 
 #include "globals.h"
 #include "ArgumentHandler.h"
@@ -19,215 +21,255 @@
 #include "ForestProbability.h"
 #include "utility.h"
 
-#define INPUT_CSV_FILENAME                                  "ranger_input.csv"
+#include "QuantizedData.hpp"
+#include "CsvDataLoader.hpp"
+#include "Evaluation.hpp"
+#include "FlatForestFile.hpp"
+#include "InMemoryForest.hpp"
+#include "OrbitAIArguments.hpp"
 
 using namespace ranger;
-using namespace csv2;
 
-void run_ranger(const ArgumentHandler& arg_handler, std::ostream& verbose_out)
+/**
+ * Create a forest of the given type, initialize it with data parsed in memory from the input files or from the
+ * "in-line" prediction inputs, and grow or predict. The given CSV file can contain columns that should not be used
+ * for training or predicting (e.g. timestamp), only the columns listed with '--includevars' are loaded.
+ */
+template<typename ForestType>
+void run_forest(const ArgumentHandler& arg_handler, const OrbitAIArguments& orbitai_args, std::ostream& verbose_out)
 {
-  verbose_out << "Starting Ranger." << std::endl;
+  if (!orbitai_args.update.empty() && !arg_handler.predict.empty())
+  {
+    throw std::runtime_error("The --update option grows new trees and cannot be combined with --predict.");
+  }
 
-  /* Create forest object. */
-  std::unique_ptr<Forest> forest { };
-  switch (arg_handler.treetype) 
+  std::unique_ptr<InMemoryForest<ForestType>> forest = make_unique<InMemoryForest<ForestType>>();
+
+  /* The dependent variables have to be known to split them from the independent variables while parsing. */
+  const std::vector<std::string>& dependentVarNames = forest->initDependentVariableNames(arg_handler);
+
+  /* Load the data. */
+  std::unique_ptr<Data> data { };
+  if (!arg_handler.file.empty())
   {
-    case TREE_CLASSIFICATION:
-      if (arg_handler.probability) 
-      {
-        forest = make_unique<ForestProbability>();
-      }
-      else
-      {
-        forest = make_unique<ForestClassification>();
-      }
-      break;
-    case TREE_REGRESSION:
-      forest = make_unique<ForestRegression>();
-      break;
-    case TREE_SURVIVAL:
-      forest = make_unique<ForestSurvival>();
-      break;
-    case TREE_PROBABILITY:
-      forest = make_unique<ForestProbability>();
-      break;
+    /* Every input row gets a prediction, rows with missing values cannot be skipped. */
+    data = load_csv_data(expand_input_files(arg_handler.file), orbitai_args.colnames, arg_handler.includevars,
+        dependentVarNames, arg_handler.memmode, arg_handler.nthreads, verbose_out, arg_handler.predict.empty());
+  }
+  else
+  {
+    data = load_inline_data(arg_handler.includevars, arg_handler.inputvars, dependentVarNames, arg_handler.memmode);
   }
 
-  /* Call Ranger. */
-  forest->initCpp(arg_handler.depvarname, arg_handler.memmode, INPUT_CSV_FILENAME, arg_handler.mtry,
-      arg_handler.outprefix, arg_handler.ntree, &verbose_out, arg_handler.seed, arg_handler.nthreads,
-      arg_handler.predict, arg_handler.impmeasure, arg_handler.targetpartitionsize, arg_handler.splitweights,
-      arg_handler.alwayssplitvars, arg_handler.statusvarname, arg_handler.replace, arg_handler.catvars,
-      arg_handler.savemem, arg_handler.splitrule, arg_handler.caseweights, arg_handler.predall, arg_handler.fraction,
-      arg_handler.alpha, arg_handler.minprop, arg_handler.holdout, arg_handler.predictiontype,
-      arg_handler.randomsplits, arg_handler.maxdepth, arg_handler.regcoef, arg_handler.usedepth);
-
-  forest->run(true, !arg_handler.skipoob);
-  if (arg_handler.write) 
+  /* Quantize the data, the raw values are released once quantized. */
+  const QuantizedData* pQuantizedData = nullptr;
+  if (orbitai_args.quantize > 0)
   {
-    forest->saveToFile();
+    if (arg_handler.probability || (arg_handler.treetype != TREE_CLASSIFICATION && arg_handler.treetype != TREE_REGRESSION))
+    {
+      throw std::runtime_error("The --quantize option is only supported for classification and regression forests.");
+    }
+    if (!arg_handler.predict.empty() || !arg_handler.catvars.empty())
+    {
+      throw std::runtime_error("The --quantize option grows trees on ordered variables and cannot be combined with --predict or --catvars.");
+    }
+
+    verbose_out << "Quantizing the data into at most " << orbitai_args.quantize << " bins per variable .." << std::endl;
+    std::unique_ptr<QuantizedData> quantizedData = make_unique<QuantizedData>(*data, dependentVarNames.size(), orbitai_args.quantize);
+    pQuantizedData = quantizedData.get();
+    data = std::move(quantizedData);
   }
 
-  forest->writeOutput();
-  verbose_out << "Finished Ranger." << std::endl;
-}
+  forest->initInMemory(std::move(data), arg_handler, &verbose_out, arg_handler.nthreads);
 
-void create_single_input_csv(std::vector<std::string>* pIncludeVars, std::vector<std::string>* pInputVars)
-{
-  std::ofstream csvInputFile;
-  csvInputFile.open(INPUT_CSV_FILENAME);
+  /* Probability forests are requested as classification forests with the probability flag. */
+  const TreeType treetype = arg_handler.probability ? TREE_PROBABILITY : arg_handler.treetype;
 
-  size_t varCounter = 0;
+  /* Call Ranger, unless the prediction can be made with the flattened forest. */
+  if (orbitai_args.noflatten || !forest->predictFlat(treetype))
+  {
+    forest->run(true, !arg_handler.skipoob);
+  }
 
-  /* Write header row. */
-  for(std::vector<std::string>::iterator it = pIncludeVars->begin() ; it != pIncludeVars->end(); ++it)
+  /* Trees grown on quantized data split on bin indices, they are saved and used with raw split values. */
+  if (pQuantizedData)
   {
-    /* Increment var counter. */
-    varCounter++;
+    forest->unquantizeSplitValues(*pQuantizedData);
+  }
 
-    if(varCounter < pIncludeVars->size())
-    {
-      csvInputFile << *it << ",";
-    }
-    else
-    {
-      csvInputFile << *it << std::endl;
-    }
+  /* Sliding window of trees: the trees just grown replace the oldest trees of the given forest. */
+  if (!orbitai_args.update.empty())
+  {
+    forest->replaceOldestTrees(orbitai_args.update);
   }
 
-  /* Reset the var counter. */
-  varCounter = 0;
+  if (arg_handler.write || !orbitai_args.update.empty()) 
+  {
+    forest->saveToFile();
+  }
 
-  /* Write data row. */
-  for(std::vector<std::string>::iterator it = pInputVars->begin() ; it != pInputVars->end(); ++it)
+  if (orbitai_args.saveflat)
   {
-    /* Increment var counter. */
-    varCounter++;
+    forest->saveFlat(treetype);
+  }
 
-    if(varCounter < pInputVars->size())
-    {
-      csvInputFile << *it << ",";
-    }
-    else
-    {
-      csvInputFile << *it << std::endl;
-    }
+  /* Generate the code of the forest, e.g. to fly a frozen forest without model file. */
+  if (!orbitai_args.codegen.empty())
+  {
+    forest->writeCode(orbitai_args.codegen, treetype,
+        arg_handler.predict.empty() ? arg_handler.outprefix + ".forest" : arg_handler.predict);
   }
 
-  /* Done writing to the ranger input CSV file, close it. */
-  csvInputFile.close();
+  forest->writeOutput();
 }
 
-void create_input_csv(std::vector<std::string>* pIncludeVars, std::string inputFile)
+/**
+ * Predict with a memory mapped flat forest file, without creating a ranger forest. The predictions are the same as
+ * ranger's and are written to the same prediction file.
+ */
+void run_mapped_forest(const ArgumentHandler& arg_handler, const OrbitAIArguments& orbitai_args, std::ostream& verbose_out)
 {
-  /* Create CSV reader. */
-  csv2::Reader<delimiter<','>,
-      quote_character<'"'>,
-      first_row_is_header<true>,
-      trim_policy::trim_whitespace> csv;
+  const MappedFlatForest mappedForest(arg_handler.predict, orbitai_args.verifyflat);
+
+  /* Load the data. */
+  std::unique_ptr<Data> data { };
+  if (!arg_handler.file.empty())
+  {
+    data = load_csv_data(expand_input_files(arg_handler.file), orbitai_args.colnames, arg_handler.includevars,
+        mappedForest.getDependentVariableNames(), arg_handler.memmode, arg_handler.nthreads, verbose_out, false);
+  }
+  else
+  {
+    data = load_inline_data(arg_handler.includevars, arg_handler.inputvars, mappedForest.getDependentVariableNames(),
+        arg_handler.memmode);
+  }
+
+  /* The trees address the variables by index. */
+  if (data->getVariableNames() != mappedForest.getVariableNames())
+  {
+    throw std::runtime_error("The independent variables of the input data do not match the ones of the flat forest.");
+  }
 
-  if (csv.mmap(inputFile))
+  /* Same seeding as ranger, for the tie breaking of classification votes. */
+  std::mt19937_64 random_number_generator;
+  if (arg_handler.seed == 0)
+  {
+    std::random_device random_device;
+    random_number_generator.seed(random_device());
+  }
+  else
   {
-    std::ofstream csvInputFile;
-    csvInputFile.open(INPUT_CSV_FILENAME);
+    random_number_generator.seed(arg_handler.seed);
+  }
 
-    /* Read the header row. */
-    const auto header = csv.header();
+  uint num_threads = arg_handler.nthreads;
+  if (num_threads == DEFAULT_NUM_THREADS)
+  {
+    num_threads = std::thread::hardware_concurrency();
+  }
 
-    /* Figure out which columns to process by keeping track of their indices. */
-    std::vector<size_t> trainingColumnIndices;
-    size_t headerColIndex = 0;
-    size_t keptHeaderCounter = 0;
-    std::string columnName;
+  verbose_out << "Predicting with mapped flat forest " << arg_handler.predict << " (" 
+      << mappedForest.getForest().getNumTrees() << " trees) .." << std::endl;
 
-    /* Header row string to write. */
-    std::string headerToWrite;
+  std::vector<double> predictions;
+  mappedForest.getForest().predictAll(*data, mappedForest.getTreeType(), random_number_generator, num_threads,
+      predictions);
 
-    /* Collect index of columns to process as training or predicting data. */
-    for (const auto cell: header)
-    {
-      /* Get column name. */
-      columnName = "";
-      cell.read_value(columnName);
+  /* Same format as ranger's prediction file. */
+  const std::string filename = arg_handler.outprefix + ".prediction";
+  std::ofstream outfile(filename, std::ios::out);
+  if (!outfile.good())
+  {
+    throw std::runtime_error("Could not write to prediction file: " + filename + ".");
+  }
 
-      /* Check if that column name is marked to be kept. */
-      if (std::find(pIncludeVars->begin(), pIncludeVars->end(), columnName) != pIncludeVars->end())
-      {
-        /* Increment kept header counter. */
-        keptHeaderCounter++;
+  outfile << "Predictions: " << std::endl;
+  for (double prediction : predictions)
+  {
+    outfile << prediction << std::endl;
+  }
 
-        /* Keep track of the column index containing data to use as training or predicting data. */
-        trainingColumnIndices.push_back(headerColIndex);
+  verbose_out << "Saved predictions to file " << filename << "." << std::endl;
+}
 
-        /* Concatenate the string listing the names of columns with training or predicting data. */
-        headerToWrite = headerToWrite + columnName;
+void run_ranger(const ArgumentHandler& arg_handler, const OrbitAIArguments& orbitai_args, std::ostream& verbose_out)
+{
+  verbose_out << "Starting Ranger." << std::endl;
 
-        /* Include comma separation unless we've reached the last column name to be written. */
-        if(keptHeaderCounter != pIncludeVars->size())
-        {
-          headerToWrite = headerToWrite + ",";
-        }
-      }
+  /* Flat forest files are memory mapped and need no ranger forest. */
+  if (!arg_handler.predict.empty() && is_flat_forest_file(arg_handler.predict))
+  {
+    run_mapped_forest(arg_handler, orbitai_args, verbose_out);
+    verbose_out << "Finished Ranger." << std::endl;
+    return;
+  }
 
-      /* Increment header column index tracker. */
-      headerColIndex++;
+  /* Evaluation modes train their own forests. */
+  if (orbitai_args.cv > 0 || !orbitai_args.evaluate.empty())
+  {
+    if (orbitai_args.cv > 0 && !orbitai_args.evaluate.empty())
+    {
+      throw std::runtime_error("Options --cv and --evaluate cannot be combined.");
     }
 
-    /* Write the header row to the new CSV file that will be used as input for ranger. */
-    csvInputFile << headerToWrite << std::endl;
-
-    /* Trackers that will be used to skip columns when writing the ranger input csv. */
-    /* We skip columns for data that shouldn't be used as training data (e.g. timestamp). */
-    size_t rowColIndex;
-    std::string rowToWrite;
-    std::string cellValue;
-    
-    /* Traverse each cell of every row. */
-    for (const auto row: csv)
+    if (orbitai_args.cv > 0)
     {
-      rowColIndex = 0;
-      rowToWrite = "";
+      run_cross_validation(arg_handler, orbitai_args.cv, orbitai_args.colnames, verbose_out);
+    }
+    else
+    {
+      run_holdout_evaluation(arg_handler, orbitai_args.evaluate, orbitai_args.colnames, verbose_out);
+    }
+    verbose_out << "Finished Ranger." << std::endl;
+    return;
+  }
 
-      for (const auto cell: row)
+  switch (arg_handler.treetype) 
+  {
+    case TREE_CLASSIFICATION:
+      if (arg_handler.probability) 
       {
-        /* And only write data from column marked as containing training data. */
-        if (std::find(trainingColumnIndices.begin(), trainingColumnIndices.end(), rowColIndex) != trainingColumnIndices.end())
-        {
-          /* Fetch cell value. */
-          cellValue = "";
-          cell.read_value(cellValue);
-
-          /* Concatenate the string listing the  training data for the selected columns. */
-          rowToWrite = rowToWrite + cellValue;
-
-          /* Include comma separation unless we've reached the last column. */
-          if(rowColIndex < trainingColumnIndices.size())
-          {
-            rowToWrite = rowToWrite + ",";
-          }
-        }
-
-        /* Increment column index tracker for the current row. */
-        rowColIndex++;
+        run_forest<ForestProbability>(arg_handler, orbitai_args, verbose_out);
       }
-
-      /* Write row to the new CSV file that will be used as input for ranger. */
-      csvInputFile << rowToWrite << std::endl;
-    }
-
-    /* Done writing to the ranger input CSV file, close it. */
-    csvInputFile.close();
+      else
+      {
+        run_forest<ForestClassification>(arg_handler, orbitai_args, verbose_out);
+      }
+      break;
+    case TREE_REGRESSION:
+      run_forest<ForestRegression>(arg_handler, orbitai_args, verbose_out);
+      break;
+    case TREE_SURVIVAL:
+      run_forest<ForestSurvival>(arg_handler, orbitai_args, verbose_out);
+      break;
+    case TREE_PROBABILITY:
+      run_forest<ForestProbability>(arg_handler, orbitai_args, verbose_out);
+      break;
   }
+
+  verbose_out << "Finished Ranger." << std::endl;
 }
 
 int main(int argc, char **argv)
 {
   try 
   {
+    /* Handle the OrbitAI specific command line arguments first, ranger's argument handler does not know them. */
+    OrbitAIArguments orbitai_args;
+    argc = orbitai_args.extract(argc, argv);
+
     /* Handle command line arguments. */
     ArgumentHandler arg_handler(argc, argv);
     if (arg_handler.processArguments() != 0)
     {
+      /* Show the OrbitAI options after ranger's help. */
+      for (int i = 1; i < argc; ++i)
+      {
+        if (std::string(argv[i]) == "--help" || std::string(argv[i]) == "-h")
+        {
+          OrbitAIArguments::displayHelp();
+        }
+      }
       return 0;
     }
 
@@ -237,13 +279,10 @@ int main(int argc, char **argv)
     /* Flag indicating that prediction inputs are being given "in-line" as command arguments. */
     bool inlinePrediction = false;
 
-    /* When giving inputs as arguments we must create the input CSV file from the given arguments. */
+    /* When giving inputs as arguments the single data row is created from the given arguments. */
     if (!arg_handler.predict.empty() && arg_handler.file.empty() && arg_handler.inputvars.size() > 0) {
       if(arg_handler.includevars.size() == arg_handler.inputvars.size())
       {
-        /* Create single input CSV */
-        create_single_input_csv(&arg_handler.includevars, &arg_handler.inputvars);
-
         /* No input file is given so don't check for the file argument when invoking checkArguments(). */
         checkFile = false;
 
@@ -258,16 +297,9 @@ int main(int argc, char **argv)
     /* Check arguments. */
     arg_handler.checkArguments(checkFile);
 
-    /* The given CSV file can contain columns that should not be used for training or predicting (e.g. timestamp). */
-    /* Cleanse the data and create a new CSV file to be used as ranger's input CSV file. */
-    if(!arg_handler.file.empty())
-    {
-      create_input_csv(&arg_handler.includevars, arg_handler.file);
-    }
-
     if (arg_handler.verbose)
     {
-      run_ranger(arg_handler, std::cout);
+      run_ranger(arg_handler, orbitai_args, std::cout);
     } 
     else 
     {
@@ -276,7 +308,7 @@ int main(int argc, char **argv)
       {
         throw std::runtime_error("Could not write to logfile.");
       }
-      run_ranger(arg_handler, logfile);
+      run_ranger(arg_handler, orbitai_args, logfile);
     }
 
     if(inlinePrediction)
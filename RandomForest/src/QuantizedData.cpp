@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <cmath>
+
+#include "QuantizedData.hpp"
+
+namespace ranger
+{
+
+/**
+ * Quantize the independent variables of the given matrix into at most maxNumBins bins of about equal counts.
+ */
+QuantizedData::QuantizedData(const Data& data, size_t numDependentVariables, uint maxNumBins)
+{
+  if (maxNumBins < 2 || maxNumBins > QUANTIZED_DATA_MAX_NUM_BINS)
+  {
+    throw std::runtime_error("The number of bins must be between 2 and 255.");
+  }
+
+  this->variable_names = data.getVariableNames();
+  this->num_cols = data.getNumCols();
+  this->num_cols_no_snp = data.getNumCols();
+  this->num_rows = data.getNumRows();
+
+  const size_t numRows = this->num_rows;
+  m_bins.resize(this->num_cols * numRows);
+  m_thresholds.resize(this->num_cols);
+
+  std::vector<double> values(numRows);
+  for (size_t col = 0; col < this->num_cols; ++col)
+  {
+    for (size_t row = 0; row < numRows; ++row)
+    {
+      values[row] = data.get_x(row, col);
+    }
+    std::sort(values.begin(), values.end());
+
+    /* Close a bin after each distinct value once it holds its share of the rows, or after every distinct value if
+     * there are few enough of them. */
+    std::vector<double>& thresholds = m_thresholds[col];
+    size_t numDistinct = numRows == 0 ? 0 : 1;
+    for (size_t i = 0; i + 1 < numRows; ++i)
+    {
+      if (values[i] != values[i + 1])
+      {
+        ++numDistinct;
+      }
+    }
+    const bool binPerValue = numDistinct <= maxNumBins;
+
+    for (size_t i = 0; i + 1 < numRows && thresholds.size() + 1 < maxNumBins; ++i)
+    {
+      if (values[i] == values[i + 1])
+      {
+        continue;
+      }
+
+      const size_t numRowsSoFar = i + 1;
+      if (binPerValue || numRowsSoFar * maxNumBins >= (thresholds.size() + 1) * numRows)
+      {
+        /* Halfway, unless rounding puts it on the upper value, like ranger's split values. */
+        double threshold = (values[i] + values[i + 1]) / 2;
+        if (threshold == values[i + 1])
+        {
+          threshold = values[i];
+        }
+        thresholds.push_back(threshold);
+      }
+    }
+
+    /* A value belongs to the first bin whose threshold it does not exceed. */
+    for (size_t row = 0; row < numRows; ++row)
+    {
+      const double value = data.get_x(row, col);
+      m_bins[col * numRows + row] = static_cast<uint8_t>(std::lower_bound(thresholds.begin(), thresholds.end(), value)
+          - thresholds.begin());
+    }
+  }
+
+  m_y.resize(numDependentVariables * numRows);
+  for (size_t col = 0; col < numDependentVariables; ++col)
+  {
+    for (size_t row = 0; row < numRows; ++row)
+    {
+      m_y[col * numRows + row] = data.get_y(row, col);
+    }
+  }
+}
+
+/**
+ * Raw value equivalent of a split value between bin indices.
+ */
+double QuantizedData::getThreshold(size_t col, double splitValue) const
+{
+  const std::vector<double>& thresholds = m_thresholds[col];
+  if (thresholds.empty())
+  {
+    return splitValue;
+  }
+
+  /* Split values lie between two bin indices, the bins up to the lower one go left. */
+  const size_t bin = static_cast<size_t>(std::max(0.0, std::floor(splitValue)));
+  return thresholds[std::min(bin, thresholds.size() - 1)];
+}
+
+} // namespace ranger
@@ -0,0 +1,80 @@
+#ifndef ROW_SUBSET_DATA_H_
+#define ROW_SUBSET_DATA_H_
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "globals.h"
+#include "Data.h"
+
+namespace ranger
+{
+
+/**
+ * Read-only view of a subset of the rows of another Data matrix, e.g. the training or test rows of a fold.
+ * Only the row indices are stored, so that several forests can be trained concurrently on one copy of the data.
+ * The viewed matrix must outlive the view.
+ */
+class RowSubsetData : public Data
+{
+private:
+  /* The viewed matrix. */
+  const Data& m_data;
+
+  /* Rows of the viewed matrix, in view order. */
+  std::vector<size_t> m_rows;
+
+public:
+
+  /* Constructor. */
+  RowSubsetData(const Data& data, std::vector<size_t> rows) :
+      m_data(data), m_rows(std::move(rows))
+  {
+    this->variable_names = data.getVariableNames();
+    this->num_cols = data.getNumCols();
+    this->num_cols_no_snp = data.getNumCols();
+    this->num_rows = m_rows.size();
+  }
+
+  RowSubsetData(const RowSubsetData&) = delete;
+  RowSubsetData& operator=(const RowSubsetData&) = delete;
+
+  virtual ~RowSubsetData() override = default;
+
+  double get_x(size_t row, size_t col) const override
+  {
+    /* Columns past the last variable are the permuted copies used by the corrected impurity importance. */
+    if (col >= this->num_cols)
+    {
+      row = this->permuted_sampleIDs[row];
+      col -= this->num_cols;
+    }
+
+    return m_data.get_x(m_rows[row], col);
+  }
+
+  double get_y(size_t row, size_t col) const override
+  {
+    return m_data.get_y(m_rows[row], col);
+  }
+
+  void reserveMemory(size_t /* y_cols */) override
+  {
+    throw std::runtime_error("Row subsets of a Data matrix are read-only.");
+  }
+
+  void set_x(size_t /* col */, size_t /* row */, double /* value */, bool& /* error */) override
+  {
+    throw std::runtime_error("Row subsets of a Data matrix are read-only.");
+  }
+
+  void set_y(size_t /* col */, size_t /* row */, double /* value */, bool& /* error */) override
+  {
+    throw std::runtime_error("Row subsets of a Data matrix are read-only.");
+  }
+};
+
+} // namespace ranger
+
+#endif // ROW_SUBSET_DATA_H_
@@ -0,0 +1,147 @@
+/*-------------------------------------------------------------------------------
+ Load the telemetry files archived in the results directory with the OrbitAI CSV
+ loader and check that their values end up in the right columns. Run from the
+ RandomForest directory, see "make test".
+ #-------------------------------------------------------------------------------*/
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "globals.h"
+#include "Data.h"
+
+#include "CsvDataLoader.hpp"
+
+using namespace ranger;
+
+/* Number of failed checks. */
+static int numFailures = 0;
+
+/**
+ * Report a failed check.
+ */
+static void check(bool passed, const std::string& description)
+{
+  if (!passed)
+  {
+    std::cerr << "FAILED: " << description << std::endl;
+    numFailures++;
+  }
+}
+
+/**
+ * Check the value of the given independent variable in the given row.
+ */
+static void check_x(const Data& data, size_t row, const std::string& variableName, double expected)
+{
+  const std::vector<std::string>& variableNames = data.getVariableNames();
+  size_t col = 0;
+  while (col < variableNames.size() && variableNames[col] != variableName)
+  {
+    col++;
+  }
+
+  check(col < variableNames.size() && std::fabs(data.get_x(row, col) - expected) < 1e-9,
+      variableName + " of row " + std::to_string(row) + " is " + std::to_string(expected));
+}
+
+/**
+ * The header of the telemetry files of results/data is shifted by one column: 19 names and a trailing empty name over
+ * 20 values per row, the first value being the timestamp.
+ */
+static void test_shifted_header()
+{
+  std::ostringstream verbose_out;
+  std::unique_ptr<Data> data = load_csv_data({ "../results/data/data_2021-04-16_17-17-36.csv" }, { },
+      { "CADC0884", "CADC0885", "CADC0894", "CADC1005" }, { "CADC1005" }, MEM_DOUBLE, 1, verbose_out);
+
+  check(data->getVariableNames() == std::vector<std::string>({ "CADC0884", "CADC0885", "CADC0894" }),
+      "shifted header: independent variables in file order");
+  check(verbose_out.str().find("is shifted by one column") != std::string::npos, "shifted header: repair reported");
+
+  /* The first of the 850 data rows has missing values. */
+  check(data->getNumRows() == 849, "shifted header: 849 rows");
+  check_x(*data, 0, "CADC0884", 0.00548852);
+  check_x(*data, 0, "CADC0885", 0);
+  check_x(*data, 0, "CADC0894", 0.6531328);
+  check(std::fabs(data->get_y(0, 0) - (-0.28639293)) < 1e-9, "shifted header: CADC1005 of row 0 is -0.28639293");
+  check_x(*data, 848, "CADC0884", 0.13210775);
+  check(std::fabs(data->get_y(848, 0) - 0.66521084) < 1e-9, "shifted header: CADC1005 of row 848 is 0.66521084");
+}
+
+/**
+ * The training.csv logs of the Mochi server have no header row, their columns are named with --colnames.
+ */
+static void test_headerless()
+{
+  std::ostringstream verbose_out;
+  std::unique_ptr<Data> data = load_csv_data({ "../results/learning/mochi-2021-05-05_20-40-07/logs/training.csv" },
+      { "TIMESTAMP", "PD1", "PD2", "PD3", "PD4", "PD5", "PD6", "LABEL" },
+      { "PD1", "PD2", "PD3", "PD4", "PD5", "PD6", "LABEL" }, { "LABEL" }, MEM_DOUBLE, 1, verbose_out);
+
+  check(data->getNumRows() == 539, "headerless: 539 rows, the first one included");
+  check_x(*data, 0, "PD1", 0.18);
+  check_x(*data, 0, "PD3", 0.7);
+  check(data->get_y(0, 0) == 1, "headerless: LABEL of row 0 is 1");
+  check_x(*data, 538, "PD1", 0.54);
+  check_x(*data, 538, "PD4", 0.94);
+}
+
+/**
+ * Files with a regular header row are matched by name.
+ */
+static void test_header()
+{
+  std::ostringstream verbose_out;
+  std::unique_ptr<Data> data = load_csv_data({ "test_data/training_data.csv" }, { },
+      { "PD1", "PD2", "PD3", "PD4", "PD5", "PD6", "LABEL" }, { "LABEL" }, MEM_DOUBLE, 1, verbose_out);
+
+  check(verbose_out.str().find("is shifted by one column") == std::string::npos, "header: not reported as shifted");
+  check_x(*data, 0, "PD1", 0.01);
+  check_x(*data, 0, "PD3", 0.67);
+  check(data->get_y(0, 0) == 1, "header: LABEL of row 0 is 1");
+}
+
+/**
+ * Rows with missing values are rejected when they cannot be skipped, e.g. when predicting.
+ */
+static void test_missing_rejected()
+{
+  std::ostringstream verbose_out;
+  std::string message;
+  try
+  {
+    load_csv_data({ "../results/data/data_2021-04-16_17-17-36.csv" }, { },
+        { "CADC0884", "CADC0885", "CADC0894", "CADC1005" }, { "CADC1005" }, MEM_DOUBLE, 1, verbose_out, false);
+  }
+  catch (std::runtime_error& e)
+  {
+    message = e.what();
+  }
+
+  check(message.find("Data row 1 ") == 0, "missing rejected: the first data row is reported");
+}
+
+int main()
+{
+  try
+  {
+    test_shifted_header();
+    test_headerless();
+    test_header();
+    test_missing_rejected();
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << "FAILED: " << e.what() << std::endl;
+    numFailures++;
+  }
+
+  std::cout << "CsvDataLoaderTest: " << (numFailures == 0 ? "passed" : "failed") << "." << std::endl;
+  return numFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+#!/bin/bash
+
+# Check that the code generated with --codegen predicts exactly like ranger's own trees. A classification and a
+# regression forest are grown on the training data, their generated code is compiled with its main function and
+# predicts the test data, extended with samples that have a NaN value. Run from the RandomForest directory with a built
+# OrbitAI_ranger, see "make test". The generated code is compiled with $CXX, g++ by default.
+
+CXX=${CXX:-g++}
+
+INCLUDEVARS=PD1,PD2,PD3,PD4,PD5,PD6,LABEL
+DEPVARNAME=LABEL
+
+# Odd number of trees so that the binary classification votes are never tied, ranger breaks ties at random.
+NTREE=11
+SEED=1
+
+WORKDIR=$(mktemp -d)
+trap 'rm -rf "$WORKDIR"' EXIT
+
+# The test data, then its last 6 samples with a NaN value for PD1 to PD6 in turn and a sample with only NaN values.
+TEST_DATA=$WORKDIR/test_data.csv
+cp test_data/test_data.csv $TEST_DATA
+tail -n 6 test_data/test_data.csv | awk 'BEGIN { FS = ","; OFS = "," } { $(NR + 1) = "nan"; print }' >> $TEST_DATA
+echo "0,nan,nan,nan,nan,nan,nan,1" >> $TEST_DATA
+
+FAILED=0
+
+for TREETYPE in 1 3; do
+    ./OrbitAI_ranger --file test_data/training_data.csv --includevars $INCLUDEVARS --depvarname $DEPVARNAME \
+        --treetype $TREETYPE --ntree $NTREE --seed $SEED --write --codegen $WORKDIR/forest.cpp \
+        --outprefix $WORKDIR/forest > /dev/null || exit 1
+    $CXX -O2 -DORBITAI_FOREST_MAIN $WORKDIR/forest.cpp -o $WORKDIR/forest || exit 1
+
+    ./OrbitAI_ranger --file $TEST_DATA --includevars $INCLUDEVARS --treetype $TREETYPE --seed $SEED \
+        --predict $WORKDIR/forest.forest --noflatten --outprefix $WORKDIR/ranger > /dev/null || exit 1
+    $WORKDIR/forest < $TEST_DATA > $WORKDIR/codegen.prediction || exit 1
+
+    if ! cmp -s $WORKDIR/ranger.prediction $WORKDIR/codegen.prediction; then
+        echo "FAILED: the generated code of the treetype $TREETYPE forest predicts differently from ranger:"
+        diff $WORKDIR/ranger.prediction $WORKDIR/codegen.prediction | head -n 10
+        FAILED=1
+    fi
+done
+
+if [ $FAILED -ne 0 ]; then
+    echo "codegen_parity: failed."
+    exit 1
+fi
+
+echo "codegen_parity: passed."
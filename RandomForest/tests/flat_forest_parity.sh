@@ -0,0 +1,54 @@
+#!/bin/bash
+
+# Check that the flattened forest and the memory mapped flat forest file predict exactly like ranger's own trees.
+# A classification and a regression forest are grown on the training data and predict the test data, extended with
+# samples that have a NaN value, which ranger sends to the right child of every split. Run from the RandomForest
+# directory with a built OrbitAI_ranger, see "make test".
+
+INCLUDEVARS=PD1,PD2,PD3,PD4,PD5,PD6,LABEL
+DEPVARNAME=LABEL
+
+# Odd number of trees so that the binary classification votes are never tied.
+NTREE=11
+SEED=1
+
+WORKDIR=$(mktemp -d)
+trap 'rm -rf "$WORKDIR"' EXIT
+
+# The test data, then its last 6 samples with a NaN value for PD1 to PD6 in turn and a sample with only NaN values.
+TEST_DATA=$WORKDIR/test_data.csv
+cp test_data/test_data.csv $TEST_DATA
+tail -n 6 test_data/test_data.csv | awk 'BEGIN { FS = ","; OFS = "," } { $(NR + 1) = "nan"; print }' >> $TEST_DATA
+echo "0,nan,nan,nan,nan,nan,nan,1" >> $TEST_DATA
+
+FAILED=0
+
+for TREETYPE in 1 3; do
+    ./OrbitAI_ranger --file test_data/training_data.csv --includevars $INCLUDEVARS --depvarname $DEPVARNAME \
+        --treetype $TREETYPE --ntree $NTREE --seed $SEED --write --saveflat --outprefix $WORKDIR/forest > /dev/null || exit 1
+
+    # Ranger's trees, the flattened forest and the flat forest file.
+    ./OrbitAI_ranger --file $TEST_DATA --includevars $INCLUDEVARS --treetype $TREETYPE --seed $SEED \
+        --predict $WORKDIR/forest.forest --noflatten --outprefix $WORKDIR/ranger > /dev/null || exit 1
+    ./OrbitAI_ranger --file $TEST_DATA --includevars $INCLUDEVARS --treetype $TREETYPE --seed $SEED \
+        --predict $WORKDIR/forest.forest --outprefix $WORKDIR/flat > /dev/null || exit 1
+    ./OrbitAI_ranger --file $TEST_DATA --includevars $INCLUDEVARS --treetype $TREETYPE --seed $SEED \
+        --predict $WORKDIR/forest.flatforest --outprefix $WORKDIR/mapped > /dev/null || exit 1
+    ./OrbitAI_ranger --file $TEST_DATA --includevars $INCLUDEVARS --treetype $TREETYPE --seed $SEED \
+        --predict $WORKDIR/forest.flatforest --verifyflat --outprefix $WORKDIR/verified > /dev/null || exit 1
+
+    for PREDICTION in flat mapped verified; do
+        if ! cmp -s $WORKDIR/ranger.prediction $WORKDIR/$PREDICTION.prediction; then
+            echo "FAILED: the $PREDICTION predictions of the treetype $TREETYPE forest differ from ranger's:"
+            diff $WORKDIR/ranger.prediction $WORKDIR/$PREDICTION.prediction | head -n 10
+            FAILED=1
+        fi
+    done
+done
+
+if [ $FAILED -ne 0 ]; then
+    echo "flat_forest_parity: failed."
+    exit 1
+fi
+
+echo "flat_forest_parity: passed."
@@ -0,0 +1,124 @@
+#!/bin/bash
+
+# Train and predict with OrbitAI_ranger over a grid of forest shapes and record their performance in a CSV file.
+# Each combination of the given --ntree, --mtry, --maxdepth, --nthreads, --savemem and --quantize values is trained on
+# the training data and predicts the test data. Run from the RandomForest directory, see "make benchmark".
+#
+# Usage: ./tools/benchmark.sh <ntrees> <mtrys> <maxdepths> <nthreads> <savemems> <quantizes> <string:output_filename>
+#   - ntrees, mtrys, maxdepths, nthreads: space separated lists of values, 0 is ranger's default for mtry and maxdepth.
+#   - savemems: space separated list of 0 (default splitting) and/or 1 (--savemem).
+#   - quantizes: space separated list of numbers of bins for --quantize, 0 to grow the trees on the raw data.
+#   - output_filename: path of the CSV file to write, one row per combination.
+#
+# e.g.: ./tools/benchmark.sh "10 100" "0 3" "0 10" "1 4" "0 1" "0 64" benchmark.csv
+#
+# Columns of the CSV file:
+#   - train_seconds, predict_seconds: wall-clock time of the training and of the prediction run.
+#   - predict_samples_per_second: prediction throughput, test samples over predict_seconds.
+#   - model_bytes: size of the saved .forest file.
+#   - train_peak_rss_kb, predict_peak_rss_kb: peak resident set size of the process. Measured by GNU time when it is
+#     installed, otherwise sampled from /proc every 10 ms, which can miss a peak in the last milliseconds of a run.
+#   - accuracy: fraction of the test samples predicted correctly.
+
+if [ $# -ne 7 ]; then
+    echo "Invalid number of parameters. Usage: ./tools/benchmark.sh <ntrees> <mtrys> <maxdepths> <nthreads> <savemems> <quantizes> <string:output_filename>"
+    exit 1
+fi
+
+# Data sets.
+TRAINING_DATA=test_data/training_data.csv
+TEST_DATA=test_data/test_data.csv
+INCLUDEVARS=PD1,PD2,PD3,PD4,PD5,PD6,LABEL
+DEPVARNAME=LABEL
+
+# Fixed seed so that every run grows the same forest.
+SEED=1
+
+# The forests and predictions are written to a temporary directory.
+WORKDIR=$(mktemp -d)
+trap 'rm -rf "$WORKDIR"' EXIT
+
+# Number of test samples, without the header row.
+NUM_TEST_SAMPLES=$(($(wc -l < $TEST_DATA) - 1))
+
+# Run the given command, silenced, and set ELAPSED to its wall-clock seconds and PEAK_RSS to its peak RSS in kB.
+measure() {
+    local START=$(date +%s%N)
+    if [ -x /usr/bin/time ]; then
+        /usr/bin/time -f "%M" -o $WORKDIR/rss "$@" > /dev/null 2>&1
+        local STATUS=$?
+        PEAK_RSS=$(tail -n 1 $WORKDIR/rss)
+    else
+        "$@" > /dev/null 2>&1 &
+        local PID=$!
+        PEAK_RSS=0
+        while kill -0 $PID 2> /dev/null; do
+            local HWM=$(awk '/^VmHWM/ { print $2 }' /proc/$PID/status 2> /dev/null)
+            if [ -n "$HWM" ] && [ "$HWM" -gt "$PEAK_RSS" ]; then
+                PEAK_RSS=$HWM
+            fi
+            sleep 0.01
+        done
+        wait $PID
+        local STATUS=$?
+    fi
+    ELAPSED=$(awk -v ns=$(($(date +%s%N) - START)) 'BEGIN { printf "%.3f", ns / 1e9 }')
+    return $STATUS
+}
+
+echo "ntree,mtry,maxdepth,nthreads,savemem,quantize,train_seconds,train_peak_rss_kb,model_bytes,predict_seconds,predict_samples_per_second,predict_peak_rss_kb,accuracy" > "$7"
+
+for NTREE in $1; do
+for MTRY in $2; do
+for MAXDEPTH in $3; do
+for NTHREADS in $4; do
+for SAVEMEM in $5; do
+for QUANTIZE in $6; do
+    PREFIX=$WORKDIR/forest_${NTREE}_${MTRY}_${MAXDEPTH}_${NTHREADS}_${SAVEMEM}_${QUANTIZE}
+    SAVEMEM_OPTION=""
+    if [ $SAVEMEM -eq 1 ]; then
+        SAVEMEM_OPTION="--savemem"
+    fi
+    QUANTIZE_OPTION=""
+    if [ $QUANTIZE -gt 0 ]; then
+        QUANTIZE_OPTION="--quantize $QUANTIZE"
+    fi
+
+    echo "ntree=$NTREE mtry=$MTRY maxdepth=$MAXDEPTH nthreads=$NTHREADS savemem=$SAVEMEM quantize=$QUANTIZE"
+
+    # Train and save the forest.
+    if ! measure ./OrbitAI_ranger --file $TRAINING_DATA --includevars $INCLUDEVARS --depvarname $DEPVARNAME --treetype 1 \
+        --ntree $NTREE --mtry $MTRY --maxdepth $MAXDEPTH --nthreads $NTHREADS --seed $SEED $SAVEMEM_OPTION $QUANTIZE_OPTION \
+        --write --outprefix $PREFIX; then
+        echo "Training failed, skipping."
+        continue
+    fi
+    TRAIN_SECONDS=$ELAPSED
+    TRAIN_PEAK_RSS=$PEAK_RSS
+    MODEL_BYTES=$(wc -c < $PREFIX.forest)
+
+    # Predict the test data with the saved forest.
+    if ! measure ./OrbitAI_ranger --file $TEST_DATA --includevars $INCLUDEVARS --predict $PREFIX.forest \
+        --nthreads $NTHREADS --seed $SEED --outprefix $PREFIX; then
+        echo "Prediction failed, skipping."
+        continue
+    fi
+    PREDICT_SECONDS=$ELAPSED
+    PREDICT_PEAK_RSS=$PEAK_RSS
+    THROUGHPUT=$(awk -v n=$NUM_TEST_SAMPLES -v s=$PREDICT_SECONDS 'BEGIN { printf "%.1f", (s > 0 ? n / s : 0) }')
+
+    # The label is the last column of the test data, the predictions follow the header line of the prediction file.
+    ACCURACY=$(tail -n +2 $TEST_DATA | awk -F, '{ print $NF }' | paste -d, - <(tail -n +2 $PREFIX.prediction) \
+        | awk -F, '{ n++; if ($1 == $2) correct++ } END { printf "%.4f", (n > 0 ? correct / n : 0) }')
+
+    echo "$NTREE,$MTRY,$MAXDEPTH,$NTHREADS,$SAVEMEM,$QUANTIZE,$TRAIN_SECONDS,$TRAIN_PEAK_RSS,$MODEL_BYTES,$PREDICT_SECONDS,$THROUGHPUT,$PREDICT_PEAK_RSS,$ACCURACY" >> "$7"
+
+    rm -f $PREFIX.*
+done
+done
+done
+done
+done
+done
+
+echo "Benchmark written to $7."